@@ -0,0 +1,32 @@
+# Консольная утилита aurcad-cli: обучение, анализ, пакетная обработка, замеры
+# и демон инференса для других приложений
+# без Aurora SDK (обычный Qt 5 на Linux). Сборка: qmake aurcad-cli.pro && make
+
+TEMPLATE = app
+TARGET = aurcad-cli
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+# Включаем файлы, сгенерированные Conan
+!exists($$PWD/conanbuildinfo.pri): warning("Conan dependencies not installed. Run: conan install . --build=missing")
+exists($$PWD/conanbuildinfo.pri): include($$PWD/conanbuildinfo.pri)
+
+QT += core multimedia gui concurrent network
+
+INCLUDEPATH += src/daemon
+
+SOURCES += \
+    src/cli/main.cpp \
+    src/daemon/InferenceServer.cpp \
+    src/daemon/InferenceClient.cpp \
+
+HEADERS += \
+    src/daemon/InferenceProtocol.h \
+    src/daemon/InferenceServer.h \
+    src/daemon/InferenceClient.h \
+
+include(src/core.pri)
+
+# Оптимизация
+QMAKE_CXXFLAGS += -O2
@@ -43,6 +43,20 @@ Page {
             detectionsLabel.text = "Обнаружено яблок: " + count
         }
 
+        onApplesAnalyzed: {
+            var bad = 0
+            for (var i = 0; i < apples.length; ++i) {
+                if (apples[i].result === "плохое") {
+                    bad++
+                }
+            }
+            detectionsLabel.text = "Яблок: " + apples.length + ", плохих: " + bad
+        }
+
+        onFrameRejected: {
+            detectionsLabel.text = "Кадр пропущен: " + reason
+        }
+
         onErrorOccurred: {
             analyzing = false
             errorLabel.text = error
@@ -54,11 +68,10 @@ Page {
         target: appleDetector.cameraHandler
 
         onImageCaptured: {
-            // Автоматически анализируем захваченное изображение
+            // Снимок уже передан в анализ из памяти
             analyzing = true
             resultLabel.text = ""
             confidenceLabel.text = ""
-            appleDetector.analyzeImage(filePath)
         }
 
         onErrorOccurred: {
@@ -270,6 +283,56 @@ Page {
                 }
             }
 
+            // Классификация каждого яблока в кадре
+            TextSwitch {
+                text: "Несколько яблок"
+                description: "Оценка каждого яблока на снимке (ящик, лоток)"
+                checked: appleDetector.multiAppleMode
+
+                onCheckedChanged: {
+                    appleDetector.multiAppleMode = checked
+                }
+            }
+
+            // Перекрытие стадий анализа соседних кадров
+            TextSwitch {
+                text: "Конвейерная обработка"
+                description: "Подготовка, детекция и классификация кадров идут параллельно"
+                checked: appleDetector.pipelinedRealtime
+                enabled: realtimeSwitch.enabled
+
+                onCheckedChanged: {
+                    appleDetector.pipelinedRealtime = checked
+                }
+            }
+
+            // Запись видоискателя для воспроизведения без камеры
+            TextSwitch {
+                text: "Запись кадров"
+                description: "Сохраняет кадры видоискателя для замеров real-time режима"
+                checked: appleDetector.cameraHandler.recording
+                enabled: appleDetector.cameraHandler.isActive
+
+                onCheckedChanged: {
+                    if (checked) {
+                        appleDetector.cameraHandler.startRecording()
+                    } else {
+                        appleDetector.cameraHandler.stopRecording()
+                    }
+                }
+            }
+
+            // Снимки для архива в полном разрешении сенсора
+            TextSwitch {
+                text: "Полное разрешение снимков"
+                description: "Выключите, чтобы снимок делался быстрее в размере, нужном для анализа"
+                checked: appleDetector.cameraHandler.archivalCapture
+
+                onCheckedChanged: {
+                    appleDetector.cameraHandler.archivalCapture = checked
+                }
+            }
+
             // Информация
             Label {
                 width: parent.width - Theme.paddingLarge * 2
@@ -11,7 +11,8 @@ Page {
     Connections {
         target: appleDetector
         onAnalysisComplete: {
-            resultText.text = "Результат: " + result
+            // Предварительный результат уточняется полным анализом
+            resultText.text = "Результат: " + result + (provisional ? " (уточняется…)" : "")
             confidenceText.text = "Уверенность: " + (confidence * 100).toFixed(1) + "%"
 
             // Определяем цвет в зависимости от результата
@@ -79,6 +80,10 @@ Page {
                         anchors.fill: parent
                         anchors.margins: 5
                         fillMode: Image.PreserveAspectFit
+                        asynchronous: true
+                        // Миниатюра под размер области вместо полного декодирования фото
+                        sourceSize.width: width
+                        sourceSize.height: height
                         source: ""
 
                         Label {
@@ -248,16 +253,33 @@ Page {
                         width: parent.width
                         height: Theme.itemSizeMedium
 
-                        Label {
+                        Image {
+                            id: thumbnail
                             anchors.verticalCenter: parent.verticalCenter
                             anchors.left: parent.left
                             anchors.leftMargin: Theme.paddingLarge
+                            width: Theme.itemSizeMedium - Theme.paddingSmall
+                            height: width
+                            fillMode: Image.PreserveAspectCrop
+                            asynchronous: true
+                            sourceSize.width: width
+                            sourceSize.height: height
+                            // Путь кодируется целиком: "#", "?" и "%" в имени файла не ломают URL
+                            source: "image://thumbnails/" + encodeURIComponent(model.path)
+                        }
+
+                        Label {
+                            anchors.verticalCenter: parent.verticalCenter
+                            anchors.left: thumbnail.right
+                            anchors.leftMargin: Theme.paddingLarge
                             text: model.name
                         }
 
                         onClicked: {
                             mainPage.selectedImagePath = model.path
-                            previewImage.source = "file://" + model.path
+                            previewImage.source = "image://thumbnails/" + encodeURIComponent(model.path)
+                            // Декодирование и признаки готовятся, пока пользователь не нажал "Анализировать"
+                            appleDetector.prefetch(model.path)
                             resultPanel.visible = false
                             errorLabel.visible = false
                             filePickerDialog.accept()
@@ -8,6 +8,7 @@ Page {
     property bool isTraining: false
     property real trainingProgress: 0.0
     property string trainingStatus: ""
+    property int trainingRequestId: -1
 
     Connections {
         target: appleDetector
@@ -29,6 +30,15 @@ Page {
             }
         }
 
+        onRequestCancelled: {
+            if (requestId === trainingPage.trainingRequestId) {
+                trainingPage.isTraining = false
+                trainingPage.trainingRequestId = -1
+                resultLabel.text = "Обучение отменено"
+                resultLabel.color = Theme.secondaryColor
+            }
+        }
+
         onErrorOccurred: {
             trainingPage.isTraining = false
             resultLabel.text = "Ошибка: " + error
@@ -166,10 +176,24 @@ Page {
                     trainingPage.isTraining = true
                     trainingPage.trainingProgress = 0.0
                     resultLabel.text = ""
-                    appleDetector.trainModel("/usr/share/ru.auroraos.aurcad/dataset/omsk/Training", false)
+                    trainingPage.trainingRequestId =
+                            appleDetector.trainModel("/usr/share/ru.auroraos.aurcad/dataset/omsk/Training", false)
+                    if (trainingPage.trainingRequestId < 0) {
+                        trainingPage.isTraining = false
+                    }
                 }
             }
 
+            // Отмена обучения (прерывается между изображениями датасета)
+            Button {
+                anchors.horizontalCenter: parent.horizontalCenter
+                text: "Отменить"
+                visible: trainingPage.isTraining && trainingPage.trainingRequestId >= 0
+                preferredWidth: Theme.buttonWidthLarge
+
+                onClicked: appleDetector.cancelRequest(trainingPage.trainingRequestId)
+            }
+
             SectionHeader {
                 text: "Дополнительно"
             }
@@ -9,29 +9,16 @@ exists($$PWD/conanbuildinfo.pri): include($$PWD/conanbuildinfo.pri)
 
 PKGCONFIG += \
 
-QT += core multimedia gui
+QT += core multimedia gui concurrent
 
 SOURCES += \
     src/main.cpp \
-    src/AppleDetector.cpp \
-    src/ImageProcessor.cpp \
-    src/ImageProcessorExtended.cpp \
-    src/AppleClassifier.cpp \
-    src/CameraHandler.cpp \
-    src/SegmentationData.cpp \
-    src/ONNXInference.cpp \
-    src/YOLO11Segmentation.cpp \
-    src/YOLACTInference.cpp \
+    src/ThumbnailProvider.cpp \
 
 HEADERS += \
-    src/AppleDetector.h \
-    src/ImageProcessor.h \
-    src/AppleClassifier.h \
-    src/CameraHandler.h \
-    src/SegmentationData.h \
-    src/ONNXInference.h \
-    src/YOLO11Segmentation.h \
-    src/YOLACTInference.h \
+    src/ThumbnailProvider.h \
+
+include(src/core.pri)
 
 DISTFILES += \
     rpm/ru.auroraos.aurcad.spec \
@@ -61,3 +48,10 @@ QMAKE_CXXFLAGS += -O2
 dataset.files = omsk/*
 dataset.path = /usr/share/$${TARGET}/dataset/omsk
 INSTALLS += dataset
+
+# Установка ONNX моделей (если они положены в models/)
+exists($$PWD/models) {
+    models.files = models/*
+    models.path = /usr/share/$${TARGET}/models
+    INSTALLS += models
+}
@@ -142,7 +142,7 @@ float AppleClassifier::train(const std::vector<std::vector<double>> &features,
 
 AppleClassifier::AppleQuality AppleClassifier::predict(
     const std::vector<double> &features,
-    float &confidence)
+    float &confidence) const
 {
     if (!m_trained) {
         qWarning() << "Model not trained";
@@ -372,7 +372,7 @@ bool AppleClassifier::loadModel(const QString &modelPath)
     return true;
 }
 
-bool AppleClassifier::saveModel(const QString &modelPath)
+bool AppleClassifier::saveModel(const QString &modelPath) const
 {
     qDebug() << "[AppleClassifier::saveModel] Attempting to save model to:" << modelPath;
 
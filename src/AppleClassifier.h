@@ -39,9 +39,11 @@ public:
      * @param features Вектор признаков
      * @param confidence Уверенность модели (выходной параметр)
      * @return Класс яблока
+     *
+     * Метод только читает модель, поэтому его можно вызывать из нескольких потоков
      */
     AppleQuality predict(const std::vector<double> &features,
-                        float &confidence);
+                        float &confidence) const;
 
     /**
      * @brief Загружает модель из файла
@@ -51,7 +53,7 @@ public:
     /**
      * @brief Сохраняет модель в файл
      */
-    bool saveModel(const QString &modelPath);
+    bool saveModel(const QString &modelPath) const;
 
     /**
      * @brief Проверяет, обучена ли модель
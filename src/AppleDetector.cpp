@@ -2,31 +2,205 @@
 #include "ImageProcessor.h"
 #include "AppleClassifier.h"
 #include "CameraHandler.h"
+#include "ParallelFor.h"
+#include "FrameReplaySource.h"
+#include "DirectoryAnalyzer.h"
 #include <QDebug>
 #include <QThread>
 #include <QDir>
 #include <QFileInfo>
+#include <QImageReader>
 #include <QStandardPaths>
 #include <QDateTime>
 #include <QFile>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+namespace {
+// Установочные пути приложения (см. INSTALLS в .pro)
+const char *MODELS_DIR = "/usr/share/ru.auroraos.aurcad/models";
+const char *DATASET_DIR = "/usr/share/ru.auroraos.aurcad/dataset/omsk";
+
+// Меньшая сторона предварительного изображения: центральная область признаков
+// (60%) остаётся не меньше входа признаков 224x224
+const int PREVIEW_MIN_SIDE = 360;
+const float DEFAULT_PREVIEW_SKIP_CONFIDENCE = 0.9f;
+
+// Во сколько раз уменьшать JPEG при декодировании (libjpeg умеет 1/2, 1/4, 1/8
+// прямо в DCT, не декодируя полное изображение); 1 - предварительный анализ не нужен
+int previewScale(const QByteArray &format, const QSize &size)
+{
+    if ((format != "jpeg" && format != "jpg") || !size.isValid()) {
+        return 1;
+    }
+
+    const int minSide = qMin(size.width(), size.height());
+    for (int scale = 8; scale > 1; scale /= 2) {
+        if (minSide / scale >= PREVIEW_MIN_SIDE) {
+            return scale;
+        }
+    }
+    return 1;
+}
+
+AppleDetector::AppleVerdict classifyApple(ImageProcessor &processor, const AppleClassifier &classifier,
+                                          const QImage &image, const ImageProcessor::AppleInstance &apple,
+                                          bool useSegmentation)
+{
+    AppleDetector::AppleVerdict verdict;
+    verdict.bbox = apple.bbox;
+
+    try {
+        std::vector<double> features = processor.extractAppleFeatures(image, apple, useSegmentation);
+        AppleClassifier::AppleQuality quality = classifier.predict(features, verdict.confidence);
+        verdict.result = AppleClassifier::qualityToString(quality);
+    } catch (const std::exception &e) {
+        qWarning() << "[AppleDetector] Error classifying apple:" << e.what();
+        verdict.result = "неизвестно";
+    }
+
+    return verdict;
+}
+
+// Признаки и классификация яблок независимы, выполняем их в пуле потоков
+QVector<AppleDetector::AppleVerdict> classifyApples(ImageProcessor &processor, const AppleClassifier &classifier,
+                                                    const QImage &image,
+                                                    const QVector<ImageProcessor::AppleInstance> &instances,
+                                                    bool useSegmentation,
+                                                    const CancellationToken &token = CancellationToken())
+{
+    QVector<AppleDetector::AppleVerdict> verdicts(instances.size());
+    AppleDetector::AppleVerdict *data = verdicts.data();
+    parallelFor(instances.size(), [&](int i) {
+        if (!token.isCancelled()) {
+            data[i] = classifyApple(processor, classifier, image, instances[i], useSegmentation);
+        }
+    });
+    return verdicts;
+}
+
+// Вердикт по изображению с готовой детекцией - общий для одиночного
+// и пакетного анализа: одно правило "не яблоко", те же аннотации и признаки
+AppleDetector::AnalysisResult decideImage(ImageProcessor &processor, const AppleClassifier &model,
+                                          const QImage &image, const QString &imageName,
+                                          const QVector<ImageProcessor::AppleInstance> &instances,
+                                          bool useSegmentation, bool multiApple,
+                                          const CancellationToken &token)
+{
+    AppleDetector::AnalysisResult analysis;
+    analysis.ok = true;
+
+    // Одиночное яблоко - как detectApple(): без работающего детектора
+    // достаточно размера изображения
+    bool detected = !instances.isEmpty();
+    if (!multiApple) {
+        detected = !image.isNull() && image.width() >= 50 && image.height() >= 50
+                   && (!processor.detectorDecides() || detected);
+    }
+
+    if (!detected) {
+        analysis.result = "не яблоко";
+        analysis.confidence = 0.95f;
+        return analysis;
+    }
+
+    if (multiApple) {
+        // Яблоки читают декодированное изображение через области без копирования
+        analysis.apples = classifyApples(processor, model, image, instances, useSegmentation, token);
+
+        if (token.isCancelled()) {
+            AppleDetector::AnalysisResult cancelled;
+            cancelled.cancelled = true;
+            return cancelled;
+        }
+
+        AppleDetector::summarizeVerdicts(analysis);
+        return analysis;
+    }
+
+    std::vector<double> features = processor.extractFeatures(image, imageName, useSegmentation);
+    AppleClassifier::AppleQuality quality = model.predict(features, analysis.confidence);
+    analysis.result = AppleClassifier::qualityToString(quality);
+    return analysis;
+}
+}
+
+AppleDetector::Options::Options()
+    : modelsDir(MODELS_DIR)
+    , datasetDir(DATASET_DIR)
+    , autotune(true)
+{
+}
 
 AppleDetector::AppleDetector(QObject *parent)
+    : AppleDetector(Options(), parent)
+{
+}
+
+AppleDetector::AppleDetector(const Options &options, QObject *parent)
     : QObject(parent)
     , m_imageProcessor(new ImageProcessor())
-    , m_classifier(new AppleClassifier())
+    , m_classifier(std::make_shared<AppleClassifier>())
     , m_cameraHandler(new CameraHandler(this))
-    , m_isProcessing(false)
-    , m_modelTrained(false)
-    , m_useSegmentation(false)
-    , m_realtimeAnalysis(false)
+    , m_processorPool(new ContextPool<ImageProcessor>([this]() { return m_imageProcessor->createContext(); }))
+    , m_activeRequests(0)
+    , m_activeTrainings(0)
+    , m_nextRequestId(1)
+    , m_frameWorkerActive(0)
+    , m_frameMailbox(&m_cameraHandler->frameMailbox())
+    , m_replaySource(nullptr)
+    , m_sceneReference(0)
+    , m_lastFrameReference(-1)
+    , m_detectionInterval(5)
+    , m_frameStateResetRequested(0)
+    , m_framesUnchanged(0)
+    , m_framesRejected(0)
+    , m_framesSkipped(0)
+    , m_framesPublished(0)
+    , m_modelTrained(0)
+    , m_useSegmentation(0)
+    , m_multiAppleMode(0)
+    , m_realtimeAnalysis(0)
+    , m_pipelinedRealtime(false)
+    , m_progressiveAnalysis(true)
+    , m_previewSkipConfidence(DEFAULT_PREVIEW_SKIP_CONFIDENCE)
+    , m_preparedFrames(PIPELINE_DEPTH)
+    , m_inferredFrames(PIPELINE_DEPTH)
+    , m_pipelined(0)
+    , m_options(options)
+    , m_autotuneWatcher(new QFutureWatcher<InferenceAutotuner::Profile>(this))
 {
     // Подключаем сигналы от камеры
-    connect(m_cameraHandler, &CameraHandler::imageCaptured,
-            this, &AppleDetector::analyzeImage);
-    connect(m_cameraHandler, &CameraHandler::frameAvailable,
-            this, &AppleDetector::onCameraFrameAvailable);
+    // Снимок анализируется из памяти, запись файла идёт в фоне
+    connect(m_cameraHandler, &CameraHandler::stillImageCaptured,
+            this, &AppleDetector::onStillImageCaptured);
+    // Слот вызывается в потоке камеры и только запускает обработчик кадров
+    connect(m_cameraHandler, &CameraHandler::frameReady,
+            this, &AppleDetector::onCameraFrameReady, Qt::DirectConnection);
     connect(m_cameraHandler, &CameraHandler::errorOccurred,
             this, &AppleDetector::onCameraError);
+    connect(m_autotuneWatcher, &QFutureWatcher<InferenceAutotuner::Profile>::finished,
+            this, &AppleDetector::onAutotuneFinished);
+
+    // Результаты кадров передаются из обработчика в GUI поток
+    qRegisterMetaType<AppleDetector::AnalysisResult>("AppleDetector::AnalysisResult");
+
+    // Стадии конвейера инференса и классификации
+    m_pipelineThreads.setMaxThreadCount(2);
+
+    // Кадры обрабатывает один обработчик, обучение идёт по одному,
+    // пакетной обработке всегда остаётся свободный поток для интерактивных запросов.
+    // Помощники parallelFor входят в лимит потоков класса: обучение не занимает
+    // больше половины потоков, обработчик кадров - больше двух
+    m_scheduler.setLimit(JobScheduler::REALTIME, 1);
+    m_scheduler.setThreadLimit(JobScheduler::REALTIME, 2);
+    m_scheduler.setLimit(JobScheduler::BATCH, qMax(1, m_scheduler.maxThreads() - 1));
+    m_scheduler.setThreadLimit(JobScheduler::BATCH, qMax(1, m_scheduler.maxThreads() - 1));
+    m_scheduler.setLimit(JobScheduler::TRAINING, 1);
+    m_scheduler.setThreadLimit(JobScheduler::TRAINING, qMax(1, m_scheduler.maxThreads() / 2));
+
+    // Камера отдаёт кадры не крупнее, чем нужно анализу
+    updateRequiredFrameSize();
     
     qDebug() << "[AppleDetector::constructor] ========== AppleDetector initialized ==========";
     
@@ -42,362 +216,1782 @@ AppleDetector::AppleDetector(QObject *parent)
     } else {
         qDebug() << "[AppleDetector::constructor] ⚠ No saved model found. Training will be required.";
     }
+
+    initInferenceProfile();
 }
 
 AppleDetector::~AppleDetector()
 {
+    // Бенчмарк использует собственные экземпляры моделей: прерываем его
+    // на ближайшем изображении и дожидаемся завершения
+    m_autotuneToken.cancel();
+    m_autotuneWatcher->waitForFinished();
+
+    // Новые кадры больше не принимаем
+    m_cameraHandler->setFrameStreaming(false);
+    disconnect(m_cameraHandler, &CameraHandler::frameReady,
+               this, &AppleDetector::onCameraFrameReady);
+    setReplaySource(nullptr);
+
+    // Конвейер дообрабатывает принятые кадры
+    if (m_pipelined.loadAcquire()) {
+        stopPipeline();
+    }
+
+    // Анализы используют контексты из пула и классификатор; пакетные прерываем
+    cancelPrefetch();
+    cancelAllRequests();
+    m_scheduler.waitForDone();
+
+    delete m_processorPool;
     delete m_imageProcessor;
-    delete m_classifier;
 }
 
-void AppleDetector::analyzeImage(const QString &imagePath)
+int AppleDetector::analyzeImage(const QString &imagePath)
 {
-    qDebug() << "Analyzing image:" << imagePath;
+    return analyzeImageImpl(imagePath, useSegmentation());
+}
 
-    if (m_isProcessing) {
-        emit errorOccurred("Already processing another image");
-        return;
-    }
+int AppleDetector::analyzeImageImpl(const QString &imagePath, bool useSegmentation)
+{
+    qDebug() << "Analyzing image:" << imagePath;
 
     if (!QFileInfo::exists(imagePath)) {
         emit errorOccurred("Image file not found: " + imagePath);
-        return;
+        return -1;
     }
 
-    if (!m_classifier->isTrained()) {
-        emit errorOccurred("Model not trained. Please train or load a model first.");
-        return;
+    if (!readyForAnalysis()) {
+        return -1;
     }
 
-    setIsProcessing(true);
-
-    try {
-        // Проверяем наличие яблока на изображении
-        if (!m_imageProcessor->detectApple(imagePath)) {
-            setLastResult("не яблоко");
-            emit analysisComplete("не яблоко", 0.95f);
-            setIsProcessing(false);
-            return;
-        }
-
-        // Извлекаем признаки
-        std::vector<double> features = m_imageProcessor->extractFeatures(imagePath, m_useSegmentation);
-
-        // Классифицируем
-        float confidence = 0.0f;
-        AppleClassifier::AppleQuality quality = m_classifier->predict(features, confidence);
-
-        QString result = AppleClassifier::qualityToString(quality);
-        setLastResult(result);
-
-        qDebug() << "Analysis result:" << result << "confidence:" << confidence;
+    // Повторный запрос того же изображения с теми же настройками присоединяется к уже идущему
+    bool multiApple = multiAppleMode();
+    QString coalesceKey = QString("%1|%2|%3").arg(imagePath).arg(useSegmentation).arg(multiApple);
 
-        emit analysisComplete(result, confidence);
+    // Изображение подготовлено заранее (или готовится) - остаётся классификация
+    std::shared_ptr<Prefetch> prefetched = m_prefetch;
+    if (prefetched && prefetched->imagePath == imagePath && prefetched->useSegmentation == useSegmentation
+            && prefetched->multiApple == multiApple
+            && prefetched->generation == m_processorPool->generation()
+            && prefetched->lastModified == QFileInfo(imagePath).lastModified()) {
+        return startAnalysis([this, prefetched, imagePath, useSegmentation, multiApple](int,
+                                                                                       const CancellationToken &token) {
+            AnalysisResult analysis;
+            if (classifyPrefetched(*prefetched, analysis)) {
+                return analysis;
+            }
+            return runAnalysis(imagePath, useSegmentation, multiApple, token);
+        }, coalesceKey);
+    }
 
-    } catch (const std::exception &e) {
-        emit errorOccurred(QString("Error during analysis: %1").arg(e.what()));
+    // В режиме нескольких яблок мелкие яблоки на уменьшенном изображении теряются
+    if (m_progressiveAnalysis && !multiApple) {
+        float skipConfidence = m_previewSkipConfidence;
+        return startAnalysis([this, imagePath, useSegmentation, skipConfidence](int requestId,
+                                                                               const CancellationToken &token) {
+            return runProgressiveAnalysis(requestId, imagePath, useSegmentation, skipConfidence, token);
+        }, coalesceKey);
     }
 
-    setIsProcessing(false);
+    return startAnalysis([this, imagePath, useSegmentation, multiApple](int, const CancellationToken &token) {
+        return runAnalysis(imagePath, useSegmentation, multiApple, token);
+    }, coalesceKey);
 }
 
-void AppleDetector::trainModel(const QString &datasetPath, bool usePolygonData)
+void AppleDetector::onStillImageCaptured(const StillImage &still)
 {
-    qDebug() << "[AppleDetector::trainModel] ========== TRAINING STARTED ==========";
-    qDebug() << "[AppleDetector::trainModel] Dataset path:" << datasetPath;
-    qDebug() << "[AppleDetector::trainModel] Use polygon data:" << usePolygonData;
+    qDebug() << "Analyzing captured image:" << still.filePath;
 
-    if (m_isProcessing) {
-        qWarning() << "[AppleDetector::trainModel] ❌ Already processing";
-        emit errorOccurred("Already processing");
+    if (!readyForAnalysis()) {
         return;
     }
 
-    qDebug() << "[AppleDetector::trainModel] Checking if dataset directory exists...";
-    if (!QDir(datasetPath).exists()) {
-        qWarning() << "[AppleDetector::trainModel] ❌ Dataset directory not found:" << datasetPath;
-        emit errorOccurred("Dataset directory not found: " + datasetPath);
-        return;
+    // JPEG камеры декодируется один раз в потоке анализа
+    bool useSegmentation = m_useSegmentation.load() != 0;
+    bool multiApple = multiAppleMode();
+    startAnalysis([this, still, useSegmentation, multiApple](int, const CancellationToken &token) -> AnalysisResult {
+        if (token.isCancelled()) {
+            AnalysisResult cancelled;
+            cancelled.cancelled = true;
+            return cancelled;
+        }
+        return runAnalysis(still.toImage(), QFileInfo(still.filePath).fileName(),
+                           useSegmentation, multiApple, token);
+    });
+}
+
+bool AppleDetector::readyForAnalysis()
+{
+    // Во время обучения анализ идёт на текущей модели
+    if (!classifier()->isTrained()) {
+        emit errorOccurred("Model not trained. Please train or load a model first.");
+        return false;
     }
-    qDebug() << "[AppleDetector::trainModel] ✓ Dataset directory exists";
 
-    setIsProcessing(true);
-    emit trainingProgress(0, "Loading dataset...");
+    return true;
+}
 
-    try {
-        qDebug() << "[AppleDetector::trainModel] Loading dataset...";
-        // Загружаем датасет
-        QDir datasetDir(datasetPath);
-        QStringList imageFiles = datasetDir.entryList(QStringList() << "*.jpg" << "*.png", QDir::Files);
+int AppleDetector::startAnalysis(const std::function<AnalysisResult(int, const CancellationToken &)> &job,
+                                 const QString &coalesceKey)
+{
+    if (!coalesceKey.isEmpty() && m_coalescedRequests.contains(coalesceKey)) {
+        int requestId = m_coalescedRequests.value(coalesceKey);
+        qDebug() << "[AppleDetector::startAnalysis] ✓ Coalesced with request" << requestId;
+        return requestId;
+    }
 
-        qDebug() << "[AppleDetector::trainModel] Found" << imageFiles.size() << "images";
+    int requestId = m_nextRequestId++;
+    CancellationToken token;
+    m_requestTokens.insert(requestId, token);
+    if (!coalesceKey.isEmpty()) {
+        m_coalescedRequests.insert(coalesceKey, requestId);
+    }
 
-        if (imageFiles.isEmpty()) {
-            qWarning() << "[AppleDetector::trainModel] ❌ No images found in dataset directory";
-            emit errorOccurred("No images found in dataset directory");
-            setIsProcessing(false);
-            return;
-        }
+    beginRequest();
 
-        // Если используем polygon данные, загружаем аннотации
-        if (usePolygonData) {
-            QString annotationsDir = datasetDir.absoluteFilePath("../labelme");
-            if (QDir(annotationsDir).exists()) {
-                m_imageProcessor->setAnnotationsDirectory(annotationsDir);
-                qDebug() << "Annotations directory set:" << annotationsDir;
-            } else {
-                qWarning() << "Annotations directory not found, falling back to regular feature extraction";
-                usePolygonData = false;
-            }
+    QFutureWatcher<AnalysisResult> *watcher = new QFutureWatcher<AnalysisResult>(this);
+    connect(watcher, &QFutureWatcher<AnalysisResult>::finished, this, [this, watcher, requestId, coalesceKey]() {
+        AnalysisResult analysis = watcher->result();
+        m_requestTokens.remove(requestId);
+        if (!coalesceKey.isEmpty()) {
+            m_coalescedRequests.remove(coalesceKey);
         }
 
-        // Загружаем метки из classes.txt
-        QString classesFile = datasetDir.absoluteFilePath("../classes.txt");
-        qDebug() << "[AppleDetector::trainModel] Looking for classes file:" << classesFile;
-        QFile file(classesFile);
-        QMap<QString, int> imageLabels;
-
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            qDebug() << "[AppleDetector::trainModel] ✓ Classes file opened successfully";
-            QTextStream in(&file);
-            int goodLabels = 0, badLabels = 0;
-            while (!in.atEnd()) {
-                QString line = in.readLine().trimmed();
-                if (!line.isEmpty()) {
-                    QStringList parts = line.split(QRegExp("\\s+"));
-                    if (parts.size() >= 2) {
-                        QString imageName = parts[0];
-                        QString label = parts[1];
-                        int labelValue = (label == "хорошее") ? 0 : 1;
-                        imageLabels[imageName] = labelValue;
-                        if (labelValue == 0) goodLabels++;
-                        else badLabels++;
-                    }
-                }
-            }
-            file.close();
-            qDebug() << "[AppleDetector::trainModel] Loaded" << imageLabels.size() << "image labels (Good:" 
-                     << goodLabels << "Bad:" << badLabels << ")";
+        if (analysis.cancelled) {
+            emit requestCancelled(requestId);
         } else {
-            qWarning() << "[AppleDetector::trainModel] ⚠ Could not open classes file:" << classesFile;
+            finishAnalysis(analysis);
+            emit requestFinished(requestId, toVariantMap(analysis));
         }
 
-        qDebug() << "[AppleDetector::trainModel] Starting feature extraction...";
-        emit trainingProgress(20, "Extracting features...");
+        endRequest();
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_scheduler.run<AnalysisResult>(JobScheduler::INTERACTIVE, [job, requestId, token]() {
+        return job(requestId, token);
+    }));
 
-        // Извлекаем признаки из всех изображений
-        std::vector<std::vector<double>> features;
-        std::vector<int> labels;
+    return requestId;
+}
 
-        int processedImages = 0;
-        for (const QString &imageFile : imageFiles) {
-            QString imagePath = datasetDir.absoluteFilePath(imageFile);
+int AppleDetector::analyzeDirectory(const QString &dirPath, const QString &outputPath)
+{
+    qDebug() << "[AppleDetector::analyzeDirectory] Directory:" << dirPath;
 
-            try {
-                // Проверяем наличие метки перед извлечением признаков
-                int label = imageLabels.value(imageFile, -1); // -1 = нет метки
-                if (label == -1) {
-                    qWarning() << "[AppleDetector::trainModel] ⚠ No label found for image:" << imageFile << ", skipping";
-                    continue;
-                }
-                
-                if (processedImages == 0 || processedImages % 10 == 0) {
-                    qDebug() << "[AppleDetector::trainModel] Processing image" << (processedImages + 1) << "/" << imageFiles.size() 
-                             << ":" << imageFile << "label:" << (label == 0 ? "GOOD" : "BAD");
-                }
-                
-                std::vector<double> imageFeatures = m_imageProcessor->extractFeatures(imagePath, usePolygonData);
-                features.push_back(imageFeatures);
-                labels.push_back(label);
+    if (!readyForAnalysis()) {
+        return -1;
+    }
 
-                processedImages++;
-                int progress = 20 + (processedImages * 50 / imageFiles.size());
-                emit trainingProgress(progress, QString("Processing %1/%2 images...")
-                                     .arg(processedImages).arg(imageFiles.size()));
+    QString resultsPath = outputPath;
+    if (resultsPath.isEmpty()) {
+        QString appDataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(appDataDir);
+        resultsPath = appDataDir + "/batch_"
+                + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".jsonl";
+    }
 
-            } catch (const std::exception &e) {
-                qWarning() << "[AppleDetector::trainModel] Error processing image" << imageFile << ":" << e.what();
-            }
-        }
+    QString coalesceKey = QString("dir|%1|%2").arg(dirPath).arg(resultsPath);
+    if (m_coalescedRequests.contains(coalesceKey)) {
+        int requestId = m_coalescedRequests.value(coalesceKey);
+        qDebug() << "[AppleDetector::analyzeDirectory] ✓ Coalesced with request" << requestId;
+        return requestId;
+    }
 
-        qDebug() << "[AppleDetector::trainModel] Feature extraction complete.";
-        qDebug() << "[AppleDetector::trainModel] Extracted features from" << features.size() << "images";
+    bool useSegmentation = m_useSegmentation.load() != 0;
+    bool multiApple = multiAppleMode();
+    DirectoryAnalyzer *analyzer = new DirectoryAnalyzer(m_scheduler,
+            [this, useSegmentation, multiApple](const QImage &image, const QString &fileName,
+                                                const CancellationToken &token) -> DirectoryAnalyzer::Row {
+        AnalysisResult analysis = runAnalysis(image, fileName, useSegmentation, multiApple, token);
 
-        if (features.empty()) {
-            qWarning() << "[AppleDetector::trainModel] ❌ Failed to extract features from any image";
-            emit errorOccurred("Failed to extract features from any image");
-            setIsProcessing(false);
-            return;
-        }
+        DirectoryAnalyzer::Row row;
+        row.ok = analysis.ok;
+        row.result = analysis.result;
+        row.confidence = analysis.confidence;
+        row.apples = analysis.apples.size();
+        row.error = analysis.error;
+        row.cancelled = analysis.cancelled;
+        return row;
+    }, this);
 
-        qDebug() << "[AppleDetector::trainModel] Starting model training...";
-        emit trainingProgress(70, "Training model...");
+    int requestId = m_nextRequestId++;
+    CancellationToken token;
 
-        // Обучаем модель
-        float accuracy = m_classifier->train(features, labels);
+    connect(analyzer, &DirectoryAnalyzer::progress, this, &AppleDetector::directoryProgress);
+    connect(analyzer, &DirectoryAnalyzer::finished, this,
+            [this, analyzer, requestId, coalesceKey](const DirectoryAnalyzer::Report &report) {
+        m_requestTokens.remove(requestId);
+        m_coalescedRequests.remove(coalesceKey);
 
-        qDebug() << "[AppleDetector::trainModel] ✓ Training completed! Accuracy:" << accuracy;
-        setModelTrained(true);
-        
-        // Автоматически сохраняем обученную модель
-        QString modelPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
-                           + "/apple_model.dat";
-        QString appDataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-        
-        qDebug() << "[AppleDetector::trainModel] Auto-saving model...";
-        qDebug() << "[AppleDetector::trainModel] AppDataLocation:" << appDataDir;
-        qDebug() << "[AppleDetector::trainModel] Model path:" << modelPath;
-        
-        // Создаём директорию, если её нет
-        if (!QDir(appDataDir).exists()) {
-            qDebug() << "[AppleDetector::trainModel] Creating directory:" << appDataDir;
-            QDir().mkpath(appDataDir);
-        }
-        
-        if (m_classifier->saveModel(modelPath)) {
-            qDebug() << "[AppleDetector::trainModel] ✅ Model auto-saved successfully to:" << modelPath;
+        QVariantMap result;
+        result["ok"] = true;
+        result["processed"] = report.processed;
+        result["failed"] = report.failed;
+        result["elapsedSec"] = report.elapsedSec;
+        result["imagesPerSecond"] = report.imagesPerSecond;
+        result["outputPath"] = report.outputPath;
+
+        if (report.cancelled) {
+            emit requestCancelled(requestId);
         } else {
-            qWarning() << "[AppleDetector::trainModel] ❌ Failed to auto-save model to:" << modelPath;
+            emit directoryAnalysisComplete(result);
+            emit requestFinished(requestId, result);
         }
 
-        emit trainingProgress(100, "Training complete");
-        emit trainingComplete(true, accuracy);
-
-        qDebug() << "Training completed with accuracy:" << accuracy;
+        endRequest();
+        analyzer->deleteLater();
+    });
 
-    } catch (const std::exception &e) {
-        emit errorOccurred(QString("Error during training: %1").arg(e.what()));
-        emit trainingComplete(false, 0.0f);
+    if (!analyzer->start(dirPath, resultsPath, DirectoryAnalyzer::formatForPath(resultsPath), token)) {
+        qWarning() << "[AppleDetector::analyzeDirectory] ❌" << analyzer->errorString();
+        emit errorOccurred(analyzer->errorString());
+        delete analyzer;
+        return -1;
     }
 
-    setIsProcessing(false);
+    m_requestTokens.insert(requestId, token);
+    m_coalescedRequests.insert(coalesceKey, requestId);
+    beginRequest();
+
+    return requestId;
 }
 
-void AppleDetector::loadModel(const QString &modelPath)
+void AppleDetector::cancelRequest(int requestId)
 {
-    qDebug() << "[AppleDetector::loadModel] ========== LOAD MODEL REQUEST ==========";
-    qDebug() << "[AppleDetector::loadModel] Path:" << modelPath;
-
-    if (!QFileInfo::exists(modelPath)) {
-        qWarning() << "[AppleDetector::loadModel] ❌ Model file not found:" << modelPath;
-        emit errorOccurred("Model file not found: " + modelPath);
-        return;
+    // Запрос завершится в ближайшей контрольной точке и пришлёт requestCancelled
+    if (m_requestTokens.contains(requestId)) {
+        m_requestTokens.value(requestId).cancel();
+        qDebug() << "Cancelling request:" << requestId;
     }
+}
 
-    qDebug() << "[AppleDetector::loadModel] File exists, delegating to AppleClassifier...";
-    
-    if (m_classifier->loadModel(modelPath)) {
-        setModelTrained(true);
-        qDebug() << "[AppleDetector::loadModel] ✅ Model loaded and ready for use!";
-    } else {
-        qWarning() << "[AppleDetector::loadModel] ❌ Failed to load model (AppleClassifier returned false)";
-        emit errorOccurred("Failed to load model");
+void AppleDetector::cancelAllRequests()
+{
+    for (const CancellationToken &token : m_requestTokens) {
+        token.cancel();
     }
 }
 
-void AppleDetector::saveModel(const QString &modelPath)
+void AppleDetector::prefetch(const QString &imagePath)
 {
-    qDebug() << "Saving model to:" << modelPath;
-
-    if (!m_classifier->isTrained()) {
-        emit errorOccurred("No trained model to save");
+    bool useSegmentation = m_useSegmentation.load() != 0;
+    bool multiApple = multiAppleMode();
+    // Смена модели, тайлов или входа детектора меняет поколение контекстов -
+    // подготовленные детекции и признаки устарели
+    const int generation = m_processorPool->generation();
+    if (m_prefetch && m_prefetch->imagePath == imagePath && m_prefetch->useSegmentation == useSegmentation
+            && m_prefetch->multiApple == multiApple && m_prefetch->generation == generation) {
         return;
     }
 
-    if (m_classifier->saveModel(modelPath)) {
-        qDebug() << "Model saved successfully";
-    } else {
-        emit errorOccurred("Failed to save model");
-    }
-}
+    cancelPrefetch();
 
-void AppleDetector::setIsProcessing(bool processing)
-{
-    if (m_isProcessing != processing) {
-        m_isProcessing = processing;
-        emit isProcessingChanged();
+    QFileInfo fileInfo(imagePath);
+    if (imagePath.isEmpty() || !fileInfo.exists()) {
+        return;
     }
-}
 
-void AppleDetector::setLastResult(const QString &result)
-{
-    if (m_lastResult != result) {
-        m_lastResult = result;
-        emit lastResultChanged();
-    }
-}
+    std::shared_ptr<Prefetch> prefetch = std::make_shared<Prefetch>();
+    prefetch->imagePath = imagePath;
+    prefetch->lastModified = fileInfo.lastModified();
+    prefetch->useSegmentation = useSegmentation;
+    prefetch->multiApple = multiApple;
+    prefetch->generation = generation;
+    m_prefetch = prefetch;
 
-void AppleDetector::setModelTrained(bool trained)
-{
-    if (m_modelTrained != trained) {
-        m_modelTrained = trained;
-        emit modelTrainedChanged();
-    }
+    // Низкий приоритет: подготовка не должна задерживать запросы пользователя и камеру
+    m_scheduler.submit(JobScheduler::BATCH, [this, prefetch]() {
+        runPrefetch(*prefetch);
+    });
 }
 
-void AppleDetector::setUseSegmentation(bool use)
+void AppleDetector::cancelPrefetch()
 {
-    if (m_useSegmentation != use) {
-        m_useSegmentation = use;
-        emit useSegmentationChanged();
-        qDebug() << "Use segmentation set to:" << use;
+    if (!m_prefetch) {
+        return;
     }
-}
 
-void AppleDetector::analyzeImageWithSegmentation(const QString &imagePath)
-{
-    // Временно сохраняем текущее значение
-    bool oldValue = m_useSegmentation;
-    
-    // Включаем сегментацию для этого анализа
-    m_useSegmentation = true;
-    
-    // Выполняем анализ
-    analyzeImage(imagePath);
-    
-    // Восстанавливаем значение
-    m_useSegmentation = oldValue;
+    m_prefetch->token.cancel();
+    m_prefetch->state.testAndSetOrdered(Prefetch::PREFETCH_QUEUED, Prefetch::PREFETCH_DROPPED);
+    m_prefetch.reset();
 }
 
-void AppleDetector::analyzeCameraFrame(const QImage &frame)
+void AppleDetector::runPrefetch(Prefetch &prefetch)
 {
-    if (!m_realtimeAnalysis || !m_modelTrained) {
+    // Отменена или уже уступлена анализу этого изображения
+    if (!prefetch.state.testAndSetOrdered(Prefetch::PREFETCH_QUEUED, Prefetch::PREFETCH_RUNNING)) {
         return;
     }
 
-    if (m_isProcessing) {
-        return; // Пропускаем кадр, если уже обрабатываем
-    }
+    QElapsedTimer timer;
+    timer.start();
+    const QString imageName = QFileInfo(prefetch.imagePath).fileName();
 
     try {
-        // Сохраняем кадр во временный файл для анализа
-        QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
-                          + "/aurcad_frame_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".jpg";
-        
-        if (frame.save(tempPath, "JPEG", 85)) {
-            // Анализируем изображение
-            analyzeImage(tempPath);
-            
-            // Удаляем временный файл
-            QFile::remove(tempPath);
+        ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+        // Конфигурация сменилась, пока подготовка ждала в очереди
+        if (processor.generation() != prefetch.generation) {
+            prefetch.token.cancel();
+        }
+
+        QImage image;
+        if (!prefetch.token.isCancelled()) {
+            image.load(prefetch.imagePath);
+        }
+
+        if (!image.isNull() && !prefetch.token.isCancelled()) {
+            if (prefetch.multiApple) {
+                for (const ImageProcessor::AppleInstance &apple : processor->detectAppleInstances(image, imageName)) {
+                    if (prefetch.token.isCancelled()) {
+                        break;
+                    }
+
+                    prefetch.appleBoxes.append(apple.bbox);
+                    try {
+                        prefetch.appleFeatures.append(
+                                processor->extractAppleFeatures(image, apple, prefetch.useSegmentation));
+                    } catch (const std::exception &e) {
+                        qWarning() << "[AppleDetector::runPrefetch] Error extracting apple features:" << e.what();
+                        prefetch.appleFeatures.append(std::vector<double>());
+                    }
+                }
+            } else {
+                prefetch.detected = processor->detectApple(image, imageName);
+                if (prefetch.detected && !prefetch.token.isCancelled()) {
+                    prefetch.features = processor->extractFeatures(image, imageName, prefetch.useSegmentation);
+                }
+            }
+
+            prefetch.ok = !prefetch.token.isCancelled();
         }
     } catch (const std::exception &e) {
-        qWarning() << "Error analyzing camera frame:" << e.what();
+        qWarning() << "[AppleDetector::runPrefetch] Error:" << e.what();
+        prefetch.ok = false;
     }
-}
 
-void AppleDetector::setRealtimeAnalysis(bool enabled)
-{
-    if (m_realtimeAnalysis != enabled) {
-        m_realtimeAnalysis = enabled;
-        qDebug() << "Realtime analysis set to:" << enabled;
+    prefetch.state.storeRelease(Prefetch::PREFETCH_DONE);
+
+    if (prefetch.ok) {
+        qDebug() << "[AppleDetector::runPrefetch] ✓ Prepared" << imageName << "in" << timer.elapsed() << "ms";
     }
 }
 
-void AppleDetector::onCameraFrameAvailable(const QImage &frame)
+bool AppleDetector::classifyPrefetched(Prefetch &prefetch, AnalysisResult &analysis)
 {
-    // Перенаправляем на analyzeCameraFrame
-    analyzeCameraFrame(frame);
+    // Не начатую подготовку забираем себе: полный анализ с высоким приоритетом быстрее
+    if (prefetch.state.testAndSetOrdered(Prefetch::PREFETCH_QUEUED, Prefetch::PREFETCH_DROPPED)) {
+        return false;
+    }
+
+    // Идущую подготовку не ждём: она может уступать поток этому же запросу
+    // в checkpoint, и ожидание заняло бы поток планировщика, нужный ей для продолжения
+    if (prefetch.state.loadAcquire() != Prefetch::PREFETCH_DONE) {
+        prefetch.token.cancel();
+        return false;
+    }
+
+    if (!prefetch.ok) {
+        return false;
+    }
+
+    // Конфигурация сменилась во время подготовки: детекции посчитаны старой моделью
+    if (prefetch.generation != m_processorPool->generation()) {
+        return false;
+    }
+
+    std::shared_ptr<const AppleClassifier> model = classifier();
+    analysis.ok = true;
+
+    try {
+        if (!prefetch.multiApple) {
+            if (!prefetch.detected) {
+                analysis.result = "не яблоко";
+                analysis.confidence = 0.95f;
+                return true;
+            }
+
+            AppleClassifier::AppleQuality quality = model->predict(prefetch.features, analysis.confidence);
+            analysis.result = AppleClassifier::qualityToString(quality);
+            return true;
+        }
+
+        if (prefetch.appleBoxes.isEmpty()) {
+            analysis.result = "не яблоко";
+            analysis.confidence = 0.95f;
+            return true;
+        }
+
+        analysis.apples.resize(prefetch.appleBoxes.size());
+        for (int i = 0; i < prefetch.appleBoxes.size(); ++i) {
+            AppleVerdict &verdict = analysis.apples[i];
+            verdict.bbox = prefetch.appleBoxes[i];
+            if (prefetch.appleFeatures[i].empty()) {
+                verdict.result = "неизвестно";
+                continue;
+            }
+            AppleClassifier::AppleQuality quality = model->predict(prefetch.appleFeatures[i], verdict.confidence);
+            verdict.result = AppleClassifier::qualityToString(quality);
+        }
+        summarizeVerdicts(analysis);
+    } catch (const std::exception &e) {
+        qWarning() << "[AppleDetector::classifyPrefetched] Error:" << e.what();
+        analysis = AnalysisResult();
+        return false;
+    }
+
+    return true;
+}
+
+AppleDetector::AnalysisResult AppleDetector::runAnalysis(const QString &imagePath, bool useSegmentation,
+                                                         bool multiApple, const CancellationToken &token)
+{
+    if (token.isCancelled()) {
+        AnalysisResult analysis;
+        analysis.cancelled = true;
+        return analysis;
+    }
+
+    // Изображение декодируется один раз для детекции и признаков
+    return runAnalysis(QImage(imagePath), QFileInfo(imagePath).fileName(), useSegmentation, multiApple, token);
+}
+
+AppleDetector::AnalysisResult AppleDetector::runProgressiveAnalysis(int requestId, const QString &imagePath,
+                                                                    bool useSegmentation, float skipConfidence,
+                                                                    const CancellationToken &token)
+{
+    QImageReader reader(imagePath);
+    const QSize fullSize = reader.size();
+    const int scale = previewScale(reader.format(), fullSize);
+
+    if (scale > 1 && !token.isCancelled()) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // Размер, кратный степени двойки, декодер получает целиком из DCT без масштабирования
+        reader.setScaledSize(QSize((fullSize.width() + scale - 1) / scale,
+                                   (fullSize.height() + scale - 1) / scale));
+        QImage preview = reader.read();
+
+        if (!preview.isNull()) {
+            // Аннотации размечены в координатах полного изображения, здесь они не подходят
+            AnalysisResult analysis = runAnalysis(preview, QString(), useSegmentation, false, token);
+            qDebug() << "[AppleDetector::runProgressiveAnalysis] ✓ Preview" << preview.size() << analysis.result
+                     << analysis.confidence << "in" << timer.elapsed() << "ms";
+
+            // "не яблоко" на уменьшенном изображении всегда перепроверяем. Полный
+            // проход нужен и тогда, когда его результат зависит от полного
+            // изображения: маски сегментации и аннотации файла превью не видит
+            bool fullPassRequired = useSegmentation;
+            if (!fullPassRequired) {
+                ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+                fullPassRequired = processor->hasAnnotation(QFileInfo(imagePath).fileName());
+            }
+
+            if (!fullPassRequired && analysis.ok && analysis.result != "не яблоко"
+                    && analysis.confidence >= skipConfidence) {
+                return analysis;
+            }
+
+            if (analysis.ok) {
+                QMetaObject::invokeMethod(this, "onPreviewAnalyzed", Qt::QueuedConnection,
+                                          Q_ARG(int, requestId),
+                                          Q_ARG(AppleDetector::AnalysisResult, analysis));
+            }
+        }
+    }
+
+    return runAnalysis(imagePath, useSegmentation, false, token);
+}
+
+void AppleDetector::updateRequiredFrameSize()
+{
+    m_cameraHandler->setRequiredFrameSize(m_imageProcessor->requiredFrameSize(multiAppleMode()));
+}
+
+void AppleDetector::onPreviewAnalyzed(int requestId, const AppleDetector::AnalysisResult &preview)
+{
+    // Запрос уже завершён или отменён
+    if (!m_requestTokens.contains(requestId)) {
+        return;
+    }
+
+    QVariantMap result = toVariantMap(preview);
+    result["provisional"] = true;
+    emit analysisComplete(preview.result, preview.confidence, true);
+    emit requestProvisional(requestId, result);
+}
+
+AppleDetector::AnalysisResult AppleDetector::runAnalysis(const QImage &image, const QString &imageName,
+                                                         bool useSegmentation, bool multiApple,
+                                                         const CancellationToken &token)
+{
+    AnalysisResult analysis;
+
+    try {
+        // Собственный контекст на время анализа: веса моделей общие, буферы свои
+        ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+        // Одиночное яблоко без работающего детектора определяется размером
+        // изображения, детекцию тогда не запускаем
+        QVector<ImageProcessor::AppleInstance> instances;
+        if (!image.isNull() && (multiApple || processor->detectorDecides())) {
+            instances = processor->detectAppleInstances(image, imageName);
+        }
+
+        // Контрольная точка между детекцией и признаками
+        if (token.isCancelled()) {
+            analysis.cancelled = true;
+            return analysis;
+        }
+
+        // Все яблоки изображения классифицирует одна и та же модель, даже если её заменят
+        std::shared_ptr<const AppleClassifier> model = classifier();
+        analysis = decideImage(*processor, *model, image, imageName, instances,
+                               useSegmentation, multiApple, token);
+
+        qDebug() << "Analysis result:" << analysis.result << "confidence:" << analysis.confidence;
+
+    } catch (const std::exception &e) {
+        analysis = AnalysisResult();
+        analysis.error = QString("Error during analysis: %1").arg(e.what());
+    }
+
+    return analysis;
+}
+
+QVector<AppleDetector::AnalysisResult> AppleDetector::analyzeBatch(const QVector<QImage> &images,
+                                                                   const QStringList &imageNames,
+                                                                   bool useSegmentation, bool multiApple)
+{
+    QVector<AnalysisResult> results(images.size());
+    if (images.isEmpty()) {
+        return results;
+    }
+
+    // Весь батч классифицирует одна и та же модель
+    std::shared_ptr<const AppleClassifier> model = classifier();
+    if (!model->isTrained()) {
+        for (AnalysisResult &analysis : results) {
+            analysis.error = "Model not trained";
+        }
+        return results;
+    }
+
+    try {
+        QVector<QVector<ImageProcessor::AppleInstance>> instances(images.size());
+        QVector<bool> detected(images.size(), false);
+        bool detect = multiApple;
+        {
+            ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+            // Как в runAnalysis: одно яблоко без модели детектора определяется по размеру
+            detect = detect || processor->detectorDecides();
+            if (detect) {
+                // Что модель принимает батчем - одним вызовом в одном контексте
+                instances = processor->detectAppleInstancesBatch(images, imageNames, detected);
+            }
+        }
+
+        // Остальная детекция, признаки и классификация изображений независимы
+        AnalysisResult *analyses = results.data();
+        QVector<ImageProcessor::AppleInstance> *found = instances.data();
+        const bool *batched = detected.constData();
+        parallelFor(images.size(), [&](int i) {
+            ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+            try {
+                if (detect && !batched[i] && !images[i].isNull()) {
+                    found[i] = processor->detectAppleInstances(images[i], imageNames.value(i));
+                }
+                analyses[i] = decideImage(*processor, *model, images[i], imageNames.value(i), found[i],
+                                          useSegmentation, multiApple, CancellationToken());
+            } catch (const std::exception &e) {
+                analyses[i] = AnalysisResult();
+                analyses[i].error = QString("Error during analysis: %1").arg(e.what());
+            }
+        });
+    } catch (const std::exception &e) {
+        for (AnalysisResult &analysis : results) {
+            if (!analysis.ok) {
+                analysis.error = QString("Error during analysis: %1").arg(e.what());
+            }
+        }
+    }
+
+    return results;
+}
+
+AppleDetector::AnalysisResult AppleDetector::trackApples(const CameraFrame &frame, bool useSegmentation)
+{
+    AnalysisResult analysis;
+    analysis.ok = true;
+
+    m_tracker.setDetectionInterval(m_detectionInterval.load());
+    m_tracker.advanceFrame();
+
+    if (m_tracker.needsDetection()) {
+        try {
+            QImage image = frame.toImage();
+            ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+            QVector<ImageProcessor::AppleInstance> instances = processor->detectAppleInstances(image);
+            QVector<QRectF> boxes;
+            for (const ImageProcessor::AppleInstance &instance : instances) {
+                boxes.append(instance.bbox);
+            }
+            QVector<int> trackIds = m_tracker.update(boxes);
+
+            // Классифицируем только яблоки новых треков, остальные берут вердикт из трека
+            QVector<int> pending;
+            for (int i = 0; i < instances.size(); ++i) {
+                const AppleTracker::Track *track = m_tracker.track(trackIds[i]);
+                if (track && !track->classified) {
+                    pending.append(i);
+                }
+            }
+
+            QVector<AppleVerdict> verdicts(pending.size());
+            AppleVerdict *verdictData = verdicts.data();
+            std::shared_ptr<const AppleClassifier> model = classifier();
+            parallelFor(pending.size(), [&](int k) {
+                verdictData[k] = classifyApple(*processor, *model, image,
+                                               instances[pending[k]], useSegmentation);
+            });
+
+            for (int k = 0; k < pending.size(); ++k) {
+                m_tracker.setClassification(trackIds[pending[k]], verdicts[k].result, verdicts[k].confidence);
+            }
+        } catch (const std::exception &e) {
+            analysis.ok = false;
+            analysis.error = QString("Error during analysis: %1").arg(e.what());
+            return analysis;
+        }
+    }
+
+    // Между детекциями показываем предсказанные рамки с кэшированными вердиктами
+    for (const AppleTracker::Track &track : m_tracker.tracks()) {
+        if (!track.classified || track.missed > 0) {
+            continue;
+        }
+
+        AppleVerdict verdict;
+        verdict.bbox = track.box;
+        verdict.result = track.result;
+        verdict.confidence = track.resultConfidence;
+        verdict.trackId = track.id;
+        analysis.apples.append(verdict);
+    }
+
+    if (analysis.apples.isEmpty()) {
+        analysis.result = "не яблоко";
+        analysis.confidence = 0.95f;
+        return analysis;
+    }
+
+    summarizeVerdicts(analysis);
+    return analysis;
+}
+
+void AppleDetector::summarizeVerdicts(AnalysisResult &analysis)
+{
+    // Итог по изображению: одно плохое яблоко делает всю партию плохой
+    QString badResult = AppleClassifier::qualityToString(AppleClassifier::BAD);
+    QString goodResult = AppleClassifier::qualityToString(AppleClassifier::GOOD);
+    int badCount = 0;
+    for (const AppleVerdict &verdict : analysis.apples) {
+        if (verdict.result == badResult) {
+            ++badCount;
+        }
+    }
+
+    analysis.result = (badCount > 0) ? badResult : goodResult;
+
+    // Уверенность итога - средняя по яблокам с тем же вердиктом
+    float confidenceSum = 0.0f;
+    int confidenceCount = 0;
+    for (const AppleVerdict &verdict : analysis.apples) {
+        if (verdict.result == analysis.result) {
+            confidenceSum += verdict.confidence;
+            ++confidenceCount;
+        }
+    }
+    analysis.confidence = (confidenceCount > 0) ? confidenceSum / confidenceCount : 0.0f;
+
+    qDebug() << "[AppleDetector::summarizeVerdicts] ✓ Apples:" << analysis.apples.size()
+             << "bad:" << badCount << "result:" << analysis.result;
+}
+
+QVariantList AppleDetector::toVariantList(const QVector<AppleVerdict> &verdicts)
+{
+    QVariantList apples;
+    for (const AppleVerdict &verdict : verdicts) {
+        QVariantMap apple;
+        apple["x"] = verdict.bbox.x();
+        apple["y"] = verdict.bbox.y();
+        apple["width"] = verdict.bbox.width();
+        apple["height"] = verdict.bbox.height();
+        apple["result"] = verdict.result;
+        apple["confidence"] = verdict.confidence;
+        if (verdict.trackId > 0) {
+            apple["trackId"] = verdict.trackId;
+        }
+        apples.append(apple);
+    }
+    return apples;
+}
+
+QVariantMap AppleDetector::toVariantMap(const AnalysisResult &analysis)
+{
+    QVariantMap result;
+    result["ok"] = analysis.ok;
+    if (analysis.ok) {
+        result["result"] = analysis.result;
+        result["confidence"] = analysis.confidence;
+        if (!analysis.apples.isEmpty()) {
+            result["apples"] = toVariantList(analysis.apples);
+        }
+    } else {
+        result["error"] = analysis.error;
+    }
+    return result;
+}
+
+void AppleDetector::finishAnalysis(const AnalysisResult &analysis)
+{
+    if (!analysis.ok) {
+        emit errorOccurred(analysis.error);
+        return;
+    }
+
+    if (!analysis.apples.isEmpty()) {
+        QVariantList apples = toVariantList(analysis.apples);
+
+        emit applesDetected(apples.size(), apples);
+        emit applesAnalyzed(apples);
+    }
+
+    setLastResult(analysis.result);
+    emit analysisComplete(analysis.result, analysis.confidence);
+}
+
+int AppleDetector::trainModel(const QString &datasetPath, bool usePolygonData)
+{
+    qDebug() << "[AppleDetector::trainModel] ========== TRAINING STARTED ==========";
+    qDebug() << "[AppleDetector::trainModel] Dataset path:" << datasetPath;
+    qDebug() << "[AppleDetector::trainModel] Use polygon data:" << usePolygonData;
+
+    // Повторный запуск обучения на том же датасете присоединяется к уже запущенному
+    QString coalesceKey = QString("%1|%2").arg(datasetPath).arg(usePolygonData);
+    if (m_coalescedTrainings.contains(coalesceKey)) {
+        int requestId = m_coalescedTrainings.value(coalesceKey);
+        qDebug() << "[AppleDetector::trainModel] ✓ Coalesced with request" << requestId;
+        return requestId;
+    }
+
+    qDebug() << "[AppleDetector::trainModel] Checking if dataset directory exists...";
+    if (!QDir(datasetPath).exists()) {
+        qWarning() << "[AppleDetector::trainModel] ❌ Dataset directory not found:" << datasetPath;
+        emit errorOccurred("Dataset directory not found: " + datasetPath);
+        return -1;
+    }
+    qDebug() << "[AppleDetector::trainModel] ✓ Dataset directory exists";
+
+    // Обучения выполняются по очереди, анализы продолжают работать на текущей модели
+    beginTraining();
+    emit trainingProgress(0, "Loading dataset...");
+
+    int requestId = m_nextRequestId++;
+    CancellationToken token;
+    m_requestTokens.insert(requestId, token);
+    m_coalescedTrainings.insert(coalesceKey, requestId);
+
+    // Обучение выполняется в пуле потоков, GUI получает прогресс через очередь сигналов
+    QFutureWatcher<TrainingOutcome> *watcher = new QFutureWatcher<TrainingOutcome>(this);
+    connect(watcher, &QFutureWatcher<TrainingOutcome>::finished, this, [this, watcher, requestId, coalesceKey]() {
+        m_coalescedTrainings.remove(coalesceKey);
+        finishTraining(requestId, watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_scheduler.run<TrainingOutcome>(JobScheduler::TRAINING,
+                                                        [this, datasetPath, usePolygonData, token]() {
+        return runTraining(datasetPath, usePolygonData, token);
+    }));
+
+    return requestId;
+}
+
+AppleDetector::TrainingOutcome AppleDetector::runTraining(const QString &datasetPath, bool usePolygonData,
+                                                          const CancellationToken &token)
+{
+    TrainingOutcome outcome;
+
+    try {
+        qDebug() << "[AppleDetector::trainModel] Loading dataset...";
+        // Загружаем датасет
+        QDir datasetDir(datasetPath);
+        QStringList imageFiles = datasetDir.entryList(QStringList() << "*.jpg" << "*.png", QDir::Files);
+
+        qDebug() << "[AppleDetector::trainModel] Found" << imageFiles.size() << "images";
+
+        if (imageFiles.isEmpty()) {
+            qWarning() << "[AppleDetector::trainModel] ❌ No images found in dataset directory";
+            outcome.error = "No images found in dataset directory";
+            return outcome;
+        }
+
+        // Если используем polygon данные, загружаем аннотации
+        if (usePolygonData) {
+            QString annotationsDir = datasetDir.absoluteFilePath("../labelme");
+            if (QDir(annotationsDir).exists()) {
+                m_processorPool->configure([this, annotationsDir]() {
+                    m_imageProcessor->setAnnotationsDirectory(annotationsDir);
+                });
+                qDebug() << "Annotations directory set:" << annotationsDir;
+            } else {
+                qWarning() << "Annotations directory not found, falling back to regular feature extraction";
+                usePolygonData = false;
+            }
+        }
+
+        // Загружаем метки из classes.txt
+        QString classesFile = datasetDir.absoluteFilePath("../classes.txt");
+        qDebug() << "[AppleDetector::trainModel] Looking for classes file:" << classesFile;
+        QFile file(classesFile);
+        QMap<QString, int> imageLabels;
+
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qDebug() << "[AppleDetector::trainModel] ✓ Classes file opened successfully";
+            QTextStream in(&file);
+            int goodLabels = 0, badLabels = 0;
+            while (!in.atEnd()) {
+                QString line = in.readLine().trimmed();
+                if (!line.isEmpty()) {
+                    QStringList parts = line.split(QRegExp("\\s+"));
+                    if (parts.size() >= 2) {
+                        QString imageName = parts[0];
+                        QString label = parts[1];
+                        int labelValue = (label == "хорошее") ? 0 : 1;
+                        imageLabels[imageName] = labelValue;
+                        if (labelValue == 0) goodLabels++;
+                        else badLabels++;
+                    }
+                }
+            }
+            file.close();
+            qDebug() << "[AppleDetector::trainModel] Loaded" << imageLabels.size() << "image labels (Good:" 
+                     << goodLabels << "Bad:" << badLabels << ")";
+        } else {
+            qWarning() << "[AppleDetector::trainModel] ⚠ Could not open classes file:" << classesFile;
+        }
+
+        qDebug() << "[AppleDetector::trainModel] Starting feature extraction...";
+        reportTrainingProgress(20, "Extracting features...");
+
+        // Только изображения с метками; порядок строк признаков совпадает с порядком файлов
+        QStringList labeledFiles;
+        QStringList labeledPaths;
+        std::vector<int> labels;
+        for (const QString &imageFile : imageFiles) {
+            int label = imageLabels.value(imageFile, -1); // -1 = нет метки
+            if (label == -1) {
+                qWarning() << "[AppleDetector::trainModel] ⚠ No label found for image:" << imageFile << ", skipping";
+                continue;
+            }
+            labeledFiles.append(imageFile);
+            labeledPaths.append(datasetDir.absoluteFilePath(imageFile));
+            labels.push_back(label);
+        }
+
+        // Признаки извлекаются параллельно, каждая строка пишется в свою ячейку
+        const int total = labeledFiles.size();
+        std::vector<std::vector<double>> rows(total);
+        std::vector<char> extracted(total, 0);
+        QAtomicInt processedImages(0);
+        QAtomicInt reportedProgress(20);
+
+        // Помощники parallelFor занимают потоки класса TRAINING и проходят
+        // точку вытеснения между изображениями
+        parallelFor(total, [&](int i) {
+            if (token.isCancelled()) {
+                return;
+            }
+
+            const QString &imageFile = labeledFiles[i];
+            try {
+                if (i % 10 == 0) {
+                    qDebug() << "[AppleDetector::trainModel] Processing image" << (i + 1) << "/" << total
+                             << ":" << imageFile << "label:" << (labels[i] == 0 ? "GOOD" : "BAD");
+                }
+
+                ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+                rows[i] = processor->extractFeatures(labeledPaths[i], usePolygonData);
+                extracted[i] = 1;
+            } catch (const std::exception &e) {
+                qWarning() << "[AppleDetector::trainModel] Error processing image" << imageFile << ":" << e.what();
+            }
+
+            // Прогресс отправляем только при смене процента, не чаще 50 раз за проход
+            int processed = processedImages.fetchAndAddRelaxed(1) + 1;
+            int progress = 20 + (processed * 50 / total);
+            int reported = reportedProgress.load();
+            if (progress > reported && reportedProgress.testAndSetOrdered(reported, progress)) {
+                reportTrainingProgress(progress, QString("Processing %1/%2 images...")
+                                       .arg(processed).arg(total));
+            }
+        });
+
+        if (token.isCancelled()) {
+            qDebug() << "[AppleDetector::trainModel] Training cancelled";
+            outcome.cancelled = true;
+            return outcome;
+        }
+
+        // Уплотняем в исходном порядке, пропуская изображения с ошибками
+        std::vector<std::vector<double>> features;
+        std::vector<int> featureLabels;
+        features.reserve(total);
+        featureLabels.reserve(total);
+        for (int i = 0; i < total; ++i) {
+            if (extracted[i]) {
+                features.push_back(std::move(rows[i]));
+                featureLabels.push_back(labels[i]);
+            }
+        }
+        labels.swap(featureLabels);
+
+        qDebug() << "[AppleDetector::trainModel] Feature extraction complete.";
+        qDebug() << "[AppleDetector::trainModel] Extracted features from" << features.size() << "images";
+
+        if (features.empty()) {
+            qWarning() << "[AppleDetector::trainModel] ❌ Failed to extract features from any image";
+            outcome.error = "Failed to extract features from any image";
+            return outcome;
+        }
+
+        if (token.isCancelled()) {
+            outcome.cancelled = true;
+            return outcome;
+        }
+
+        qDebug() << "[AppleDetector::trainModel] Starting model training...";
+        reportTrainingProgress(70, "Training model...");
+
+        // Обучаем новый экземпляр: анализы продолжают работать на текущей модели
+        std::shared_ptr<AppleClassifier> trained = std::make_shared<AppleClassifier>();
+        float accuracy = trained->train(features, labels);
+
+        qDebug() << "[AppleDetector::trainModel] ✓ Training completed! Accuracy:" << accuracy;
+        
+        // Автоматически сохраняем обученную модель
+        QString modelPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                           + "/apple_model.dat";
+        QString appDataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        
+        qDebug() << "[AppleDetector::trainModel] Auto-saving model...";
+        qDebug() << "[AppleDetector::trainModel] AppDataLocation:" << appDataDir;
+        qDebug() << "[AppleDetector::trainModel] Model path:" << modelPath;
+        
+        // Создаём директорию, если её нет
+        if (!QDir(appDataDir).exists()) {
+            qDebug() << "[AppleDetector::trainModel] Creating directory:" << appDataDir;
+            QDir().mkpath(appDataDir);
+        }
+        
+        if (trained->saveModel(modelPath)) {
+            qDebug() << "[AppleDetector::trainModel] ✅ Model auto-saved successfully to:" << modelPath;
+        } else {
+            qWarning() << "[AppleDetector::trainModel] ❌ Failed to auto-save model to:" << modelPath;
+        }
+
+        outcome.ok = true;
+        outcome.accuracy = accuracy;
+        outcome.classifier = trained;
+
+        qDebug() << "Training completed with accuracy:" << accuracy;
+
+    } catch (const std::exception &e) {
+        outcome.error = QString("Error during training: %1").arg(e.what());
+    }
+
+    return outcome;
+}
+
+void AppleDetector::finishTraining(int requestId, const TrainingOutcome &outcome)
+{
+    m_requestTokens.remove(requestId);
+
+    QVariantMap result;
+    result["ok"] = outcome.ok;
+    result["accuracy"] = outcome.accuracy;
+
+    if (outcome.ok) {
+        publishClassifier(outcome.classifier);
+        setModelTrained(true);
+        emit trainingProgress(100, "Training complete");
+        emit trainingComplete(true, outcome.accuracy);
+    } else if (outcome.cancelled) {
+        emit trainingProgress(0, "Training cancelled");
+        emit trainingComplete(false, 0.0f);
+    } else {
+        result["error"] = outcome.error;
+        emit errorOccurred(outcome.error);
+        emit trainingComplete(false, 0.0f);
+    }
+
+    endTraining();
+
+    if (outcome.cancelled) {
+        emit requestCancelled(requestId);
+    } else {
+        emit requestFinished(requestId, result);
+    }
+}
+
+bool AppleDetector::loadModel(const QString &modelPath)
+{
+    qDebug() << "[AppleDetector::loadModel] ========== LOAD MODEL REQUEST ==========";
+    qDebug() << "[AppleDetector::loadModel] Path:" << modelPath;
+
+    if (!QFileInfo::exists(modelPath)) {
+        qWarning() << "[AppleDetector::loadModel] ❌ Model file not found:" << modelPath;
+        emit errorOccurred("Model file not found: " + modelPath);
+        return false;
+    }
+
+    if (m_activeTrainings.loadAcquire() > 0) {
+        qWarning() << "[AppleDetector::loadModel] ❌ Cannot replace model while training";
+        emit errorOccurred("Cannot load model while training");
+        return false;
+    }
+
+    qDebug() << "[AppleDetector::loadModel] File exists, delegating to AppleClassifier...";
+    
+    // Модель загружается в новый экземпляр, текущая обслуживает анализы до замены
+    std::shared_ptr<AppleClassifier> loaded = std::make_shared<AppleClassifier>();
+    if (loaded->loadModel(modelPath)) {
+        publishClassifier(loaded);
+        setModelTrained(true);
+        qDebug() << "[AppleDetector::loadModel] ✅ Model loaded and ready for use!";
+        return true;
+    }
+
+    qWarning() << "[AppleDetector::loadModel] ❌ Failed to load model (AppleClassifier returned false)";
+    emit errorOccurred("Failed to load model");
+    return false;
+}
+
+bool AppleDetector::saveModel(const QString &modelPath)
+{
+    qDebug() << "Saving model to:" << modelPath;
+
+    std::shared_ptr<const AppleClassifier> model = classifier();
+    if (!model->isTrained()) {
+        emit errorOccurred("No trained model to save");
+        return false;
+    }
+
+    if (model->saveModel(modelPath)) {
+        qDebug() << "Model saved successfully";
+        return true;
+    }
+
+    emit errorOccurred("Failed to save model");
+    return false;
+}
+
+std::shared_ptr<const AppleClassifier> AppleDetector::classifier() const
+{
+    return std::atomic_load(&m_classifier);
+}
+
+void AppleDetector::publishClassifier(const std::shared_ptr<const AppleClassifier> &classifier)
+{
+    // Запросы в полёте держат ссылку на прежнюю модель, она удалится после последнего
+    std::atomic_store(&m_classifier, classifier);
+    qDebug() << "[AppleDetector::publishClassifier] ✓ Classifier replaced";
+}
+
+void AppleDetector::beginRequest()
+{
+    bool processingChanged = m_activeRequests.fetchAndAddOrdered(1) == 0 && !m_activeTrainings.loadAcquire();
+    notifyRequestsChanged(processingChanged);
+}
+
+void AppleDetector::endRequest()
+{
+    bool processingChanged = m_activeRequests.fetchAndAddOrdered(-1) == 1 && !m_activeTrainings.loadAcquire();
+    notifyRequestsChanged(processingChanged);
+}
+
+void AppleDetector::beginTraining()
+{
+    bool processingChanged = m_activeTrainings.fetchAndAddOrdered(1) == 0 && !m_activeRequests.loadAcquire();
+    notifyRequestsChanged(processingChanged);
+}
+
+void AppleDetector::endTraining()
+{
+    bool processingChanged = m_activeTrainings.fetchAndAddOrdered(-1) == 1 && !m_activeRequests.loadAcquire();
+    notifyRequestsChanged(processingChanged);
+}
+
+void AppleDetector::notifyRequestsChanged(bool processingChanged)
+{
+    // Кадры начинаются и завершаются в потоках планировщика, а привязки QML
+    // пересчитываются в потоке сигнала - отправляем сигналы в GUI поток
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "notifyRequestsChanged", Qt::QueuedConnection,
+                                  Q_ARG(bool, processingChanged));
+        return;
+    }
+
+    if (processingChanged) {
+        emit isProcessingChanged();
+    }
+    emit pendingRequestsChanged();
+}
+
+void AppleDetector::reportTrainingProgress(int progress, const QString &message)
+{
+    // Обучение идёт в потоке планировщика, обработчики QML - только в GUI потоке
+    QMetaObject::invokeMethod(this, "trainingProgress", Qt::QueuedConnection,
+                              Q_ARG(int, progress), Q_ARG(QString, message));
+}
+
+void AppleDetector::setLastResult(const QString &result)
+{
+    if (m_lastResult != result) {
+        m_lastResult = result;
+        emit lastResultChanged();
+    }
+}
+
+void AppleDetector::setModelTrained(bool trained)
+{
+    // Классификатор сменился: кэшированные вердикты кадров устарели
+    m_frameStateResetRequested.store(1);
+
+    if (modelTrained() != trained) {
+        m_modelTrained.store(trained);
+        emit modelTrainedChanged();
+    }
+}
+
+void AppleDetector::setUseSegmentation(bool use)
+{
+    if (useSegmentation() != use) {
+        m_useSegmentation.store(use);
+        m_frameStateResetRequested.store(1);
+        emit useSegmentationChanged();
+        qDebug() << "Use segmentation set to:" << use;
+    }
+}
+
+void AppleDetector::setMultiAppleMode(bool enabled)
+{
+    if (multiAppleMode() != enabled) {
+        m_multiAppleMode.store(enabled);
+        m_frameStateResetRequested.store(1);
+        updateRequiredFrameSize();
+        emit multiAppleModeChanged();
+        qDebug() << "Multi-apple mode set to:" << enabled;
+    }
+}
+
+void AppleDetector::setDetectionInterval(int interval)
+{
+    interval = qMax(1, interval);
+    if (m_detectionInterval.load() != interval) {
+        m_detectionInterval.store(interval);
+        emit detectionIntervalChanged();
+        qDebug() << "Detection interval set to:" << interval;
+    }
+}
+
+bool AppleDetector::tiledInference() const
+{
+    return m_imageProcessor->tiledInference();
+}
+
+void AppleDetector::setTiledInference(bool enabled)
+{
+    if (m_imageProcessor->tiledInference() != enabled) {
+        m_processorPool->configure([this, enabled]() {
+            m_imageProcessor->setTiledInference(enabled);
+        });
+        updateRequiredFrameSize();
+        emit tiledInferenceChanged();
+        qDebug() << "Tiled inference set to:" << enabled;
+    }
+}
+
+bool AppleDetector::batchedInference() const
+{
+    return m_imageProcessor->tilingOptions().batched;
+}
+
+void AppleDetector::setBatchedInference(bool enabled)
+{
+    if (batchedInference() != enabled) {
+        m_processorPool->configure([this, enabled]() {
+            YOLO11Segmentation::TilingOptions options = m_imageProcessor->tilingOptions();
+            options.batched = enabled;
+            m_imageProcessor->setTilingOptions(options);
+        });
+        qDebug() << "Batched inference set to:" << enabled;
+    }
+}
+
+void AppleDetector::setProgressiveAnalysis(bool enabled)
+{
+    if (m_progressiveAnalysis != enabled) {
+        m_progressiveAnalysis = enabled;
+        emit progressiveAnalysisChanged();
+        qDebug() << "Progressive analysis set to:" << enabled;
+    }
+}
+
+int AppleDetector::analyzeImageWithSegmentation(const QString &imagePath)
+{
+    // Сегментация включается только для этого запроса, общий флаг не меняем
+    return analyzeImageImpl(imagePath, true);
+}
+
+void AppleDetector::analyzeCameraFrame(const QImage &frame)
+{
+    if (!realtimeAnalysis() || !modelTrained()) {
+        return;
+    }
+
+    CameraFrame cameraFrame;
+    cameraFrame.image = frame;
+    cameraFrame.timestampUs = CameraFrame::clockUs();
+    frameMailbox().post(cameraFrame);
+    scheduleFrameDrain();
+}
+
+void AppleDetector::onCameraFrameReady()
+{
+    // Поток камеры: только запускаем обработчик, кадр уже лежит в ящике
+    if (realtimeAnalysis() && modelTrained()) {
+        scheduleFrameDrain();
+    }
+}
+
+void AppleDetector::scheduleFrameDrain()
+{
+    if (m_frameWorkerActive.testAndSetOrdered(0, 1)) {
+        m_scheduler.submit(JobScheduler::REALTIME, [this]() { drainFrames(); });
+    }
+}
+
+void AppleDetector::drainFrames()
+{
+    FrameMailbox<CameraFrame> &mailbox = frameMailbox();
+
+    for (;;) {
+        // Всегда берём новейший кадр: пока идёт анализ, камера его перезаписывает
+        CameraFrame frame;
+        while (mailbox.take(frame)) {
+            processCameraFrame(frame);
+        }
+
+        m_frameWorkerActive.storeRelease(0);
+
+        // Кадр мог прийти между последним take() и сбросом флага
+        if (mailbox.isEmpty() || !m_frameWorkerActive.testAndSetOrdered(0, 1)) {
+            return;
+        }
+    }
+}
+
+void AppleDetector::processCameraFrame(const CameraFrame &frame)
+{
+    FrameJob job;
+    job.frame = frame;
+    if (!prepareFrame(job)) {
+        return;
+    }
+
+    if (m_pipelined.loadAcquire()) {
+        // Следующий кадр готовится, пока текущий в инференсе; очередь ограничена,
+        // поэтому при медленном инференсе ждём здесь, а камера перезаписывает ящик
+        if (!m_preparedFrames.push(job)) {
+            endRequest(); // Конвейер остановлен
+        }
+        return;
+    }
+
+    // Между стадиями уступаем поток интерактивному анализу, если он ждёт
+    m_scheduler.checkpoint(JobScheduler::REALTIME);
+    inferFrame(job);
+    m_scheduler.checkpoint(JobScheduler::REALTIME);
+    finishFrame(job, false);
+}
+
+bool AppleDetector::prepareFrame(FrameJob &job)
+{
+    job.useSegmentation = useSegmentation();
+    job.multiApple = multiAppleMode();
+
+    int inputSize = 0;
+    {
+        QMutexLocker locker(&m_governorMutex);
+        if (!m_governor.shouldProcessFrame()) {
+            m_framesSkipped.fetchAndAddRelaxed(1);
+            return false; // Пропускаем кадр по решению регулятора
+        }
+        inputSize = m_governor.inputSize();
+    }
+
+    beginRequest();
+
+    if (m_frameStateResetRequested.fetchAndStoreOrdered(0)) {
+        m_tracker.reset();
+        m_sceneDetector.reset();
+        m_qualityGate.reset();
+    }
+
+    // Кадр обходится один раз: миниатюра сцены строится из буфера проверки качества
+    LumaBuffer luma = LumaBuffer::fromFrame(job.frame, FrameQualityGate::ANALYSIS_SIZE);
+    LumaBuffer thumbnail = luma.downscaled(SceneChangeDetector::THUMBNAIL_SIZE);
+
+    // Сцена не изменилась: повторяем прошлый результат без полного анализа
+    if (!m_sceneDetector.hasChanged(thumbnail)) {
+        m_framesUnchanged.fetchAndAddRelaxed(1);
+        job.reuseLast = true;
+        job.sceneReference = m_sceneReference;
+        return true;
+    }
+
+    // Размытые и плохо экспонированные кадры отбрасываем до извлечения признаков
+    FrameQualityGate::Result quality = m_qualityGate.evaluate(luma);
+    if (!quality.accepted()) {
+        m_framesRejected.fetchAndAddRelaxed(1);
+        job.analysis.ok = true;
+        job.analysis.rejectReason = FrameQualityGate::verdictToString(quality.verdict);
+        job.done = true;
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Опорный кадр сцены - последний отправленный на полный анализ
+    m_sceneDetector.setReference(thumbnail);
+    job.sceneReference = ++m_sceneReference;
+
+    if (job.multiApple) {
+        // Несколько яблок отслеживаем трекером, детекция - раз в несколько кадров
+        job.analysis = trackApples(job.frame, job.useSegmentation);
+        job.done = true;
+    } else {
+        bool hasModel = false;
+        {
+            ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+            hasModel = processor->detectorDecides();
+        }
+
+        // Конвертация в RGB только в размере входа детектора
+        if (hasModel) {
+            job.detectorInput = job.frame.toImage(inputSize);
+        }
+    }
+
+    job.stageMs[0] = timer.elapsed();
+    return true;
+}
+
+void AppleDetector::inferFrame(FrameJob &job)
+{
+    if (job.done || job.reuseLast) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+        if (!job.detectorInput.isNull()) {
+            job.detected = processor->detectApple(job.detectorInput);
+        } else if (job.frame.isYuv()) {
+            job.detected = processor->detectApple(job.frame.yuv);
+        } else {
+            job.detected = processor->detectApple(job.frame.image);
+        }
+    } catch (const std::exception &e) {
+        job.analysis.error = QString("Error during analysis: %1").arg(e.what());
+        job.done = true;
+    }
+
+    job.stageMs[1] = timer.elapsed();
+}
+
+void AppleDetector::finishFrame(FrameJob &job, bool pipelined)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    AnalysisResult analysis;
+
+    if (job.reuseLast) {
+        // В конвейере кадр готовится, пока его опорный кадр ещё в инференсе:
+        // повторяем только успешный результат этого опорного кадра
+        bool available = false;
+        {
+            QMutexLocker locker(&m_lastFrameMutex);
+            available = m_lastFrameReference == job.sceneReference;
+            if (available) {
+                analysis = m_lastFrameAnalysis;
+            }
+        }
+
+        if (!available) {
+            m_framesSkipped.fetchAndAddRelaxed(1);
+            endRequest();
+            return;
+        }
+    } else if (job.done) {
+        analysis = job.analysis;
+    } else if (!job.detected) {
+        analysis.ok = true;
+        analysis.result = "не яблоко";
+        analysis.confidence = 0.95f;
+    } else {
+        try {
+            ContextPool<ImageProcessor>::Lease processor(*m_processorPool);
+
+            // YUV признаки читаются прямо из плоскостей Y и UV
+            std::vector<double> features = job.frame.isYuv()
+                    ? processor->extractFeatures(job.frame.yuv)
+                    : processor->extractFeatures(job.frame.image, QString(), job.useSegmentation);
+
+            float confidence = 0.0f;
+            AppleClassifier::AppleQuality quality = classifier()->predict(features, confidence);
+
+            analysis.ok = true;
+            analysis.result = AppleClassifier::qualityToString(quality);
+            analysis.confidence = confidence;
+        } catch (const std::exception &e) {
+            analysis.error = QString("Error during analysis: %1").arg(e.what());
+        }
+    }
+
+    job.stageMs[2] = timer.elapsed();
+    analysis.frameTimestampUs = job.frame.timestampUs;
+
+    const bool analysed = !job.reuseLast && analysis.rejectReason.isEmpty();
+    if (analysed) {
+        if (analysis.ok) {
+            QMutexLocker locker(&m_lastFrameMutex);
+            m_lastFrameAnalysis = analysis;
+            m_lastFrameReference = job.sceneReference;
+        } else {
+            // Опорный кадр сцены не получил результата
+            m_frameStateResetRequested.store(1);
+        }
+
+        // Регулятору нужна цена кадра: в конвейере пропускную способность
+        // задаёт самая медленная стадия, иначе - сумма стадий
+        qint64 frameMs = pipelined
+                ? qMax(job.stageMs[0], qMax(job.stageMs[1], job.stageMs[2]))
+                : job.stageMs[0] + job.stageMs[1] + job.stageMs[2];
+
+        bool changed = false;
+        int inputSize = 0;
+        {
+            QMutexLocker locker(&m_governorMutex);
+            changed = m_governor.reportFrameTime(frameMs);
+            inputSize = m_governor.inputSize();
+        }
+
+        if (changed) {
+            m_processorPool->configure([this, inputSize]() {
+                m_imageProcessor->setDetectorInputSize(inputSize);
+            });
+            QMetaObject::invokeMethod(this, "updateRequiredFrameSize", Qt::QueuedConnection);
+        }
+    }
+
+    // Запрос завершается в GUI потоке вместе с публикацией результата
+    QMetaObject::invokeMethod(this, "onFrameAnalyzed", Qt::QueuedConnection,
+                              Q_ARG(AppleDetector::AnalysisResult, analysis));
+}
+
+void AppleDetector::setPipelinedRealtime(bool enabled)
+{
+    if (m_pipelinedRealtime != enabled) {
+        m_pipelinedRealtime = enabled;
+        updatePipeline();
+        emit pipelinedRealtimeChanged();
+        qDebug() << "Pipelined realtime set to:" << enabled;
+    }
+}
+
+void AppleDetector::updatePipeline()
+{
+    bool run = realtimeAnalysis() && m_pipelinedRealtime;
+    if (run && !m_pipelined.loadAcquire()) {
+        startPipeline();
+    } else if (!run && m_pipelined.loadAcquire()) {
+        stopPipeline();
+    }
+}
+
+void AppleDetector::startPipeline()
+{
+    m_preparedFrames.reopen();
+    m_inferredFrames.reopen();
+
+    // Подготовку выполняет обработчик кадров, инференс и классификация - свои потоки
+    QtConcurrent::run(&m_pipelineThreads, [this]() { runInferenceStage(); });
+    QtConcurrent::run(&m_pipelineThreads, [this]() { runFinishStage(); });
+
+    m_pipelined.storeRelease(1);
+    qDebug() << "[AppleDetector::startPipeline] ✓ Pipeline started, depth:" << PIPELINE_DEPTH;
+}
+
+void AppleDetector::stopPipeline()
+{
+    m_pipelined.storeRelease(0);
+
+    // Закрытие проходит по стадиям: кадры в очередях дообрабатываются
+    m_preparedFrames.close();
+    m_pipelineThreads.waitForDone();
+
+    qDebug() << "[AppleDetector::stopPipeline] ✓ Pipeline stopped";
+}
+
+void AppleDetector::runInferenceStage()
+{
+    FrameJob job;
+    while (m_preparedFrames.pop(job)) {
+        inferFrame(job);
+        m_inferredFrames.push(job);
+    }
+
+    // Вход закрыт и пуст: передаём закрытие следующей стадии
+    m_inferredFrames.close();
+}
+
+void AppleDetector::runFinishStage()
+{
+    FrameJob job;
+    while (m_inferredFrames.pop(job)) {
+        finishFrame(job, true);
+    }
+}
+
+void AppleDetector::onFrameAnalyzed(const AppleDetector::AnalysisResult &analysis)
+{
+    // Отброшенный кадр не меняет показанный результат
+    if (analysis.rejectReason.isEmpty()) {
+        finishAnalysis(analysis);
+    } else {
+        emit frameRejected(analysis.rejectReason);
+    }
+    endRequest();
+    m_framesPublished.fetchAndAddRelaxed(1);
+
+    emit governorChanged();
+    emit frameStatsChanged();
+
+    if (analysis.frameTimestampUs >= 0) {
+        emit frameProcessed(CameraFrame::clockUs() - analysis.frameTimestampUs);
+    }
+}
+
+void AppleDetector::setReplaySource(FrameReplaySource *source)
+{
+    if (m_replaySource) {
+        disconnect(m_replaySource, &FrameReplaySource::frameReady,
+                   this, &AppleDetector::onCameraFrameReady);
+    }
+
+    m_replaySource = source;
+
+    if (source) {
+        // Кадры записи идут тем же путём, что и кадры камеры
+        m_frameMailbox.storeRelease(&source->frameMailbox());
+        connect(source, &FrameReplaySource::frameReady,
+                this, &AppleDetector::onCameraFrameReady, Qt::DirectConnection);
+    } else {
+        m_frameMailbox.storeRelease(&m_cameraHandler->frameMailbox());
+    }
+
+    emit frameStatsChanged();
+    qDebug() << "Replay source set to:" << (source != nullptr);
+}
+
+void AppleDetector::setRealtimeAnalysis(bool enabled)
+{
+    if (realtimeAnalysis() != enabled) {
+        m_realtimeAnalysis.store(enabled);
+
+        // Кадры видоискателя нужны только в real-time режиме без воспроизведения записи
+        m_cameraHandler->setFrameStreaming(enabled && !m_replaySource);
+
+        // Каждый сеанс начинаем с полного качества
+        int inputSize = 0;
+        {
+            QMutexLocker locker(&m_governorMutex);
+            m_governor.reset();
+            inputSize = m_governor.inputSize();
+        }
+        frameMailbox().resetCounters();
+        m_framesUnchanged.store(0);
+        m_framesRejected.store(0);
+        m_framesSkipped.store(0);
+        m_framesPublished.store(0);
+        m_frameStateResetRequested.store(1);
+        emit frameStatsChanged();
+
+        m_processorPool->configure([this, inputSize]() {
+            m_imageProcessor->setDetectorInputSize(inputSize);
+        });
+        updateRequiredFrameSize();
+        emit governorChanged();
+
+        updatePipeline();
+
+        qDebug() << "Realtime analysis set to:" << enabled;
+    }
+}
+
+void AppleDetector::setTargetFps(double fps)
+{
+    QMutexLocker locker(&m_governorMutex);
+    if (!qFuzzyCompare(m_governor.targetFps(), fps)) {
+        m_governor.setTargetFps(fps);
+        qDebug() << "Target FPS set to:" << m_governor.targetFps();
+        locker.unlock();
+        emit governorChanged();
+    }
+}
+
+double AppleDetector::targetFps() const
+{
+    QMutexLocker locker(&m_governorMutex);
+    return m_governor.targetFps();
+}
+
+int AppleDetector::detectorInputSize() const
+{
+    QMutexLocker locker(&m_governorMutex);
+    return m_governor.inputSize();
+}
+
+int AppleDetector::frameSkip() const
+{
+    QMutexLocker locker(&m_governorMutex);
+    return m_governor.frameSkip();
+}
+
+double AppleDetector::averageLatency() const
+{
+    QMutexLocker locker(&m_governorMutex);
+    return m_governor.averageLatencyMs();
+}
+
+int AppleDetector::framesProduced() const
+{
+    return frameMailbox().produced();
+}
+
+int AppleDetector::framesConsumed() const
+{
+    return frameMailbox().consumed();
+}
+
+int AppleDetector::framesDropped() const
+{
+    return frameMailbox().dropped();
+}
+
+void AppleDetector::initInferenceProfile()
+{
+    QString profilePath = InferenceAutotuner::defaultProfilePath();
+    InferenceAutotuner::Profile profile = InferenceAutotuner::loadProfile(profilePath);
+
+    if (profile.valid) {
+        qDebug() << "[AppleDetector::initInferenceProfile] ✓ Loaded inference profile:" << profile.description();
+        applyInferenceProfile(profile);
+        return;
+    }
+
+    // Первый запуск: если в системе есть модели, подбираем конфигурацию в фоне
+    if (!m_options.autotune) {
+        qDebug() << "[AppleDetector::initInferenceProfile] No saved profile, autotune disabled";
+        return;
+    }
+    if (!InferenceAutotuner(m_options.modelsDir, m_options.datasetDir).candidates().isEmpty()) {
+        qDebug() << "[AppleDetector::initInferenceProfile] No saved profile, starting autotune";
+        autotuneInference();
+    }
+}
+
+void AppleDetector::autotuneInference()
+{
+    if (m_autotuneWatcher->isRunning()) {
+        qDebug() << "[AppleDetector::autotuneInference] Autotune already running";
+        return;
+    }
+
+    QString modelDir = m_options.modelsDir;
+    QString datasetDir = m_options.datasetDir;
+    CancellationToken token;
+    m_autotuneToken = token;
+    m_autotuneWatcher->setFuture(QtConcurrent::run([modelDir, datasetDir, token]() -> InferenceAutotuner::Profile {
+        InferenceAutotuner tuner(modelDir, datasetDir);
+        return tuner.run(std::function<void(int, int)>(), token);
+    }));
+    emit autotuneRunningChanged();
+}
+
+void AppleDetector::onAutotuneFinished()
+{
+    InferenceAutotuner::Profile profile = m_autotuneWatcher->result();
+    emit autotuneRunningChanged();
+
+    // Профиль не сохраняется: следующий запуск снова попробует подобрать конфигурацию
+    if (!profile.valid) {
+        emit autotuneComplete(false, "No inference configuration meets the accuracy floor");
+        return;
+    }
+
+    InferenceAutotuner::saveProfile(profile, InferenceAutotuner::defaultProfilePath());
+    applyInferenceProfile(profile);
+    emit autotuneComplete(true, profile.description());
+}
+
+void AppleDetector::applyInferenceProfile(const InferenceAutotuner::Profile &profile)
+{
+    // Модель загружается один раз в прототип, контексты пересоздаются с новыми весами
+    m_processorPool->configure([this, profile]() {
+        m_imageProcessor->setIntraOpThreads(profile.threads);
+
+        if (profile.model == InferenceAutotuner::YOLO11) {
+            m_imageProcessor->setDetectorInputSize(profile.inputSize);
+            m_imageProcessor->loadYOLO11Model(profile.modelPath);
+        } else {
+            m_imageProcessor->loadYOLACTModel(profile.modelPath);
+        }
+    });
+    updateRequiredFrameSize();
+
+    if (profile.model == InferenceAutotuner::YOLO11) {
+        // Профиль задаёт полное качество для регулятора real-time режима
+        {
+            QMutexLocker locker(&m_governorMutex);
+            m_governor.setMaxInputSize(profile.inputSize);
+            m_governor.reset();
+        }
+        emit governorChanged();
+    }
 }
 
 void AppleDetector::onCameraError(const QString &error)
@@ -3,12 +3,36 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QImage>
 #include <QVariantMap>
+#include <QVector>
+#include <QRectF>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QDateTime>
+#include <QHash>
+#include "RealtimeGovernor.h"
+#include "ContextPool.h"
+#include "InferenceAutotuner.h"
+#include "CameraFrame.h"
+#include "AppleTracker.h"
+#include "SceneChangeDetector.h"
+#include "FrameQualityGate.h"
+#include "StillImage.h"
+#include "BoundedQueue.h"
+#include "CancellationToken.h"
+#include "JobScheduler.h"
+#include <functional>
+#include <memory>
+#include <vector>
 
 class ImageProcessor;
 class AppleClassifier;
 class CameraHandler;
+class FrameReplaySource;
 
 /**
  * @brief Основной класс для детекции и классификации яблок
@@ -21,56 +45,277 @@ class AppleDetector : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isProcessing READ isProcessing NOTIFY isProcessingChanged)
+    Q_PROPERTY(int pendingRequests READ pendingRequests NOTIFY pendingRequestsChanged)
     Q_PROPERTY(QString lastResult READ lastResult NOTIFY lastResultChanged)
     Q_PROPERTY(bool modelTrained READ modelTrained NOTIFY modelTrainedChanged)
     Q_PROPERTY(bool useSegmentation READ useSegmentation WRITE setUseSegmentation NOTIFY useSegmentationChanged)
+    Q_PROPERTY(bool multiAppleMode READ multiAppleMode WRITE setMultiAppleMode NOTIFY multiAppleModeChanged)
     Q_PROPERTY(CameraHandler* cameraHandler READ cameraHandler CONSTANT)
+    Q_PROPERTY(bool tiledInference READ tiledInference WRITE setTiledInference NOTIFY tiledInferenceChanged)
+    Q_PROPERTY(double targetFps READ targetFps WRITE setTargetFps NOTIFY governorChanged)
+    Q_PROPERTY(int detectorInputSize READ detectorInputSize NOTIFY governorChanged)
+    Q_PROPERTY(int frameSkip READ frameSkip NOTIFY governorChanged)
+    Q_PROPERTY(double averageLatency READ averageLatency NOTIFY governorChanged)
+    Q_PROPERTY(bool autotuneRunning READ autotuneRunning NOTIFY autotuneRunningChanged)
+    Q_PROPERTY(bool pipelinedRealtime READ pipelinedRealtime WRITE setPipelinedRealtime NOTIFY pipelinedRealtimeChanged)
+    Q_PROPERTY(bool progressiveAnalysis READ progressiveAnalysis WRITE setProgressiveAnalysis NOTIFY progressiveAnalysisChanged)
+    Q_PROPERTY(int detectionInterval READ detectionInterval WRITE setDetectionInterval NOTIFY detectionIntervalChanged)
+    Q_PROPERTY(int framesProduced READ framesProduced NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesConsumed READ framesConsumed NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesDropped READ framesDropped NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesUnchanged READ framesUnchanged NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesRejected READ framesRejected NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesSkipped READ framesSkipped NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesPublished READ framesPublished NOTIFY frameStatsChanged)
 
 public:
+    /**
+     * @brief Результат классификации одного яблока на изображении
+     */
+    struct AppleVerdict {
+        QRectF bbox;
+        QString result;
+        float confidence;
+        int trackId;          // Идентификатор трека в real-time режиме (0 - без трекинга)
+
+        AppleVerdict() : confidence(0.0f), trackId(0) {}
+    };
+
+    /**
+     * @brief Результат анализа одного изображения
+     */
+    struct AnalysisResult {
+        bool ok;              // false - ошибка, текст в error
+        QString result;       // "хорошее", "плохое", "не яблоко"
+        float confidence;
+        QString error;
+        QVector<AppleVerdict> apples;   // Вердикты по яблокам (режим нескольких яблок)
+        QString rejectReason;           // Кадр отброшен проверкой качества (real-time режим)
+        qint64 frameTimestampUs;        // Метка кадра камеры (CameraFrame::clockUs), -1 - не кадр
+        bool cancelled;                 // Запрос отменён до завершения
+
+        AnalysisResult() : ok(false), confidence(0.0f), frameTimestampUs(-1), cancelled(false) {}
+    };
+
+    /**
+     * @brief Параметры запуска детектора
+     */
+    struct Options {
+        QString modelsDir;          // Модели ONNX для автонастройки инференса
+        QString datasetDir;         // Датасет с разметкой labelme для замера точности
+        bool autotune;              // Подбирать конфигурацию в фоне, если профиля ещё нет
+
+        Options();
+    };
+
     explicit AppleDetector(QObject *parent = nullptr);
+
+    /**
+     * @brief Детектор с заданными путями; консольная утилита запускается без
+     *        фоновой автонастройки, чтобы не ждать её при выходе
+     */
+    explicit AppleDetector(const Options &options, QObject *parent = nullptr);
     ~AppleDetector();
 
-    bool isProcessing() const { return m_isProcessing; }
+    bool isProcessing() const { return m_activeTrainings.loadAcquire() > 0 || m_activeRequests.loadAcquire() > 0; }
+    int pendingRequests() const { return m_activeRequests.loadAcquire() + m_activeTrainings.loadAcquire(); }
     QString lastResult() const { return m_lastResult; }
-    bool modelTrained() const { return m_modelTrained; }
-    bool useSegmentation() const { return m_useSegmentation; }
+    bool modelTrained() const { return m_modelTrained.load() != 0; }
+    bool useSegmentation() const { return m_useSegmentation.load() != 0; }
+    bool multiAppleMode() const { return m_multiAppleMode.load() != 0; }
     CameraHandler* cameraHandler() const { return m_cameraHandler; }
 
+    double targetFps() const;
+    int detectorInputSize() const;
+    int frameSkip() const;
+    double averageLatency() const;
+    bool autotuneRunning() const { return m_autotuneWatcher->isRunning(); }
+
+    /**
+     * @brief Полная детекция раз в N кадров при трекинге яблок (real-time, несколько яблок)
+     */
+    int detectionInterval() const { return m_detectionInterval.load(); }
+    void setDetectionInterval(int interval);
+
+    /**
+     * @brief Конвейерный real-time режим: подготовка, инференс и классификация
+     *        соседних кадров выполняются одновременно в разных потоках
+     */
+    bool pipelinedRealtime() const { return m_pipelinedRealtime; }
+    bool realtimeAnalysis() const { return m_realtimeAnalysis.load() != 0; }
+    void setPipelinedRealtime(bool enabled);
+
+    /**
+     * @brief Прогрессивный анализ файлов: сначала предварительный вердикт
+     *        по уменьшенному декодированию JPEG, затем полный анализ
+     */
+    bool progressiveAnalysis() const { return m_progressiveAnalysis; }
+    void setProgressiveAnalysis(bool enabled);
+
+    /**
+     * @brief Уверенность предварительного вердикта, при которой полный анализ
+     *        не выполняется (больше 1 - всегда уточнять)
+     *
+     * С сегментацией и для файлов с аннотацией полный анализ выполняется всегда
+     */
+    float previewSkipConfidence() const { return m_previewSkipConfidence; }
+    void setPreviewSkipConfidence(float confidence) { m_previewSkipConfidence = confidence; }
+
+    /**
+     * @brief Источник кадров real-time режима вместо камеры (запись FrameRecorder)
+     * @param source nullptr - снова камера. Источник должен жить, пока подключён
+     */
+    void setReplaySource(FrameReplaySource *source);
+
+    int framesProduced() const;
+    int framesConsumed() const;
+    int framesDropped() const;
+
+    /**
+     * @brief Кадры без смены сцены: повторён прошлый результат без анализа
+     */
+    int framesUnchanged() const { return m_framesUnchanged.load(); }
+
+    /**
+     * @brief Кадры, отброшенные проверкой качества (размытие, экспозиция)
+     */
+    int framesRejected() const { return m_framesRejected.load(); }
+
+    /**
+     * @brief Кадры, взятые из ящика, но пропущенные регулятором
+     */
+    int framesSkipped() const { return m_framesSkipped.load(); }
+
+    /**
+     * @brief Кадры, результат которых опубликован в GUI потоке
+     *
+     * Каждый выданный кадр либо вытеснен в ящике, либо пропущен регулятором,
+     * либо опубликован: produced == dropped + skipped + published, когда
+     * конвейер пуст.
+     */
+    int framesPublished() const { return m_framesPublished.load(); }
+
+    bool tiledInference() const;
+
+    /**
+     * @brief Модель YOLO11 принимает батч изображений (динамическая размерность батча)
+     */
+    bool batchedInference() const;
+    void setBatchedInference(bool enabled);
+
+    /**
+     * @brief Анализ нескольких декодированных изображений (потокобезопасно, блокирует)
+     *
+     * Детекция выполняется одним батчем, если модель это поддерживает
+     * (setBatchedInference), иначе параллельно по изображениям;
+     * признаки и классификация - параллельно.
+     * Решение по каждому изображению то же, что у одиночного анализа.
+     * @param imageNames Имена файлов для поиска аннотаций (пустые - без аннотаций)
+     * @return Результаты в том же порядке
+     */
+    QVector<AnalysisResult> analyzeBatch(const QVector<QImage> &images, const QStringList &imageNames,
+                                         bool useSegmentation, bool multiApple);
+
+    /**
+     * @brief Планировщик фоновых задач детектора (для внешних источников запросов)
+     */
+    JobScheduler &scheduler() { return m_scheduler; }
+
+    static QVariantMap toVariantMap(const AnalysisResult &analysis);
+
+    /**
+     * @brief Итог по изображению из вердиктов отдельных яблок
+     */
+    static void summarizeVerdicts(AnalysisResult &analysis);
+
     void setUseSegmentation(bool use);
+    void setMultiAppleMode(bool enabled);
+    void setTiledInference(bool enabled);
+    void setTargetFps(double fps);
 
 public slots:
     /**
      * @brief Анализирует изображение яблока
      * @param imagePath Путь к файлу изображения
+     *
+     * Анализ выполняется в пуле потоков, несколько изображений
+     * обрабатываются параллельно. Результат приходит в analysisComplete
+     * и requestFinished. В прогрессивном режиме ему может предшествовать
+     * предварительный analysisComplete (provisional = true).
+     * @return Идентификатор запроса или -1, если анализ не запущен
      */
-    void analyzeImage(const QString &imagePath);
+    int analyzeImage(const QString &imagePath);
 
     /**
      * @brief Анализирует изображение с использованием polygon данных
+     * @return Идентификатор запроса или -1, если анализ не запущен
+     */
+    int analyzeImageWithSegmentation(const QString &imagePath);
+
+    /**
+     * @brief Заранее готовит выбранное изображение к анализу
+     *
+     * Декодирование, детекция и признаки выполняются в фоне с низким
+     * приоритетом (класс BATCH); analyzeImage() того же файла с теми же
+     * настройками затем только классифицирует. Новый вызов отменяет
+     * подготовку предыдущего изображения, пустой путь - просто отменяет.
      */
-    void analyzeImageWithSegmentation(const QString &imagePath);
+    void prefetch(const QString &imagePath);
 
     /**
-     * @brief Обучает модель на датасете
+     * @brief Обучает модель на датасете (в пуле потоков)
      * @param datasetPath Путь к папке с датасетом
      * @param usePolygonData Использовать polygon данные для обучения
+     * @return Идентификатор запроса или -1, если обучение не запущено
+     */
+    int trainModel(const QString &datasetPath, bool usePolygonData = false);
+
+    /**
+     * @brief Анализирует все изображения папки (рекурсивно) потоковым конвейером
+     * @param dirPath Папка с изображениями
+     * @param outputPath Файл результатов: .csv или JSON Lines (пустой - в данных приложения)
+     * @return Идентификатор запроса или -1, если анализ не запущен
+     *
+     * Работает с классом приоритета BATCH: одиночные анализы его вытесняют
+     */
+    int analyzeDirectory(const QString &dirPath, const QString &outputPath = QString());
+
+    /**
+     * @brief Отменяет запрос анализа или обучения
+     *
+     * Работа прерывается в ближайшей контрольной точке,
+     * затем приходит requestCancelled
      */
-    void trainModel(const QString &datasetPath, bool usePolygonData = false);
+    void cancelRequest(int requestId);
+    void cancelAllRequests();
 
     /**
      * @brief Загружает предобученную модель
      * @param modelPath Путь к файлу модели
+     * @return false, если модель не загружена (причина приходит в errorOccurred)
      */
-    void loadModel(const QString &modelPath);
+    bool loadModel(const QString &modelPath);
 
     /**
      * @brief Сохраняет обученную модель
      * @param modelPath Путь для сохранения
+     * @return false, если модель не сохранена (причина приходит в errorOccurred)
+     */
+    bool saveModel(const QString &modelPath);
+
+    /**
+     * @brief Запускает автонастройку инференса (бенчмарк моделей в фоне)
+     *
+     * Лучший профиль сохраняется в директорию данных приложения
+     * и загружается при следующих запусках
      */
-    void saveModel(const QString &modelPath);
+    void autotuneInference();
 
     /**
      * @brief Анализирует кадр с камеры
+     *
+     * Кадр кладётся в ящик новейшего кадра и анализируется в фоне;
+     * если анализатор занят, более старый непрочитанный кадр отбрасывается
      */
     void analyzeCameraFrame(const QImage &frame);
 
@@ -84,8 +329,10 @@ signals:
      * @brief Сигнал завершения анализа
      * @param result Результат: "хорошее", "плохое", "не яблоко"
      * @param confidence Уверенность модели (0.0 - 1.0)
+     * @param provisional Предварительный результат по уменьшенному изображению,
+     *        окончательный придёт следом
      */
-    void analysisComplete(const QString &result, float confidence);
+    void analysisComplete(const QString &result, float confidence, bool provisional = false);
 
     /**
      * @brief Сигнал прогресса обучения
@@ -101,10 +348,49 @@ signals:
      */
     void trainingComplete(bool success, float accuracy);
 
+    /**
+     * @brief Прогресс пакетного анализа папки
+     */
+    void directoryProgress(int processed, double imagesPerSecond);
+
+    /**
+     * @brief Пакетный анализ завершён
+     * @param report processed, failed, elapsedSec, imagesPerSecond, outputPath
+     */
+    void directoryAnalysisComplete(const QVariantMap &report);
+
+    /**
+     * @brief Запрос завершён (успешно или с ошибкой)
+     * @param result ok, result/confidence/apples для анализа, accuracy для обучения, error
+     */
+    void requestFinished(int requestId, const QVariantMap &result);
+    void requestCancelled(int requestId);
+
+    /**
+     * @brief Предварительный результат запроса (прогрессивный анализ)
+     */
+    void requestProvisional(int requestId, const QVariantMap &result);
+
     void isProcessingChanged();
+    void pendingRequestsChanged();
     void lastResultChanged();
     void modelTrainedChanged();
     void useSegmentationChanged();
+    void multiAppleModeChanged();
+    void tiledInferenceChanged();
+    void governorChanged();
+    void autotuneRunningChanged();
+    void frameStatsChanged();
+    void detectionIntervalChanged();
+    void pipelinedRealtimeChanged();
+    void progressiveAnalysisChanged();
+
+    /**
+     * @brief Сигнал завершения автонастройки
+     * @param success Найдена ли конфигурация
+     * @param summary Описание выбранной конфигурации
+     */
+    void autotuneComplete(bool success, const QString &summary);
     void errorOccurred(const QString &error);
 
     /**
@@ -112,24 +398,288 @@ signals:
      */
     void applesDetected(int count, const QVariantList &locations);
 
+    /**
+     * @brief Сигнал с результатами по каждому яблоку (режим нескольких яблок)
+     * @param apples Список {x, y, width, height, result, confidence}
+     *
+     * Приходит перед analysisComplete, который содержит итог по изображению
+     */
+    void applesAnalyzed(const QVariantList &apples);
+
+    /**
+     * @brief Кадр камеры отброшен до анализа
+     * @param reason Причина ("кадр размыт", "слишком темно", "пересвет")
+     */
+    void frameRejected(const QString &reason);
+
+    /**
+     * @brief Результат кадра real-time режима опубликован
+     * @param latencyUs Задержка от приёма кадра до публикации, мкс
+     */
+    void frameProcessed(qint64 latencyUs);
+
 private slots:
-    void onCameraFrameAvailable(const QImage &frame);
+    void onCameraFrameReady();
     void onCameraError(const QString &error);
+    void onAutotuneFinished();
+    void onFrameAnalyzed(const AppleDetector::AnalysisResult &analysis);
+    void onStillImageCaptured(const StillImage &still);
+    void onPreviewAnalyzed(int requestId, const AppleDetector::AnalysisResult &preview);
+
+    /**
+     * @brief Сообщает камере размер кадра под текущие режимы и вход детектора
+     *
+     * Вызывается в GUI потоке: при смене режима, профиля инференса и
+     * (через очередь) когда регулятор меняет размер входа детектора
+     */
+    void updateRequiredFrameSize();
+
+    /**
+     * @brief Сигналы числа запросов и занятости (в GUI потоке из любого потока)
+     */
+    void notifyRequestsChanged(bool processingChanged);
 
 private:
-    void setIsProcessing(bool processing);
+    /**
+     * @brief Подготовленное заранее изображение (prefetch)
+     *
+     * Результат пишет задача подготовки до перехода в PREFETCH_DONE,
+     * после этого он только читается
+     */
+    struct Prefetch {
+        enum State {
+            PREFETCH_QUEUED = 0,
+            PREFETCH_RUNNING,
+            PREFETCH_DONE,
+            PREFETCH_DROPPED        // Отменена до запуска или уступлена анализу
+        };
+
+        QString imagePath;
+        QDateTime lastModified;
+        bool useSegmentation;
+        bool multiApple;
+        int generation;         // Поколение контекстов обработки (модель, тайлы, вход детектора)
+        CancellationToken token;
+        QAtomicInt state;
+
+        bool ok;
+        bool detected;
+        std::vector<double> features;
+        QVector<QRectF> appleBoxes;                   // Режим нескольких яблок
+        QVector<std::vector<double>> appleFeatures;   // Пустой вектор - ошибка признаков
+
+        Prefetch() : useSegmentation(false), multiApple(false), generation(0), state(PREFETCH_QUEUED),
+                     ok(false), detected(false) {}
+    };
+
+    void runPrefetch(Prefetch &prefetch);
+    void cancelPrefetch();
+
+    /**
+     * @brief Классификация подготовленного изображения
+     * @return false, если подготовка не завершена или не удалась - нужен полный анализ
+     */
+    bool classifyPrefetched(Prefetch &prefetch, AnalysisResult &analysis);
+
+    /**
+     * @brief Полный анализ изображения в контексте из пула (потокобезопасно)
+     */
+    AnalysisResult runAnalysis(const QString &imagePath, bool useSegmentation, bool multiApple,
+                               const CancellationToken &token = CancellationToken());
+
+    /**
+     * @brief Прогрессивный анализ файла: предварительный вердикт по JPEG,
+     *        уменьшенному при декодировании (1/2-1/8), затем полный анализ
+     *
+     * Предварительный результат публикуется в GUI потоке (onPreviewAnalyzed);
+     * достаточно уверенный становится окончательным без полного анализа.
+     */
+    AnalysisResult runProgressiveAnalysis(int requestId, const QString &imagePath, bool useSegmentation,
+                                          float skipConfidence, const CancellationToken &token);
+
+    /**
+     * @brief Анализ уже декодированного изображения (кадр камеры или файл)
+     * @param imageName Имя файла для поиска аннотаций (пустое для кадров камеры)
+     */
+    AnalysisResult runAnalysis(const QImage &image, const QString &imageName,
+                               bool useSegmentation, bool multiApple,
+                               const CancellationToken &token = CancellationToken());
+
+    /**
+     * @brief Режим нескольких яблок для кадров камеры: детекция раз в N кадров,
+     *        между ними - предсказание треков и кэшированные вердикты
+     *
+     * Вызывается только обработчиком кадров
+     */
+    AnalysisResult trackApples(const CameraFrame &frame, bool useSegmentation);
+
+    static QVariantList toVariantList(const QVector<AppleVerdict> &verdicts);
+    int analyzeImageImpl(const QString &imagePath, bool useSegmentation);
+
+    /**
+     * @brief Проверяет, можно ли начать анализ (модель обучена, обучение не идёт)
+     */
+    bool readyForAnalysis();
+
+    /**
+     * @brief Выполняет анализ в пуле потоков и публикует результат в GUI потоке
+     * @param job Получает идентификатор своего запроса и токен отмены
+     * @return Идентификатор запроса
+     */
+    int startAnalysis(const std::function<AnalysisResult(int requestId, const CancellationToken &)> &job,
+                      const QString &coalesceKey = QString());
+    void finishAnalysis(const AnalysisResult &result);
+
+    /**
+     * @brief Итог обучения в пуле потоков
+     */
+    struct TrainingOutcome {
+        bool ok;
+        bool cancelled;
+        float accuracy;
+        QString error;
+        std::shared_ptr<const AppleClassifier> classifier;    // Новая модель (при ok)
+
+        TrainingOutcome() : ok(false), cancelled(false), accuracy(0.0f) {}
+    };
+
+    /**
+     * @brief Загрузка датасета и обучение (не трогает состояние GUI потока)
+     */
+    TrainingOutcome runTraining(const QString &datasetPath, bool usePolygonData,
+                                const CancellationToken &token);
+    void finishTraining(int requestId, const TrainingOutcome &outcome);
+
+    /**
+     * @brief Запускает обработчик кадров, если он ещё не работает (из любого потока)
+     */
+    void scheduleFrameDrain();
+    FrameMailbox<CameraFrame> &frameMailbox() const { return *m_frameMailbox.loadAcquire(); }
+    void drainFrames();
+    void processCameraFrame(const CameraFrame &frame);
+
+    /**
+     * @brief Кадр камеры между стадиями real-time анализа
+     */
+    struct FrameJob {
+        CameraFrame frame;
+        QImage detectorInput;       // Кадр в размере входа детектора (если модель загружена)
+        bool useSegmentation;       // Режимы на момент подготовки кадра: стадии
+        bool multiApple;            // видят одни и те же значения
+        bool detected;
+        bool reuseLast;             // Сцена не изменилась: повторяем прошлый результат
+        int sceneReference;         // Номер опорного кадра сцены, к которому относится кадр
+        bool done;                  // Результат уже готов (отказ, ошибка, трекинг)
+        AnalysisResult analysis;
+        qint64 stageMs[3];          // Подготовка, инференс, классификация
+
+        FrameJob() : useSegmentation(false), multiApple(false), detected(false), reuseLast(false), sceneReference(0), done(false), stageMs() {}
+    };
+
+    /**
+     * @brief Стадии анализа кадра. В обычном режиме выполняются подряд
+     *        обработчиком кадров, в конвейерном - каждая в своём потоке
+     *
+     * prepareFrame: регулятор, смена сцены, проверка качества, вход детектора.
+     * Возвращает false, если кадр пропущен без запроса.
+     */
+    bool prepareFrame(FrameJob &job);
+    void inferFrame(FrameJob &job);
+    void finishFrame(FrameJob &job, bool pipelined);
+
+    void updatePipeline();
+    void startPipeline();
+    void stopPipeline();
+    void runInferenceStage();
+    void runFinishStage();
+
+    void beginRequest();
+    void endRequest();
+    /**
+     * @brief Текущая модель; снимок остаётся действительным после замены
+     */
+    std::shared_ptr<const AppleClassifier> classifier() const;
+    void publishClassifier(const std::shared_ptr<const AppleClassifier> &classifier);
+
+    void beginTraining();
+    void endTraining();
+    void reportTrainingProgress(int progress, const QString &message);
     void setLastResult(const QString &result);
     void setModelTrained(bool trained);
+    void initInferenceProfile();
+    void applyInferenceProfile(const InferenceAutotuner::Profile &profile);
 
     ImageProcessor *m_imageProcessor;
-    AppleClassifier *m_classifier;
+    // Заменяется атомарно целиком (std::atomic_load/atomic_store), не изменяется на месте
+    std::shared_ptr<const AppleClassifier> m_classifier;
     CameraHandler *m_cameraHandler;
 
-    bool m_isProcessing;
+    // Контексты обработки для параллельных анализов (веса моделей общие).
+    // Все изменения m_imageProcessor выполняются через m_processorPool->configure()
+    ContextPool<ImageProcessor> *m_processorPool;
+    JobScheduler m_scheduler;
+    QAtomicInt m_activeRequests;
+    QAtomicInt m_activeTrainings;
+
+    // Токены отмены незавершённых запросов и ключи для объединения повторов (только GUI поток)
+    QHash<int, CancellationToken> m_requestTokens;
+    QHash<QString, int> m_coalescedRequests;
+    QHash<QString, int> m_coalescedTrainings;
+    int m_nextRequestId;
+
+    // Подготовка выбранного изображения (указатель меняет только GUI поток)
+    std::shared_ptr<Prefetch> m_prefetch;
+
+    // Не более одного обработчика кадров камеры одновременно
+    QAtomicInt m_frameWorkerActive;
+
+    // Ящик кадров: камеры или воспроизводимой записи
+    QAtomicPointer<FrameMailbox<CameraFrame>> m_frameMailbox;
+    FrameReplaySource *m_replaySource;
+
+    // Состояние кадров принадлежит обработчику; GUI поток только запрашивает сброс
+    AppleTracker m_tracker;
+    SceneChangeDetector m_sceneDetector;
+    FrameQualityGate m_qualityGate;
+    AnalysisResult m_lastFrameAnalysis;       // Пишет стадия классификации
+    QMutex m_lastFrameMutex;
+    int m_sceneReference;                     // Номер последнего опорного кадра (пишет подготовка)
+    int m_lastFrameReference;                 // Опорный кадр m_lastFrameAnalysis (под m_lastFrameMutex)
+    QAtomicInt m_detectionInterval;
+    QAtomicInt m_frameStateResetRequested;
+    QAtomicInt m_framesUnchanged;
+    QAtomicInt m_framesRejected;
+    QAtomicInt m_framesSkipped;
+    QAtomicInt m_framesPublished;
+
     QString m_lastResult;
-    bool m_modelTrained;
-    bool m_useSegmentation;
-    bool m_realtimeAnalysis;
+    // Флаги пишет GUI поток, а читают поток камеры и обработчики кадров
+    QAtomicInt m_modelTrained;
+    QAtomicInt m_useSegmentation;
+    QAtomicInt m_multiAppleMode;
+    QAtomicInt m_realtimeAnalysis;
+    bool m_pipelinedRealtime;
+    bool m_progressiveAnalysis;
+    float m_previewSkipConfidence;
+
+    // Регулятор разрешения детектора и пропуска кадров для real-time режима
+    // (используется обработчиком кадров и GUI потоком)
+    RealtimeGovernor m_governor;
+    mutable QMutex m_governorMutex;
+
+    // Конвейер: очередь ёмкостью 2 плюс кадр в инференсе - тройная буферизация входа
+    static const int PIPELINE_DEPTH = 2;
+    BoundedQueue<FrameJob> m_preparedFrames;
+    BoundedQueue<FrameJob> m_inferredFrames;
+    QThreadPool m_pipelineThreads;
+    QAtomicInt m_pipelined;                   // Конвейер запущен (читает обработчик кадров)
+
+    // Фоновая автонастройка конфигурации инференса
+    const Options m_options;
+    QFutureWatcher<InferenceAutotuner::Profile> *m_autotuneWatcher;
+    CancellationToken m_autotuneToken;        // Отменяется при удалении детектора
 };
 
+Q_DECLARE_METATYPE(AppleDetector::AnalysisResult)
+
 #endif // APPLEDETECTOR_H
@@ -0,0 +1,166 @@
+#include "AppleTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double MATCH_IOU = 0.3;            // Минимальный IoU для сопоставления детекции с треком
+const float MIN_CONFIDENCE = 0.5f;       // Ниже - запускаем детекцию досрочно
+const double VELOCITY_SMOOTHING = 0.5;   // Сглаживание оценки скорости
+}
+
+AppleTracker::AppleTracker()
+    : m_detectionInterval(0)
+    , m_confidenceDecay(1.0f)
+    , m_framesSinceDetection(0)
+    , m_nextId(1)
+{
+    setDetectionInterval(5);
+}
+
+void AppleTracker::setDetectionInterval(int interval)
+{
+    m_detectionInterval = std::max(1, interval);
+
+    // Точно предсказанный трек (уверенность 1) доходит до MIN_CONFIDENCE ровно
+    // за интервал, трек с худшим совпадением - раньше и запускает детекцию досрочно
+    m_confidenceDecay = static_cast<float>(std::pow(MIN_CONFIDENCE, 1.0 / m_detectionInterval));
+}
+
+void AppleTracker::advanceFrame()
+{
+    ++m_framesSinceDetection;
+
+    for (Track &track : m_tracks) {
+        track.box.translate(track.velocity);
+        track.confidence *= m_confidenceDecay;
+    }
+}
+
+bool AppleTracker::needsDetection() const
+{
+    if (m_tracks.isEmpty() || m_framesSinceDetection >= m_detectionInterval) {
+        return true;
+    }
+
+    for (const Track &track : m_tracks) {
+        if (track.confidence < MIN_CONFIDENCE) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QVector<int> AppleTracker::update(const QVector<QRectF> &detections)
+{
+    // Сколько кадров треки двигались по предсказанию
+    const int predictedFrames = std::max(1, m_framesSinceDetection);
+    m_framesSinceDetection = 0;
+
+    // Все пары с достаточным IoU, от лучшей к худшей (жадное сопоставление)
+    struct Pair {
+        double iou;
+        int track;
+        int detection;
+    };
+    QVector<Pair> pairs;
+    for (int t = 0; t < m_tracks.size(); ++t) {
+        for (int d = 0; d < detections.size(); ++d) {
+            double overlap = iou(m_tracks[t].box, detections[d]);
+            if (overlap >= MATCH_IOU) {
+                Pair pair = { overlap, t, d };
+                pairs.append(pair);
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair &a, const Pair &b) {
+        return a.iou > b.iou;
+    });
+
+    QVector<int> trackIds(detections.size(), 0);
+    QVector<bool> trackMatched(m_tracks.size(), false);
+
+    for (const Pair &pair : pairs) {
+        if (trackMatched[pair.track] || trackIds[pair.detection] != 0) {
+            continue;
+        }
+
+        Track &track = m_tracks[pair.track];
+        const QRectF &box = detections[pair.detection];
+
+        // Скорость: смещение центра относительно предсказания, распределённое по кадрам
+        QPointF correction = box.center() - track.box.center();
+        track.velocity += correction * (VELOCITY_SMOOTHING / predictedFrames);
+        track.box = box;
+
+        // Уверенность - качество предсказания: IoU предсказанной рамки с детекцией
+        track.confidence = static_cast<float>(pair.iou);
+        track.missed = 0;
+
+        trackMatched[pair.track] = true;
+        trackIds[pair.detection] = track.id;
+    }
+
+    // Несопоставленные треки: удаляем после нескольких промахов
+    QVector<Track> kept;
+    for (int t = 0; t < m_tracks.size(); ++t) {
+        if (!trackMatched[t] && ++m_tracks[t].missed > MAX_MISSED) {
+            continue;
+        }
+        kept.append(m_tracks[t]);
+    }
+    m_tracks = kept;
+
+    // Новые детекции открывают треки
+    for (int d = 0; d < detections.size(); ++d) {
+        if (trackIds[d] != 0) {
+            continue;
+        }
+
+        Track track;
+        track.id = m_nextId++;
+        track.box = detections[d];
+        track.confidence = 1.0f;
+        m_tracks.append(track);
+        trackIds[d] = track.id;
+    }
+
+    return trackIds;
+}
+
+void AppleTracker::setClassification(int trackId, const QString &result, float confidence)
+{
+    for (Track &track : m_tracks) {
+        if (track.id == trackId) {
+            track.classified = true;
+            track.result = result;
+            track.resultConfidence = confidence;
+            return;
+        }
+    }
+}
+
+const AppleTracker::Track *AppleTracker::track(int trackId) const
+{
+    for (const Track &track : m_tracks) {
+        if (track.id == trackId) {
+            return &track;
+        }
+    }
+    return nullptr;
+}
+
+void AppleTracker::reset()
+{
+    m_tracks.clear();
+    m_framesSinceDetection = 0;
+    m_nextId = 1;
+}
+
+double AppleTracker::iou(const QRectF &a, const QRectF &b)
+{
+    QRectF inter = a.intersected(b);
+    double interArea = inter.width() * inter.height();
+    double unionArea = a.width() * a.height() + b.width() * b.height() - interArea;
+    return (unionArea > 0) ? interArea / unionArea : 0.0;
+}
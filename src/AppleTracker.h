@@ -0,0 +1,83 @@
+#ifndef APPLETRACKER_H
+#define APPLETRACKER_H
+
+#include <QRectF>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Лёгкий трекер яблок для real-time режима
+ *
+ * Сопоставляет детекции с треками по IoU и предсказывает положение
+ * между детекциями моделью постоянной скорости. Полная детекция нужна
+ * раз в N кадров или когда уверенность какого-либо трека падает.
+ * Уверенность после детекции равна IoU предсказанной рамки с детекцией
+ * и затухает так, что точный трек доходит до порога ровно за N кадров:
+ * плохо предсказанные треки запускают детекцию раньше.
+ * Классификация яблока хранится в треке и переиспользуется.
+ */
+class AppleTracker
+{
+public:
+    struct Track {
+        int id;
+        QRectF box;                 // Текущее (предсказанное или измеренное) положение
+        QPointF velocity;           // Смещение центра за кадр
+        float confidence;           // Качество предсказания: IoU при детекции, затухает между детекциями
+        int missed;                 // Детекций подряд без сопоставления
+        bool classified;
+        QString result;             // Кэшированный вердикт классификатора
+        float resultConfidence;
+
+        Track()
+            : id(0), confidence(0.0f), missed(0), classified(false), resultConfidence(0.0f) {}
+    };
+
+    AppleTracker();
+
+    /**
+     * @brief Полная детекция не реже чем раз в interval кадров
+     */
+    void setDetectionInterval(int interval);
+    int detectionInterval() const { return m_detectionInterval; }
+
+    /**
+     * @brief Переход к следующему кадру: сдвигает треки по скорости
+     */
+    void advanceFrame();
+
+    /**
+     * @brief Нужна ли на текущем кадре полная детекция
+     */
+    bool needsDetection() const;
+
+    /**
+     * @brief Обновляет треки детекциями текущего кадра
+     * @return Для каждой детекции - id сопоставленного или нового трека
+     */
+    QVector<int> update(const QVector<QRectF> &detections);
+
+    /**
+     * @brief Сохраняет результат классификации трека
+     */
+    void setClassification(int trackId, const QString &result, float confidence);
+
+    const QVector<Track> &tracks() const { return m_tracks; }
+    const Track *track(int trackId) const;
+
+    void reset();
+
+    static double iou(const QRectF &a, const QRectF &b);
+
+private:
+    static const int MAX_MISSED = 2;           // Удаляем трек после 2 детекций без сопоставления
+
+    int m_detectionInterval;
+    float m_confidenceDecay;                    // Затухание уверенности за предсказанный кадр
+    int m_framesSinceDetection;
+    int m_nextId;
+    QVector<Track> m_tracks;
+};
+
+#endif // APPLETRACKER_H
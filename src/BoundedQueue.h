@@ -0,0 +1,146 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+/**
+ * @brief Блокирующая очередь ограниченной ёмкости между стадиями конвейера
+ *
+ * push() ждёт свободного места, pop() - элемента. После close() новые
+ * элементы не принимаются, а pop() отдаёт оставшиеся и затем возвращает
+ * false, так что стадии завершаются по цепочке, не теряя кадров.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity)
+        : m_capacity(capacity), m_closed(false) {}
+
+    /**
+     * @return false если очередь закрыта (элемент не добавлен)
+     */
+    bool push(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_items.size() >= m_capacity) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_closed) {
+            return false;
+        }
+
+        m_items.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Добавляет элемент без ожидания
+     * @return false если очередь полна или закрыта
+     */
+    bool tryPush(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_closed || m_items.size() >= m_capacity) {
+            return false;
+        }
+
+        m_items.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    /**
+     * @brief push() с ограниченным ожиданием места
+     * @return false если очередь закрыта или место не освободилось за timeoutMs
+     */
+    bool push(const T &item, unsigned long timeoutMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_closed && m_items.size() >= m_capacity) {
+            m_notFull.wait(&m_mutex, timeoutMs);
+        }
+        if (m_closed || m_items.size() >= m_capacity) {
+            return false;
+        }
+
+        m_items.enqueue(item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    /**
+     * @return false если очередь закрыта и пуста
+     */
+    bool pop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && m_items.isEmpty()) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_items.isEmpty()) {
+            return false;
+        }
+
+        item = m_items.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    /**
+     * @brief Забирает элемент без ожидания
+     * @return false если очередь пуста
+     */
+    bool tryPop(T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_items.isEmpty()) {
+            return false;
+        }
+
+        item = m_items.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+    /**
+     * @brief Открывает очередь для нового сеанса (оставшиеся элементы отбрасываются)
+     */
+    void reopen()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_items.clear();
+        m_closed = false;
+    }
+
+    bool isClosed() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_closed;
+    }
+
+    int capacity() const { return m_capacity; }
+
+private:
+    Q_DISABLE_COPY(BoundedQueue)
+
+    const int m_capacity;
+    bool m_closed;
+    QQueue<T> m_items;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,153 @@
+#include "CameraFrame.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+// Копирует rows строк по rowBytes байт; строка, выходящая за конец
+// отображённого буфера, не читается
+bool copyPlane(uchar *dst, int dstStride, const uchar *src, int srcStride,
+               int rowBytes, int rows, const uchar *end)
+{
+    if (!src || rowBytes > srcStride) {
+        return false;
+    }
+
+    for (int row = 0; row < rows; ++row) {
+        const uchar *line = src + static_cast<qint64>(row) * srcStride;
+        if (line + rowBytes > end) {
+            return false;
+        }
+        std::memcpy(dst + row * dstStride, line, rowBytes);
+    }
+    return true;
+}
+}
+
+qint64 CameraFrame::clockUs()
+{
+    static const QElapsedTimer clock = startedClock();
+    return clock.nsecsElapsed() / 1000;
+}
+
+QImage CameraFrame::toImage(int maxSide) const
+{
+    if (isYuv()) {
+        return yuv.toImage(maxSide);
+    }
+
+    if (maxSide > 0 && std::max(image.width(), image.height()) > maxSide) {
+        return image.scaled(maxSide, maxSide, Qt::KeepAspectRatio, Qt::FastTransformation);
+    }
+    return image;
+}
+
+CameraFrame CameraFrame::fromVideoFrame(const QVideoFrame &input)
+{
+    CameraFrame result;
+    result.timestampUs = clockUs();
+
+    QVideoFrame frame(input);
+    if (!frame.map(QAbstractVideoBuffer::ReadOnly)) {
+        return result;
+    }
+
+    const int width = frame.width();
+    const int height = frame.height();
+    const int stride = frame.bytesPerLine(0);
+    const uchar *begin = frame.bits(0);
+    const uchar *end = frame.bits() + frame.mappedBytes();
+
+    QImage::Format rgbFormat = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+    if (rgbFormat != QImage::Format_Invalid) {
+        // RGB кадр: одна копия из буфера камеры
+        if (static_cast<qint64>(stride) * height <= frame.mappedBytes()) {
+            result.image = QImage(begin, width, height, stride, rgbFormat).copy();
+        } else {
+            qWarning() << "[CameraFrame::fromVideoFrame] Mapped buffer is smaller than the frame";
+        }
+        frame.unmap();
+        return result;
+    }
+
+    // Плоскости копируются построчно в плотную раскладку: Y, затем chroma.
+    // Буферы с одной плоскостью хранят chroma подряд за плоскостью Y
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaRows = (height + 1) / 2;
+    const bool multiPlane = frame.planeCount() > 1;
+
+    YuvFrame &yuv = result.yuv;
+    yuv.width = width;
+    yuv.height = height;
+    yuv.yStride = width;
+    const int ySize = width * height;
+
+    bool copied = false;
+    switch (frame.pixelFormat()) {
+    case QVideoFrame::Format_NV12:
+    case QVideoFrame::Format_NV21: {
+        // Чередующиеся UV (NV12) или VU (NV21)
+        const bool uFirst = frame.pixelFormat() == QVideoFrame::Format_NV12;
+        const uchar *chroma = multiPlane ? frame.bits(1) : begin + static_cast<qint64>(stride) * height;
+        const int chromaStride = multiPlane ? frame.bytesPerLine(1) : stride;
+
+        yuv.chromaStride = 2 * chromaWidth;
+        yuv.chromaStep = 2;
+        yuv.uOffset = ySize + (uFirst ? 0 : 1);
+        yuv.vOffset = ySize + (uFirst ? 1 : 0);
+        yuv.data.resize(ySize + yuv.chromaStride * chromaRows);
+
+        uchar *out = reinterpret_cast<uchar *>(yuv.data.data());
+        copied = copyPlane(out, width, begin, stride, width, height, end)
+                && copyPlane(out + ySize, yuv.chromaStride, chroma, chromaStride,
+                             yuv.chromaStride, chromaRows, end);
+        break;
+    }
+    case QVideoFrame::Format_YUV420P:
+    case QVideoFrame::Format_YV12: {
+        // Раздельные плоскости U и V (в YV12 сначала V)
+        const bool uFirst = frame.pixelFormat() == QVideoFrame::Format_YUV420P;
+        const int chromaStride = multiPlane ? frame.bytesPerLine(1) : stride / 2;
+        const uchar *first = multiPlane ? frame.bits(1) : begin + static_cast<qint64>(stride) * height;
+        const uchar *second = multiPlane && frame.planeCount() > 2
+                ? frame.bits(2) : first + static_cast<qint64>(chromaStride) * chromaRows;
+        const int secondStride = multiPlane && frame.planeCount() > 2 ? frame.bytesPerLine(2) : chromaStride;
+
+        const int chromaSize = chromaWidth * chromaRows;
+        yuv.chromaStride = chromaWidth;
+        yuv.chromaStep = 1;
+        yuv.uOffset = ySize + (uFirst ? 0 : chromaSize);
+        yuv.vOffset = ySize + (uFirst ? chromaSize : 0);
+        yuv.data.resize(ySize + 2 * chromaSize);
+
+        uchar *out = reinterpret_cast<uchar *>(yuv.data.data());
+        copied = copyPlane(out, width, begin, stride, width, height, end)
+                && copyPlane(out + ySize, chromaWidth, first, chromaStride, chromaWidth, chromaRows, end)
+                && copyPlane(out + ySize + chromaSize, chromaWidth, second, secondStride,
+                             chromaWidth, chromaRows, end);
+        break;
+    }
+    default:
+        qWarning() << "[CameraFrame::fromVideoFrame] Unsupported pixel format:" << frame.pixelFormat();
+        break;
+    }
+
+    if (!copied) {
+        if (!yuv.data.isEmpty()) {
+            qWarning() << "[CameraFrame::fromVideoFrame] Plane layout exceeds mapped buffer:"
+                       << frame.pixelFormat() << frame.mappedBytes() << "bytes";
+        }
+        result.yuv = YuvFrame();
+    }
+
+    frame.unmap();
+    return result;
+}
@@ -0,0 +1,39 @@
+#ifndef CAMERAFRAME_H
+#define CAMERAFRAME_H
+
+#include <QImage>
+#include <QVideoFrame>
+#include "YuvFrame.h"
+
+/**
+ * @brief Кадр видоискателя: RGB или YUV без конвертации
+ */
+struct CameraFrame
+{
+    QImage image;           // Заполнен, если камера отдаёт RGB
+    YuvFrame yuv;           // Заполнен для YUV форматов
+    qint64 timestampUs;     // Время приёма кадра по clockUs(), -1 - неизвестно
+
+    CameraFrame() : timestampUs(-1) {}
+
+    bool isNull() const { return image.isNull() && yuv.isNull(); }
+    bool isYuv() const { return !yuv.isNull(); }
+    QSize size() const { return isYuv() ? QSize(yuv.width, yuv.height) : image.size(); }
+
+    /**
+     * @brief RGB представление кадра (для детектора и режима нескольких яблок)
+     */
+    QImage toImage(int maxSide = 0) const;
+
+    /**
+     * @brief Копирует отображаемый буфер кадра камеры
+     */
+    static CameraFrame fromVideoFrame(const QVideoFrame &frame);
+
+    /**
+     * @brief Монотонные часы для меток кадров и измерения задержки, мкс
+     */
+    static qint64 clockUs();
+};
+
+#endif // CAMERAFRAME_H
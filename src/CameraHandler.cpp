@@ -1,17 +1,33 @@
 #include "CameraHandler.h"
+#include "FrameRecorder.h"
 #include <QCameraInfo>
+#include <QCameraViewfinderSettings>
+#include <QImageEncoderSettings>
 #include <QStandardPaths>
 #include <QDir>
 #include <QDateTime>
 #include <QDebug>
+#include <QFile>
+#include <QtConcurrent>
+#include <climits>
 
 CameraHandler::CameraHandler(QObject *parent)
     : QObject(parent)
     , m_camera(nullptr)
     , m_imageCapture(nullptr)
+    , m_videoProbe(nullptr)
+    , m_frameStreaming(0)
+    , m_recorder(nullptr)
+    , m_frameRecorder(new FrameRecorder())
     , m_isActive(false)
     , m_hasCamera(false)
+    , m_captureToBuffer(false)
+    , m_requiredFrameSize(640, 374)
+    , m_archivalCapture(true)
+    , m_startPending(false)
 {
+    m_ioThreads.setMaxThreadCount(1);
+
     // Проверяем доступность камеры
     QList<QCameraInfo> cameras = QCameraInfo::availableCameras();
     m_hasCamera = !cameras.isEmpty();
@@ -29,8 +45,18 @@ CameraHandler::CameraHandler(QObject *parent)
         m_camera = new QCamera(cameraInfo, this);
         m_imageCapture = new QCameraImageCapture(m_camera, this);
 
-        // Настройка захвата
-        m_imageCapture->setCaptureDestination(QCameraImageCapture::CaptureToFile);
+        // Снимок получаем в память: анализ не ждёт записи и повторного чтения файла
+        m_captureToBuffer = m_imageCapture->isCaptureDestinationSupported(QCameraImageCapture::CaptureToBuffer);
+        if (m_captureToBuffer) {
+            m_imageCapture->setCaptureDestination(QCameraImageCapture::CaptureToBuffer);
+
+            // JPEG от камеры сохраняется без перекодирования
+            if (m_imageCapture->supportedBufferFormats().contains(QVideoFrame::Format_Jpeg)) {
+                m_imageCapture->setBufferFormat(QVideoFrame::Format_Jpeg);
+            }
+        } else {
+            m_imageCapture->setCaptureDestination(QCameraImageCapture::CaptureToFile);
+        }
 
         // Директория для сохранения снимков
         m_captureDir = QStandardPaths::writableLocation(QStandardPaths::PicturesLocation)
@@ -40,9 +66,22 @@ CameraHandler::CameraHandler(QObject *parent)
         // Подключаем сигналы
         connect(m_imageCapture, &QCameraImageCapture::imageCaptured,
                 this, &CameraHandler::onImageCaptured);
+        connect(m_imageCapture, &QCameraImageCapture::imageAvailable,
+                this, &CameraHandler::onImageAvailable);
         // Используем старый синтаксис для совместимости с Qt 5.6
         connect(m_camera, SIGNAL(error(QCamera::Error)),
                 this, SLOT(onCameraError(QCamera::Error)));
+        connect(m_camera, SIGNAL(statusChanged(QCamera::Status)),
+                this, SLOT(onCameraStatusChanged(QCamera::Status)));
+
+        // Кадры видоискателя: обрабатываем в потоке камеры, пока буфер действителен
+        m_videoProbe = new QVideoProbe(this);
+        if (m_videoProbe->setSource(m_camera)) {
+            connect(m_videoProbe, &QVideoProbe::videoFrameProbed,
+                    this, &CameraHandler::onVideoFrameProbed, Qt::DirectConnection);
+        } else {
+            qWarning() << "Video probe is not supported by the camera backend";
+        }
 
         qDebug() << "Camera initialized:" << cameraInfo.description();
     } else {
@@ -55,6 +94,12 @@ CameraHandler::~CameraHandler()
     if (m_camera) {
         m_camera->stop();
     }
+
+    // Дожидаемся записи отложенных снимков
+    m_ioThreads.waitForDone();
+
+    stopRecording();
+    delete m_frameRecorder;
 }
 
 void CameraHandler::startCamera()
@@ -69,7 +114,13 @@ void CameraHandler::startCamera()
         return;
     }
 
-    m_camera->start();
+    // Разрешения настраиваем в загруженном состоянии, запуск - после этого
+    if (m_camera->status() == QCamera::UnloadedStatus) {
+        m_startPending = true;
+        m_camera->load();
+    } else {
+        m_camera->start();
+    }
     m_isActive = true;
     emit isActiveChanged();
 
@@ -78,7 +129,8 @@ void CameraHandler::startCamera()
 
 void CameraHandler::stopCamera()
 {
-    if (m_camera && m_camera->state() == QCamera::ActiveState) {
+    if (m_camera && (m_camera->state() == QCamera::ActiveState || m_startPending)) {
+        m_startPending = false;
         m_camera->stop();
         m_isActive = false;
         emit isActiveChanged();
@@ -103,7 +155,8 @@ void CameraHandler::captureImage()
     QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
     QString fileName = QString("%1/apple_%2.jpg").arg(m_captureDir).arg(timestamp);
 
-    m_imageCapture->capture(fileName);
+    int id = m_imageCapture->capture(fileName);
+    m_capturePaths.insert(id, fileName);
 
     qDebug() << "Capturing image to:" << fileName;
 }
@@ -116,23 +169,269 @@ void CameraHandler::setViewfinder(QObject *viewfinder)
     qDebug() << "Viewfinder is handled in QML, this method is deprecated";
 }
 
-void CameraHandler::onImageCaptured(int id, const QImage &image)
+void CameraHandler::onImageCaptured(int id, const QImage &preview)
 {
-    Q_UNUSED(id);
+    // В режиме буфера снимок придёт в onImageAvailable
+    if (m_captureToBuffer) {
+        return;
+    }
 
-    // Сохраняем изображение
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-    QString fileName = QString("%1/apple_%2.jpg").arg(m_captureDir).arg(timestamp);
+    // Файл записывает сама камера, в анализ отдаём изображение из памяти
+    StillImage still;
+    still.image = preview;
+    still.filePath = m_capturePaths.take(id);
+    publishStill(still);
+}
+
+void CameraHandler::onImageAvailable(int id, const QVideoFrame &buffer)
+{
+    StillImage still;
+    still.filePath = m_capturePaths.take(id);
+    if (still.filePath.isEmpty()) {
+        qWarning() << "[CameraHandler::onImageAvailable] Unknown capture id:" << id;
+        return;
+    }
+
+    if (buffer.pixelFormat() == QVideoFrame::Format_Jpeg) {
+        QVideoFrame frame(buffer);
+        if (frame.map(QAbstractVideoBuffer::ReadOnly)) {
+            still.encoded = QByteArray(reinterpret_cast<const char *>(frame.bits()), frame.mappedBytes());
+            frame.unmap();
+        }
+    } else {
+        still.image = CameraFrame::fromVideoFrame(buffer).toImage();
+    }
+
+    if (still.isNull()) {
+        emit errorOccurred("Failed to read captured image");
+        return;
+    }
+
+    saveInBackground(still);
+    publishStill(still);
+}
+
+void CameraHandler::publishStill(const StillImage &still)
+{
+    emit imageCaptured(still.filePath);
+    emit stillImageCaptured(still);
+}
+
+void CameraHandler::saveInBackground(const StillImage &still)
+{
+    QtConcurrent::run(&m_ioThreads, [this, still]() {
+        bool saved = false;
+
+        if (!still.encoded.isEmpty()) {
+            // JPEG камеры пишется как есть
+            QFile file(still.filePath);
+            saved = file.open(QIODevice::WriteOnly) && file.write(still.encoded) == still.encoded.size();
+        } else {
+            saved = still.image.save(still.filePath, "JPEG", 95);
+        }
+
+        if (saved) {
+            qDebug() << "[CameraHandler::saveInBackground] ✓ Image saved:" << still.filePath;
+        } else {
+            qWarning() << "[CameraHandler::saveInBackground] Failed to save image:" << still.filePath;
+            QMetaObject::invokeMethod(this, "errorOccurred", Qt::QueuedConnection,
+                                      Q_ARG(QString, QString("Failed to save image")));
+        }
+    });
+}
+
+void CameraHandler::setFrameStreaming(bool enabled)
+{
+    m_frameStreaming.store(enabled ? 1 : 0);
+    if (!enabled) {
+        m_frameMailbox.clear();
+    }
+    qDebug() << "Frame streaming set to:" << enabled;
+}
+
+bool CameraHandler::startRecording(const QString &filePath)
+{
+    if (recording()) {
+        return true;
+    }
+
+    QString path = filePath;
+    if (path.isEmpty()) {
+        QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+        path = QString("%1/frames_%2.arcf").arg(m_captureDir).arg(timestamp);
+    }
+
+    if (!m_frameRecorder->start(path)) {
+        emit errorOccurred("Failed to start recording: " + path);
+        return false;
+    }
+
+    m_recorder.storeRelease(m_frameRecorder);
+    emit recordingChanged();
+    return true;
+}
+
+void CameraHandler::stopRecording()
+{
+    if (!recording()) {
+        return;
+    }
+
+    // Поток камеры перестаёт ставить кадры, очередь дописывается
+    m_recorder.storeRelease(nullptr);
+    m_frameRecorder->stop();
+    emit recordingChanged();
+}
+
+void CameraHandler::onVideoFrameProbed(const QVideoFrame &frame)
+{
+    // Вызывается в потоке камеры: не блокируемся, новейший кадр вытесняет непрочитанный
+    FrameRecorder *recorder = m_recorder.loadAcquire();
+    bool streaming = m_frameStreaming.load() != 0;
+    if (!streaming && !recorder) {
+        return;
+    }
 
-    if (image.save(fileName, "JPEG", 95)) {
-        qDebug() << "Image saved:" << fileName;
-        emit imageCaptured(fileName);
+    // YUV кадры копируются без конвертации в RGB
+    CameraFrame cameraFrame = CameraFrame::fromVideoFrame(frame);
+    if (cameraFrame.isNull()) {
+        return;
+    }
+
+    if (recorder) {
+        recorder->record(cameraFrame);
+    }
+
+    if (streaming) {
+        m_frameMailbox.post(cameraFrame);
+        emit frameReady();
+    }
+}
+
+void CameraHandler::onCameraStatusChanged(QCamera::Status status)
+{
+    if (status != QCamera::LoadedStatus || !m_startPending) {
+        return;
+    }
+
+    m_startPending = false;
+    applyViewfinderResolution();
+    applyCaptureResolution();
+    m_camera->start();
+}
+
+void CameraHandler::setRequiredFrameSize(const QSize &size)
+{
+    if (m_requiredFrameSize == size) {
+        return;
+    }
+
+    m_requiredFrameSize = size;
+    qDebug() << "Required frame size set to:" << size;
+
+    if (!m_camera || m_camera->status() == QCamera::UnloadedStatus) {
+        return; // Разрешения подберутся при загрузке камеры
+    }
+
+    // Кадры реального времени идут из видоискателя: подбираем его заново
+    if (m_camera->state() == QCamera::ActiveState) {
+        QSize resolution = pickResolution(m_camera->supportedViewfinderResolutions(), m_requiredFrameSize);
+        if (!resolution.isEmpty() && resolution != m_viewfinderResolution) {
+            // Бэкенды применяют настройки видоискателя только при запуске
+            m_camera->stop();
+            applyViewfinderResolution();
+            m_camera->start();
+        }
+    } else {
+        applyViewfinderResolution();
+    }
+
+    applyCaptureResolution();
+}
+
+void CameraHandler::setArchivalCapture(bool enabled)
+{
+    if (m_archivalCapture == enabled) {
+        return;
+    }
+
+    m_archivalCapture = enabled;
+    emit archivalCaptureChanged();
+
+    if (m_camera && m_camera->status() != QCamera::UnloadedStatus) {
+        applyCaptureResolution();
+    }
+}
+
+void CameraHandler::applyViewfinderResolution()
+{
+    QSize resolution = pickResolution(m_camera->supportedViewfinderResolutions(), m_requiredFrameSize);
+    if (resolution.isEmpty()) {
+        return; // Бэкенд не сообщает разрешения, оставляем по умолчанию
+    }
+
+    QCameraViewfinderSettings settings = m_camera->viewfinderSettings();
+    settings.setResolution(resolution);
+    m_camera->setViewfinderSettings(settings);
+
+    m_viewfinderResolution = resolution;
+    emit resolutionChanged();
+    qDebug() << "[CameraHandler::applyViewfinderResolution] ✓ Viewfinder:" << resolution;
+}
+
+void CameraHandler::applyCaptureResolution()
+{
+    if (!m_imageCapture) {
+        return;
+    }
 
-        // Для real-time анализа
-        emit frameAvailable(image);
+    QList<QSize> supported = m_imageCapture->supportedResolutions();
+    QSize resolution;
+    if (m_archivalCapture) {
+        // Архив: максимальное разрешение сенсора
+        resolution = pickResolution(supported, QSize(INT_MAX, INT_MAX));
     } else {
-        emit errorOccurred("Failed to save image");
+        resolution = pickResolution(supported, m_requiredFrameSize);
     }
+
+    if (resolution.isEmpty()) {
+        return;
+    }
+
+    QImageEncoderSettings settings = m_imageCapture->encodingSettings();
+    settings.setResolution(resolution);
+    m_imageCapture->setEncodingSettings(settings);
+
+    m_captureResolution = resolution;
+    emit resolutionChanged();
+    qDebug() << "[CameraHandler::applyCaptureResolution] ✓ Capture:" << resolution
+             << (m_archivalCapture ? "(archival)" : "");
+}
+
+QSize CameraHandler::pickResolution(const QList<QSize> &supported, const QSize &required)
+{
+    // Сравниваем большие и меньшие стороны: ориентация сенсора не важна
+    const int requiredLong = qMax(required.width(), required.height());
+    const int requiredShort = qMin(required.width(), required.height());
+
+    QSize best;
+    QSize largest;
+    for (const QSize &size : supported) {
+        const qint64 area = qint64(size.width()) * size.height();
+
+        if (largest.isEmpty() || area > qint64(largest.width()) * largest.height()) {
+            largest = size;
+        }
+
+        const bool fits = qMax(size.width(), size.height()) >= requiredLong
+                && qMin(size.width(), size.height()) >= requiredShort;
+        if (fits && (best.isEmpty() || area < qint64(best.width()) * best.height())) {
+            best = size;
+        }
+    }
+
+    // Если ни одно разрешение не покрывает требование, берём наибольшее
+    return best.isEmpty() ? largest : best;
 }
 
 void CameraHandler::onCameraError(QCamera::Error error)
@@ -6,6 +6,15 @@
 #include <QCameraImageCapture>
 #include <QImage>
 #include <QVideoFrame>
+#include <QVideoProbe>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QHash>
+#include "FrameMailbox.h"
+#include "CameraFrame.h"
+#include "StillImage.h"
+
+class FrameRecorder;
 
 /**
  * @brief Класс для работы с камерой устройства
@@ -15,6 +24,10 @@ class CameraHandler : public QObject
     Q_OBJECT
     Q_PROPERTY(bool isActive READ isActive NOTIFY isActiveChanged)
     Q_PROPERTY(bool hasCamera READ hasCamera NOTIFY hasCameraChanged)
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    Q_PROPERTY(bool archivalCapture READ archivalCapture WRITE setArchivalCapture NOTIFY archivalCaptureChanged)
+    Q_PROPERTY(QSize viewfinderResolution READ viewfinderResolution NOTIFY resolutionChanged)
+    Q_PROPERTY(QSize captureResolution READ captureResolution NOTIFY resolutionChanged)
 
 public:
     explicit CameraHandler(QObject *parent = nullptr);
@@ -23,6 +36,44 @@ public:
     bool isActive() const { return m_isActive; }
     bool hasCamera() const { return m_hasCamera; }
 
+    /**
+     * @brief Включает передачу кадров видоискателя в frameMailbox()
+     *
+     * Кадры берутся из буферов камеры напрямую (QVideoProbe), без записи на диск
+     */
+    void setFrameStreaming(bool enabled);
+    bool frameStreaming() const { return m_frameStreaming.load() != 0; }
+
+    /**
+     * @brief Ящик с новейшим кадром видоискателя
+     */
+    FrameMailbox<CameraFrame> &frameMailbox() { return m_frameMailbox; }
+
+    bool recording() const { return m_recorder.loadAcquire() != nullptr; }
+
+    /**
+     * @brief Минимальный размер кадра, нужный анализу (большая x меньшая сторона)
+     *
+     * Видоискатель (и снимок при выключенном archivalCapture) получает
+     * наименьшее поддерживаемое разрешение не меньше этого размера.
+     * Оба перенастраиваются сразу; работающая камера перезапускается,
+     * если меняется разрешение видоискателя.
+     */
+    void setRequiredFrameSize(const QSize &size);
+    QSize requiredFrameSize() const { return m_requiredFrameSize; }
+
+    /**
+     * @brief Снимки в максимальном разрешении (для архива), а не под размер анализа
+     *
+     * Включено по умолчанию: снимок сохраняется и анализируется повторно,
+     * поэтому уменьшать его под real-time анализ нельзя
+     */
+    void setArchivalCapture(bool enabled);
+    bool archivalCapture() const { return m_archivalCapture; }
+
+    QSize viewfinderResolution() const { return m_viewfinderResolution; }
+    QSize captureResolution() const { return m_captureResolution; }
+
 public slots:
     /**
      * @brief Запускает камеру
@@ -39,6 +90,15 @@ public slots:
      */
     void captureImage();
 
+    /**
+     * @brief Начинает запись кадров видоискателя для воспроизведения (FrameReplaySource)
+     * @param filePath Пустой путь - файл с меткой времени в директории снимков
+     *
+     * Запись не зависит от real-time анализа
+     */
+    bool startRecording(const QString &filePath = QString());
+    void stopRecording();
+
     /**
      * @brief Устанавливает viewfinder для предпросмотра
      */
@@ -47,30 +107,72 @@ public slots:
 signals:
     /**
      * @brief Сигнал захвата изображения
+     *
+     * Файл filePath записывается в фоновом потоке и может ещё не существовать
      */
     void imageCaptured(const QString &filePath);
 
     /**
-     * @brief Сигнал обновления кадра (для real-time анализа)
+     * @brief Снимок в памяти для анализа (испускается после imageCaptured)
      */
-    void frameAvailable(const QImage &frame);
+    void stillImageCaptured(const StillImage &still);
+
+    /**
+     * @brief Сигнал нового кадра в frameMailbox() (для real-time анализа)
+     *
+     * Испускается в потоке камеры: подключать через Qt::DirectConnection
+     * к потокобезопасному неблокирующему слоту
+     */
+    void frameReady();
 
     void isActiveChanged();
     void hasCameraChanged();
+    void archivalCaptureChanged();
+    void recordingChanged();
+    void resolutionChanged();
     void errorOccurred(const QString &error);
 
 private slots:
-    void onImageCaptured(int id, const QImage &image);
+    void onImageCaptured(int id, const QImage &preview);
+    void onImageAvailable(int id, const QVideoFrame &buffer);
     void onCameraError(QCamera::Error error);
+    void onCameraStatusChanged(QCamera::Status status);
+    void onVideoFrameProbed(const QVideoFrame &frame);
 
 private:
     QCamera *m_camera;
     QCameraImageCapture *m_imageCapture;
+    QVideoProbe *m_videoProbe;
+
+    // Доступны из потока камеры
+    QAtomicInt m_frameStreaming;
+    QAtomicPointer<FrameRecorder> m_recorder;     // Активный рекордер (читает поток камеры)
+    FrameRecorder *m_frameRecorder;
+    FrameMailbox<CameraFrame> m_frameMailbox;
 
     bool m_isActive;
     bool m_hasCamera;
 
     QString m_captureDir;
+
+    // Снимки пишутся на диск в одном фоновом потоке, не задерживая анализ
+    bool m_captureToBuffer;
+    QHash<int, QString> m_capturePaths;
+    QThreadPool m_ioThreads;
+
+    // Разрешения подбираются, когда камера загружена и знает поддерживаемые режимы
+    QSize m_requiredFrameSize;
+    QSize m_viewfinderResolution;
+    QSize m_captureResolution;
+    bool m_archivalCapture;
+    bool m_startPending;
+
+    void applyViewfinderResolution();
+    void applyCaptureResolution();
+    static QSize pickResolution(const QList<QSize> &supported, const QSize &required);
+
+    void publishStill(const StillImage &still);
+    void saveInBackground(const StillImage &still);
 };
 
 #endif // CAMERAHANDLER_H
@@ -0,0 +1,25 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QAtomicInt>
+#include <memory>
+
+/**
+ * @brief Флаг отмены запроса, общий для вызывающего и рабочего потока
+ *
+ * Копии токена разделяют одно состояние. Рабочий код проверяет
+ * isCancelled() в контрольных точках и завершается досрочно.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken() : m_state(std::make_shared<QAtomicInt>(0)) {}
+
+    void cancel() const { m_state->storeRelease(1); }
+    bool isCancelled() const { return m_state->loadAcquire() != 0; }
+
+private:
+    std::shared_ptr<QAtomicInt> m_state;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,137 @@
+#ifndef CONTEXTPOOL_H
+#define CONTEXTPOOL_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QtAlgorithms>
+#include <functional>
+
+/**
+ * @brief Пул лёгких контекстов обработки для параллельной работы
+ *
+ * Контексты создаются фабрикой по требованию (обычно createContext()
+ * прототипа, разделяющий с ним веса моделей) и переиспользуются между
+ * запросами. Одновременно контекстом владеет только один поток (Lease).
+ * Изменения прототипа выполняются через configure(): они сериализуются
+ * с созданием контекстов, а устаревшие контексты удаляются при возврате.
+ */
+template <typename T>
+class ContextPool
+{
+public:
+    typedef std::function<T *()> Factory;
+
+    explicit ContextPool(const Factory &factory)
+        : m_factory(factory), m_generation(0) {}
+
+    ~ContextPool()
+    {
+        qDeleteAll(m_idle);
+    }
+
+    /**
+     * @brief Временное владение контекстом (RAII)
+     */
+    class Lease
+    {
+    public:
+        explicit Lease(ContextPool &pool)
+            : m_pool(pool), m_generation(0), m_context(nullptr)
+        {
+            m_context = m_pool.acquire(m_generation);
+        }
+
+        ~Lease()
+        {
+            m_pool.release(m_context, m_generation);
+        }
+
+        /**
+         * @brief Поколение прототипа, по которому создан контекст
+         */
+        int generation() const { return m_generation; }
+
+        T *get() const { return m_context; }
+        T *operator->() const { return m_context; }
+        T &operator*() const { return *m_context; }
+        bool isValid() const { return m_context != nullptr; }
+
+    private:
+        Q_DISABLE_COPY(Lease)
+
+        ContextPool &m_pool;
+        int m_generation;
+        T *m_context;
+    };
+
+    /**
+     * @brief Изменяет прототип и сбрасывает созданные по нему контексты
+     */
+    void configure(const std::function<void()> &change)
+    {
+        QMutexLocker locker(&m_mutex);
+        change();
+        ++m_generation;
+        qDeleteAll(m_idle);
+        m_idle.clear();
+    }
+
+    /**
+     * @brief Поколение прототипа: растёт при каждом configure()
+     *
+     * Результаты, посчитанные контекстом старого поколения (детекции,
+     * признаки), после смены прототипа устарели
+     */
+    int generation() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_generation;
+    }
+
+    /**
+     * @brief Число свободных контекстов
+     */
+    int idleCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_idle.size();
+    }
+
+private:
+    Q_DISABLE_COPY(ContextPool)
+
+    T *acquire(int &generation)
+    {
+        QMutexLocker locker(&m_mutex);
+        generation = m_generation;
+        if (!m_idle.isEmpty()) {
+            return m_idle.takeLast();
+        }
+        return m_factory();
+    }
+
+    void release(T *context, int generation)
+    {
+        if (!context) {
+            return;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        if (generation == m_generation) {
+            m_idle.append(context);
+            return;
+        }
+
+        // Прототип изменился, пока контекст был в работе
+        locker.unlock();
+        delete context;
+    }
+
+    Factory m_factory;
+    mutable QMutex m_mutex;
+    QVector<T *> m_idle;
+    int m_generation;
+};
+
+#endif // CONTEXTPOOL_H
@@ -0,0 +1,285 @@
+#include "DirectoryAnalyzer.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent>
+
+namespace {
+QByteArray csvField(const QString &value)
+{
+    QString escaped = value;
+    if (escaped.contains(',') || escaped.contains('"') || escaped.contains('\n')) {
+        escaped.replace("\"", "\"\"");
+        escaped = "\"" + escaped + "\"";
+    }
+    return escaped.toUtf8();
+}
+}
+
+QString DirectoryAnalyzer::Report::toString() const
+{
+    return QString("Images: %1 (failed %2, skipped %3)%4\n"
+                   "Elapsed: %5 s, %6 images/s\n"
+                   "Results: %7")
+            .arg(processed).arg(failed).arg(skipped).arg(cancelled ? ", cancelled" : "")
+            .arg(elapsedSec, 0, 'f', 2).arg(imagesPerSecond, 0, 'f', 1)
+            .arg(outputPath);
+}
+
+DirectoryAnalyzer::DirectoryAnalyzer(JobScheduler &scheduler, const Analyzer &analyzer, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+    , m_analyzer(analyzer)
+    , m_format(JSON_LINES)
+    , m_paths(PATH_QUEUE_CAPACITY)
+    , m_decoded(DECODED_QUEUE_CAPACITY)
+    , m_results(RESULT_QUEUE_CAPACITY)
+    , m_running(0)
+    , m_activeDecoders(0)
+    , m_pendingAnalyses(0)
+{
+    // Обход, декодеры и запись
+    m_ioThreads.setMaxThreadCount(2 + DECODER_THREADS);
+}
+
+DirectoryAnalyzer::~DirectoryAnalyzer()
+{
+    m_token.cancel();
+    waitForDone();
+}
+
+DirectoryAnalyzer::Format DirectoryAnalyzer::formatForPath(const QString &outputPath)
+{
+    return QFileInfo(outputPath).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? CSV : JSON_LINES;
+}
+
+bool DirectoryAnalyzer::start(const QString &dirPath, const QString &outputPath, Format format,
+                              const CancellationToken &token)
+{
+    if (m_running.load()) {
+        m_error = "Directory analysis already running";
+        return false;
+    }
+
+    if (!QDir(dirPath).exists()) {
+        m_error = "Directory not found: " + dirPath;
+        return false;
+    }
+
+    m_output.setFileName(outputPath);
+    if (!m_output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = "Cannot open results file: " + outputPath;
+        return false;
+    }
+
+    if (format == CSV) {
+        m_output.write("file,result,confidence,apples,ms,error\n");
+    }
+
+    m_token = token;
+    m_format = format;
+    m_report = Report();
+    m_report.outputPath = outputPath;
+    m_paths.reopen();
+    m_decoded.reopen();
+    m_results.reopen();
+
+    m_running.storeRelease(1);
+    m_clock.start();
+
+    QtConcurrent::run(&m_ioThreads, [this, dirPath]() { listFiles(dirPath); });
+
+    // Очередь записи закрывается, когда завершены декодирование и все задачи анализа
+    m_pendingAnalyses.store(1);
+    m_activeDecoders.store(DECODER_THREADS);
+    for (int i = 0; i < DECODER_THREADS; ++i) {
+        QtConcurrent::run(&m_ioThreads, [this]() { decodeFiles(); });
+    }
+    QtConcurrent::run(&m_ioThreads, [this]() { writeResults(); });
+
+    qDebug() << "[DirectoryAnalyzer::start] ✓ Analyzing" << dirPath << "with up to"
+             << m_scheduler.limit(JobScheduler::BATCH) << "workers, results:" << outputPath;
+    return true;
+}
+
+void DirectoryAnalyzer::waitForDone()
+{
+    {
+        QMutexLocker locker(&m_workersMutex);
+        while (m_pendingAnalyses.load() > 0) {
+            m_workersDone.wait(&m_workersMutex);
+        }
+    }
+    m_ioThreads.waitForDone();
+}
+
+void DirectoryAnalyzer::listFiles(const QString &dirPath)
+{
+    // Обход ленивый: список файлов папки целиком в памяти не хранится
+    QDirIterator it(dirPath, QStringList() << "*.jpg" << "*.jpeg" << "*.png",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext() && !m_token.isCancelled()) {
+        if (!m_paths.push(it.next())) {
+            break;
+        }
+    }
+    m_paths.close();
+}
+
+void DirectoryAnalyzer::decodeFiles()
+{
+    QString filePath;
+    while (m_paths.pop(filePath)) {
+        if (m_token.isCancelled()) {
+            continue; // Дочитываем очередь, чтобы обход завершился
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        DecodedImage decoded;
+        decoded.filePath = filePath;
+        QImageReader reader(filePath);
+        reader.setAutoTransform(true);
+        decoded.image = reader.read();
+        decoded.decodeMs = timer.elapsed();
+
+        if (!m_decoded.push(decoded)) {
+            break;
+        }
+
+        // Задача на каждое изображение в очереди: анализ не ждёт декодера
+        m_pendingAnalyses.fetchAndAddOrdered(1);
+        m_scheduler.submit(JobScheduler::BATCH, [this]() { analyzeNext(); });
+    }
+
+    // Последний декодер закрывает очередь анализа
+    if (m_activeDecoders.fetchAndAddOrdered(-1) == 1) {
+        m_decoded.close();
+        finishAnalysis();
+    }
+}
+
+void DirectoryAnalyzer::analyzeNext()
+{
+    // Задач столько же, сколько изображений положено в очередь, поэтому
+    // изображение для этой задачи уже декодировано
+    DecodedImage decoded;
+    if (m_decoded.tryPop(decoded)) {
+        QElapsedTimer timer;
+        timer.start();
+
+        Row row;
+        if (m_token.isCancelled()) {
+            row.cancelled = true;
+        } else if (decoded.image.isNull()) {
+            row.error = "Cannot decode image";
+        } else {
+            row = m_analyzer(decoded.image, QFileInfo(decoded.filePath).fileName(), m_token);
+        }
+        row.filePath = decoded.filePath;
+        row.elapsedMs = decoded.decodeMs + timer.elapsed();
+
+        // Освобождаем изображение до возможного ожидания записи
+        decoded = DecodedImage();
+
+        // Запись отстаёт: ждём места порциями, уступая поток интерактивному анализу
+        while (!m_results.push(row, RESULT_WAIT_MS) && !m_results.isClosed()) {
+            m_scheduler.checkpoint(JobScheduler::BATCH);
+        }
+    }
+
+    finishAnalysis();
+}
+
+void DirectoryAnalyzer::finishAnalysis()
+{
+    // Последняя задача анализа закрывает очередь записи
+    QMutexLocker locker(&m_workersMutex);
+    if (m_pendingAnalyses.fetchAndAddOrdered(-1) == 1) {
+        m_results.close();
+        m_workersDone.wakeAll();
+    }
+}
+
+void DirectoryAnalyzer::writeResults()
+{
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+
+    Row row;
+    while (m_results.pop(row)) {
+        writeRow(row);
+
+        if (row.cancelled) {
+            ++m_report.skipped;
+        } else if (row.ok) {
+            ++m_report.processed;
+        } else {
+            ++m_report.failed;
+        }
+
+        if (progressTimer.elapsed() >= PROGRESS_INTERVAL_MS) {
+            progressTimer.restart();
+            int total = m_report.processed + m_report.failed;
+            emit progress(total, total * 1000.0 / qMax<qint64>(1, m_clock.elapsed()));
+        }
+    }
+
+    m_output.close();
+
+    m_report.cancelled = m_token.isCancelled();
+    m_report.elapsedSec = m_clock.elapsed() / 1000.0;
+    if (m_report.elapsedSec > 0.0) {
+        m_report.imagesPerSecond = (m_report.processed + m_report.failed) / m_report.elapsedSec;
+    }
+
+    QMetaObject::invokeMethod(this, "onWriterFinished", Qt::QueuedConnection);
+}
+
+void DirectoryAnalyzer::writeRow(const Row &row)
+{
+    // QFile буферизует запись, на диск уходят крупные блоки
+    if (m_format == CSV) {
+        QByteArray line;
+        line += csvField(row.filePath) + ',';
+        line += csvField(row.cancelled ? QString("cancelled") : row.result) + ',';
+        line += (row.ok ? QByteArray::number(row.confidence, 'f', 4) : QByteArray()) + ',';
+        line += QByteArray::number(row.apples) + ',';
+        line += QByteArray::number(row.elapsedMs) + ',';
+        line += csvField(row.error) + '\n';
+        m_output.write(line);
+        return;
+    }
+
+    QJsonObject object;
+    object["file"] = row.filePath;
+    if (row.cancelled) {
+        object["cancelled"] = true;
+    } else if (row.ok) {
+        object["result"] = row.result;
+        object["confidence"] = row.confidence;
+        if (row.apples > 0) {
+            object["apples"] = row.apples;
+        }
+    } else {
+        object["error"] = row.error;
+    }
+    object["ms"] = row.elapsedMs;
+    m_output.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void DirectoryAnalyzer::onWriterFinished()
+{
+    m_ioThreads.waitForDone();
+    m_running.storeRelease(0);
+
+    qDebug() << "[DirectoryAnalyzer::onWriterFinished] ✓" << m_report.processed << "images,"
+             << m_report.failed << "failed," << m_report.skipped << "skipped,"
+             << m_report.imagesPerSecond << "images/s";
+    emit finished(m_report);
+}
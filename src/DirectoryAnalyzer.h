@@ -0,0 +1,157 @@
+#ifndef DIRECTORYANALYZER_H
+#define DIRECTORYANALYZER_H
+
+#include <QObject>
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include "BoundedQueue.h"
+#include "CancellationToken.h"
+#include "JobScheduler.h"
+#include <functional>
+
+/**
+ * @brief Пакетный анализ папки изображений конвейером стадий
+ *
+ * Обход папки -> чтение и декодирование (пул ввода-вывода) -> анализ
+ * (задачи класса BATCH планировщика) -> запись результатов. Стадии
+ * связаны очередями ограниченной ёмкости: чтение не уходит вперёд
+ * анализа, поэтому память не растёт с размером папки. Результаты
+ * пишутся потоком в JSON Lines или CSV по мере готовности.
+ *
+ * Задача анализа ставится на каждое декодированное изображение и не
+ * ждёт декодера, удерживая поток планировщика; ожидание отстающей
+ * записи идёт порциями с контрольными точками.
+ */
+class DirectoryAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        JSON_LINES = 0,
+        CSV
+    };
+
+    /**
+     * @brief Результат по одному изображению
+     */
+    struct Row {
+        QString filePath;
+        bool ok;
+        QString result;
+        float confidence;
+        int apples;             // Яблок найдено (режим нескольких яблок)
+        QString error;
+        bool cancelled;         // Анализ прерван отменой (не ошибка)
+        qint64 elapsedMs;       // Декодирование и анализ
+
+        Row() : ok(false), confidence(0.0f), apples(0), cancelled(false), elapsedMs(0) {}
+    };
+
+    struct Report {
+        int processed;
+        int failed;
+        int skipped;            // Изображения, анализ которых прервала отмена
+        bool cancelled;
+        double elapsedSec;
+        double imagesPerSecond;
+        QString outputPath;
+
+        Report() : processed(0), failed(0), skipped(0), cancelled(false), elapsedSec(0.0), imagesPerSecond(0.0) {}
+
+        QString toString() const;
+    };
+
+    /**
+     * @brief Анализ декодированного изображения (вызывается из потоков планировщика)
+     */
+    typedef std::function<Row(const QImage &image, const QString &fileName,
+                              const CancellationToken &token)> Analyzer;
+
+    DirectoryAnalyzer(JobScheduler &scheduler, const Analyzer &analyzer, QObject *parent = nullptr);
+    ~DirectoryAnalyzer();
+
+    /**
+     * @brief Запускает анализ папки (рекурсивно, *.jpg, *.jpeg, *.png)
+     *
+     * Изображения анализируются одновременно в пределах лимита класса BATCH
+     * @return false если папка не найдена или файл результатов не открылся
+     */
+    bool start(const QString &dirPath, const QString &outputPath, Format format,
+               const CancellationToken &token = CancellationToken());
+
+    /**
+     * @brief Формат по расширению файла результатов (.csv, иначе JSON Lines)
+     */
+    static Format formatForPath(const QString &outputPath);
+
+    bool isRunning() const { return m_running.load() != 0; }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Дожидается завершения всех стадий (сигнал finished придёт позже)
+     */
+    void waitForDone();
+
+signals:
+    void progress(int processed, double imagesPerSecond);
+    void finished(const DirectoryAnalyzer::Report &report);
+
+private slots:
+    void onWriterFinished();
+
+private:
+    Q_DISABLE_COPY(DirectoryAnalyzer)
+
+    static const int PATH_QUEUE_CAPACITY = 64;
+    static const int DECODED_QUEUE_CAPACITY = 8;    // Декодированные изображения - основной расход памяти
+    static const int RESULT_QUEUE_CAPACITY = 64;
+    static const int DECODER_THREADS = 2;
+    static const int PROGRESS_INTERVAL_MS = 250;
+    static const int RESULT_WAIT_MS = 50;           // Порция ожидания места в очереди записи
+
+    struct DecodedImage {
+        QString filePath;
+        QImage image;
+        qint64 decodeMs;
+
+        DecodedImage() : decodeMs(0) {}
+    };
+
+    void listFiles(const QString &dirPath);
+    void decodeFiles();
+    void analyzeNext();
+    void finishAnalysis();
+    void writeResults();
+    void writeRow(const Row &row);
+
+    JobScheduler &m_scheduler;
+    Analyzer m_analyzer;
+    CancellationToken m_token;
+    Format m_format;
+    QFile m_output;
+    QString m_error;
+
+    BoundedQueue<QString> m_paths;
+    BoundedQueue<DecodedImage> m_decoded;
+    BoundedQueue<Row> m_results;
+
+    // Обход, декодирование и запись - в собственном пуле ввода-вывода
+    QThreadPool m_ioThreads;
+    QAtomicInt m_running;
+    QAtomicInt m_activeDecoders;
+    QAtomicInt m_pendingAnalyses;       // Задачи анализа и незавершённое декодирование
+    QMutex m_workersMutex;
+    QWaitCondition m_workersDone;
+
+    QElapsedTimer m_clock;
+    Report m_report;
+};
+
+#endif // DIRECTORYANALYZER_H
@@ -0,0 +1,117 @@
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+
+/**
+ * @brief Почтовый ящик на один кадр между камерой и анализатором
+ *
+ * Производитель всегда перезаписывает ящик новейшим кадром и никогда
+ * не ждёт потребителя; непрочитанный кадр при этом считается отброшенным.
+ * Потребитель забирает самый свежий кадр.
+ *
+ * Кадры лежат в трёх заранее созданных ячейках (тройной буфер): ячейку
+ * записи держит производитель, ячейку чтения - потребитель, а третья
+ * передаётся между ними. Обмен - одна атомарная замена индекса, кадры
+ * при этом не выделяются в куче. Несколько производителей (камера,
+ * воспроизведение записи) упорядочиваются мьютексом, потребитель работает
+ * без блокировок; потребитель должен быть один.
+ */
+template <typename T>
+class FrameMailbox
+{
+public:
+    FrameMailbox()
+        : m_shared(1), m_back(0), m_front(2), m_produced(0), m_consumed(0), m_dropped(0) {}
+
+    /**
+     * @brief Кладёт кадр, вытесняя непрочитанный
+     * @return true если предыдущий кадр был отброшен
+     */
+    bool post(const T &frame)
+    {
+        QMutexLocker locker(&m_producerMutex);
+        m_slots[m_back] = frame;
+
+        int previous = m_shared.fetchAndStoreOrdered(m_back | FRESH);
+        m_back = previous & INDEX_MASK;
+        m_produced.fetchAndAddRelaxed(1);
+
+        if (previous & FRESH) {
+            m_dropped.fetchAndAddRelaxed(1);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Забирает новейший кадр
+     * @return false если ящик пуст
+     */
+    bool take(T &frame)
+    {
+        if (!(m_shared.loadAcquire() & FRESH)) {
+            return false;
+        }
+
+        int previous = m_shared.fetchAndStoreOrdered(m_front);
+        if (!(previous & FRESH)) {
+            // Ящик очистили между проверкой и обменом
+            m_front = previous & INDEX_MASK;
+            return false;
+        }
+
+        m_front = previous & INDEX_MASK;
+        frame = m_slots[m_front];
+        m_consumed.fetchAndAddRelaxed(1);
+        return true;
+    }
+
+    /**
+     * @brief Отбрасывает непрочитанный кадр (например, при остановке анализа)
+     *
+     * Вызывается на стороне производителя
+     */
+    void clear()
+    {
+        QMutexLocker locker(&m_producerMutex);
+        int previous = m_shared.fetchAndStoreOrdered(m_back);
+        m_back = previous & INDEX_MASK;
+        if (previous & FRESH) {
+            m_dropped.fetchAndAddRelaxed(1);
+        }
+    }
+
+    bool isEmpty() const { return !(m_shared.loadAcquire() & FRESH); }
+
+    int produced() const { return m_produced.load(); }
+    int consumed() const { return m_consumed.load(); }
+    int dropped() const { return m_dropped.load(); }
+
+    void resetCounters()
+    {
+        m_produced.store(0);
+        m_consumed.store(0);
+        m_dropped.store(0);
+    }
+
+private:
+    Q_DISABLE_COPY(FrameMailbox)
+
+    static const int INDEX_MASK = 0x3;
+    static const int FRESH = 0x4;       // В передаваемой ячейке непрочитанный кадр
+
+    T m_slots[3];
+    QAtomicInt m_shared;                // Индекс передаваемой ячейки и флаг FRESH
+    QMutex m_producerMutex;
+    int m_back;                         // Ячейка записи (под m_producerMutex)
+    int m_front;                        // Ячейка чтения (только потребитель)
+
+    QAtomicInt m_produced;
+    QAtomicInt m_consumed;
+    QAtomicInt m_dropped;
+};
+
+#endif // FRAMEMAILBOX_H
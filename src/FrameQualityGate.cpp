@@ -0,0 +1,149 @@
+#include "FrameQualityGate.h"
+#include <algorithm>
+
+namespace {
+const int DARK_LEVEL = 10;          // Яркость не выше - обрезано в тенях
+const int BRIGHT_LEVEL = 245;       // Яркость не ниже - обрезано в светах
+
+// Нижняя граница порога: в буфере 160 px шум сенсора однотонной поверхности
+// даёт дисперсию лапласиана единицы, контур яблока в фокусе - сотни
+const double MIN_SHARPNESS = 25.0;
+
+// Смаз от движения снижает резкость в разы, колебания автофокуса -
+// на десятки процентов
+const double RELATIVE_SHARPNESS = 0.4;
+
+// Яблоко на тёмном фоне занимает около половины кадра, поэтому
+// кадр отбрасывается, только если обрезано больше
+const double MAX_CLIPPED_FRACTION = 0.6;
+
+// Калибровка растёт быстро (сцена стала резче) и спадает медленно,
+// чтобы короткий смаз не опускал порог
+const double SHARPNESS_RISE = 0.5;
+const double SHARPNESS_DECAY = 0.05;
+}
+
+FrameQualityGate::FrameQualityGate()
+    : m_minSharpness(MIN_SHARPNESS)
+    , m_relativeSharpness(RELATIVE_SHARPNESS)
+    , m_maxClippedFraction(MAX_CLIPPED_FRACTION)
+    , m_sceneSharpness(0.0)
+{
+}
+
+FrameQualityGate::Result FrameQualityGate::evaluate(const LumaBuffer &luma)
+{
+    Result result;
+
+    if (luma.isNull()) {
+        return result;
+    }
+
+    // Экспозиция: гистограмма сводится к долям обрезанных пикселей
+    int dark = 0;
+    int bright = 0;
+    for (uchar value : luma.pixels) {
+        if (value <= DARK_LEVEL) {
+            ++dark;
+        } else if (value >= BRIGHT_LEVEL) {
+            ++bright;
+        }
+    }
+    const double total = luma.pixels.size();
+    result.darkFraction = dark / total;
+    result.brightFraction = bright / total;
+
+    if (result.darkFraction > m_maxClippedFraction) {
+        result.verdict = UNDEREXPOSED;
+        return result;
+    }
+    if (result.brightFraction > m_maxClippedFraction) {
+        result.verdict = OVEREXPOSED;
+        return result;
+    }
+
+    if (luma.width < 3 || luma.height < 3) {
+        return result;
+    }
+
+    result.sharpness = localSharpness(luma);
+    result.sharpnessThreshold = std::max(m_minSharpness, m_relativeSharpness * m_sceneSharpness);
+
+    // Калибруем по всем экспонированным кадрам: при долгой потере фокуса
+    // порог постепенно опускается до абсолютного минимума
+    if (m_sceneSharpness <= 0.0) {
+        m_sceneSharpness = result.sharpness;
+    } else {
+        const double rate = result.sharpness > m_sceneSharpness ? SHARPNESS_RISE : SHARPNESS_DECAY;
+        m_sceneSharpness += rate * (result.sharpness - m_sceneSharpness);
+    }
+
+    if (result.sharpness < result.sharpnessThreshold) {
+        result.verdict = BLURRED;
+    }
+
+    return result;
+}
+
+double FrameQualityGate::localSharpness(const LumaBuffer &luma) const
+{
+    // Плитки перекрывают внутренние пиксели без зазоров; в маленьком
+    // буфере сетка уменьшается, чтобы в плитке оставались пиксели
+    const int columns = std::min(TILE_GRID, (luma.width - 2) / 3);
+    const int rows = std::min(TILE_GRID, (luma.height - 2) / 3);
+    if (columns < 1 || rows < 1) {
+        return tileSharpness(luma, 1, 1, luma.width - 1, luma.height - 1);
+    }
+
+    double sharpness = 0.0;
+    for (int row = 0; row < rows; ++row) {
+        const int y0 = 1 + row * (luma.height - 2) / rows;
+        const int y1 = 1 + (row + 1) * (luma.height - 2) / rows;
+
+        for (int column = 0; column < columns; ++column) {
+            const int x0 = 1 + column * (luma.width - 2) / columns;
+            const int x1 = 1 + (column + 1) * (luma.width - 2) / columns;
+            sharpness = std::max(sharpness, tileSharpness(luma, x0, y0, x1, y1));
+        }
+    }
+    return sharpness;
+}
+
+double FrameQualityGate::tileSharpness(const LumaBuffer &luma, int x0, int y0, int x1, int y1)
+{
+    // Дисперсия 4-связного лапласиана по пикселям плитки
+    double sum = 0.0;
+    double sumSq = 0.0;
+    int count = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            int laplacian = luma.at(x - 1, y) + luma.at(x + 1, y)
+                          + luma.at(x, y - 1) + luma.at(x, y + 1)
+                          - 4 * luma.at(x, y);
+            sum += laplacian;
+            sumSq += double(laplacian) * laplacian;
+            ++count;
+        }
+    }
+
+    if (count == 0) {
+        return 0.0;
+    }
+    const double mean = sum / count;
+    return sumSq / count - mean * mean;
+}
+
+QString FrameQualityGate::verdictToString(Verdict verdict)
+{
+    switch (verdict) {
+    case ACCEPTED:
+        return "принят";
+    case BLURRED:
+        return "кадр размыт";
+    case UNDEREXPOSED:
+        return "слишком темно";
+    case OVEREXPOSED:
+        return "пересвет";
+    }
+    return "неизвестно";
+}
@@ -0,0 +1,86 @@
+#ifndef FRAMEQUALITYGATE_H
+#define FRAMEQUALITYGATE_H
+
+#include <QString>
+#include "LumaBuffer.h"
+
+/**
+ * @brief Быстрая проверка качества кадра перед анализом
+ *
+ * Работает с уменьшенной яркостью кадра: резкость оценивается
+ * дисперсией лапласиана, экспозиция - долей обрезанных в тенях
+ * и в светах пикселей. Размытые и плохо экспонированные кадры
+ * отбрасываются до извлечения признаков.
+ *
+ * Резкость считается по плиткам сетки и берётся максимум: яблоко
+ * в фокусе на размытом фоне (съёмка вблизи) остаётся резким, хотя
+ * дисперсия по всему кадру мала. Порог калибруется по недавним кадрам
+ * той же сцены: кадр размыт, если его резкость заметно ниже обычной
+ * для сцены, а не ниже числа, подобранного для одной камеры.
+ */
+class FrameQualityGate
+{
+public:
+    static const int ANALYSIS_SIZE = 160;     // Большая сторона буфера яркости для проверки
+    static const int TILE_GRID = 4;           // Сетка плиток для оценки резкости
+
+    enum Verdict {
+        ACCEPTED,
+        BLURRED,
+        UNDEREXPOSED,
+        OVEREXPOSED
+    };
+
+    struct Result {
+        Verdict verdict;
+        double sharpness;           // Максимум дисперсии лапласиана по плиткам
+        double sharpnessThreshold;  // Порог резкости для этого кадра
+        double darkFraction;        // Доля пикселей, обрезанных в тенях
+        double brightFraction;      // Доля пикселей, обрезанных в светах
+
+        Result() : verdict(ACCEPTED), sharpness(0.0), sharpnessThreshold(0.0),
+                   darkFraction(0.0), brightFraction(0.0) {}
+        bool accepted() const { return verdict == ACCEPTED; }
+    };
+
+    FrameQualityGate();
+
+    /**
+     * @brief Абсолютный минимум резкости (до калибровки и для однотонных сцен)
+     */
+    void setMinSharpness(double sharpness) { m_minSharpness = sharpness; }
+
+    /**
+     * @brief Доля обычной резкости сцены, ниже которой кадр считается размытым
+     */
+    void setRelativeSharpness(double fraction) { m_relativeSharpness = fraction; }
+    void setMaxClippedFraction(double fraction) { m_maxClippedFraction = fraction; }
+
+    /**
+     * @brief Оценивает кадр и уточняет калибровку резкости сцены
+     */
+    Result evaluate(const LumaBuffer &luma);
+
+    /**
+     * @brief Сбрасывает калибровку (новая сцена или смена камеры)
+     */
+    void reset() { m_sceneSharpness = 0.0; }
+
+    double sceneSharpness() const { return m_sceneSharpness; }
+
+    /**
+     * @brief Причина отказа для пользователя
+     */
+    static QString verdictToString(Verdict verdict);
+
+private:
+    static double tileSharpness(const LumaBuffer &luma, int x0, int y0, int x1, int y1);
+    double localSharpness(const LumaBuffer &luma) const;
+
+    double m_minSharpness;
+    double m_relativeSharpness;
+    double m_maxClippedFraction;
+    double m_sceneSharpness;        // Обычная резкость сцены (0 - не откалибрована)
+};
+
+#endif // FRAMEQUALITYGATE_H
@@ -0,0 +1,106 @@
+#include "FrameRecorder.h"
+#include <QBuffer>
+#include <QDebug>
+#include <QtConcurrent>
+
+FrameRecorder::FrameRecorder()
+    : m_firstTimestampUs(-1)
+    , m_queue(QUEUE_CAPACITY)
+    , m_recording(0)
+    , m_recorded(0)
+    , m_dropped(0)
+{
+    m_writerThread.setMaxThreadCount(1);
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+}
+
+bool FrameRecorder::start(const QString &filePath)
+{
+    stop();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[FrameRecorder::start] Cannot open:" << filePath;
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(QDataStream::Qt_5_6);
+    m_stream << MAGIC << VERSION;
+
+    m_firstTimestampUs = -1;
+    m_recorded.store(0);
+    m_dropped.store(0);
+    m_queue.reopen();
+
+    QtConcurrent::run(&m_writerThread, [this]() { writeFrames(); });
+    m_recording.storeRelease(1);
+
+    qDebug() << "[FrameRecorder::start] ✓ Recording to:" << filePath;
+    return true;
+}
+
+void FrameRecorder::stop()
+{
+    if (!m_recording.fetchAndStoreOrdered(0)) {
+        return;
+    }
+
+    // Очередь дописывается до конца
+    m_queue.close();
+    m_writerThread.waitForDone();
+
+    m_stream.setDevice(nullptr);
+    m_file.close();
+
+    qDebug() << "[FrameRecorder::stop] ✓ Frames recorded:" << m_recorded.load()
+             << "dropped:" << m_dropped.load();
+}
+
+void FrameRecorder::record(const CameraFrame &frame)
+{
+    if (!m_recording.loadAcquire()) {
+        return;
+    }
+
+    if (!m_queue.tryPush(frame)) {
+        m_dropped.fetchAndAddRelaxed(1);
+    }
+}
+
+void FrameRecorder::writeFrames()
+{
+    CameraFrame frame;
+    while (m_queue.pop(frame)) {
+        writeFrame(frame);
+    }
+}
+
+void FrameRecorder::writeFrame(const CameraFrame &frame)
+{
+    if (m_firstTimestampUs < 0) {
+        m_firstTimestampUs = frame.timestampUs;
+    }
+    m_stream << qint64(frame.timestampUs - m_firstTimestampUs);
+
+    if (frame.isYuv()) {
+        const YuvFrame &yuv = frame.yuv;
+        m_stream << quint8(YUV_FRAME)
+                 << qint32(yuv.width) << qint32(yuv.height) << qint32(yuv.yStride)
+                 << qint32(yuv.uOffset) << qint32(yuv.vOffset)
+                 << qint32(yuv.chromaStride) << qint32(yuv.chromaStep)
+                 << yuv.data;
+    } else {
+        QByteArray jpeg;
+        QBuffer buffer(&jpeg);
+        buffer.open(QIODevice::WriteOnly);
+        frame.image.save(&buffer, "JPEG", 90);
+        m_stream << quint8(JPEG_FRAME) << jpeg;
+    }
+
+    m_recorded.fetchAndAddRelaxed(1);
+}
@@ -0,0 +1,64 @@
+#ifndef FRAMERECORDER_H
+#define FRAMERECORDER_H
+
+#include <QFile>
+#include <QDataStream>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include "BoundedQueue.h"
+#include "CameraFrame.h"
+
+/**
+ * @brief Запись кадров видоискателя в файл для воспроизведения (FrameReplaySource)
+ *
+ * Формат: заголовок (MAGIC, VERSION), затем кадры с меткой времени
+ * относительно первого кадра. YUV кадры пишутся сырыми плоскостями,
+ * RGB кадры - в JPEG (как MJPEG). record() не блокирует поток камеры:
+ * кадры пишутся в фоне, при переполнении очереди отбрасываются.
+ */
+class FrameRecorder
+{
+public:
+    static const quint32 MAGIC = 0x41524346;     // "ARCF"
+    static const quint32 VERSION = 1;
+
+    enum FrameKind {
+        YUV_FRAME = 0,
+        JPEG_FRAME = 1
+    };
+
+    FrameRecorder();
+    ~FrameRecorder();
+
+    bool start(const QString &filePath);
+    void stop();
+    bool isRecording() const { return m_recording.load() != 0; }
+
+    /**
+     * @brief Ставит кадр в очередь записи (из потока камеры)
+     */
+    void record(const CameraFrame &frame);
+
+    int recordedFrames() const { return m_recorded.load(); }
+    int droppedFrames() const { return m_dropped.load(); }
+
+private:
+    Q_DISABLE_COPY(FrameRecorder)
+
+    static const int QUEUE_CAPACITY = 8;
+
+    void writeFrames();
+    void writeFrame(const CameraFrame &frame);
+
+    QFile m_file;
+    QDataStream m_stream;
+    qint64 m_firstTimestampUs;
+
+    BoundedQueue<CameraFrame> m_queue;
+    QThreadPool m_writerThread;
+    QAtomicInt m_recording;
+    QAtomicInt m_recorded;
+    QAtomicInt m_dropped;
+};
+
+#endif // FRAMERECORDER_H
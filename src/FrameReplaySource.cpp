@@ -0,0 +1,133 @@
+#include "FrameReplaySource.h"
+#include "FrameRecorder.h"
+#include <QFile>
+#include <QDataStream>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent>
+
+FrameReplaySource::FrameReplaySource(QObject *parent)
+    : QObject(parent)
+    , m_pacing(ORIGINAL_SPEED)
+    , m_fps(30.0)
+    , m_running(0)
+{
+    m_replayThread.setMaxThreadCount(1);
+}
+
+FrameReplaySource::~FrameReplaySource()
+{
+    stop();
+}
+
+bool FrameReplaySource::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[FrameReplaySource::load] Cannot open:" << filePath;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != FrameRecorder::MAGIC || version != FrameRecorder::VERSION) {
+        qWarning() << "[FrameReplaySource::load] Not a frame recording:" << filePath;
+        return false;
+    }
+
+    m_frames.clear();
+
+    while (!stream.atEnd()) {
+        RecordedFrame recorded;
+        quint8 kind = 0;
+        stream >> recorded.offsetUs >> kind;
+
+        if (kind == FrameRecorder::YUV_FRAME) {
+            qint32 width, height, yStride, uOffset, vOffset, chromaStride, chromaStep;
+            YuvFrame &yuv = recorded.frame.yuv;
+            stream >> width >> height >> yStride >> uOffset >> vOffset
+                   >> chromaStride >> chromaStep >> yuv.data;
+            yuv.width = width;
+            yuv.height = height;
+            yuv.yStride = yStride;
+            yuv.uOffset = uOffset;
+            yuv.vOffset = vOffset;
+            yuv.chromaStride = chromaStride;
+            yuv.chromaStep = chromaStep;
+        } else {
+            QByteArray jpeg;
+            stream >> jpeg;
+            recorded.frame.image = QImage::fromData(jpeg, "JPEG");
+        }
+
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "[FrameReplaySource::load] Truncated recording, frames read:" << m_frames.size();
+            break;
+        }
+
+        m_frames.append(recorded);
+    }
+
+    qDebug() << "[FrameReplaySource::load] ✓ Frames loaded:" << m_frames.size() << "from" << filePath;
+    return !m_frames.isEmpty();
+}
+
+void FrameReplaySource::setPacing(Pacing pacing, double fps)
+{
+    m_pacing = pacing;
+    m_fps = qMax(0.1, fps);
+}
+
+void FrameReplaySource::start()
+{
+    if (m_running.fetchAndStoreOrdered(1)) {
+        return;
+    }
+
+    m_frameMailbox.clear();
+    m_frameMailbox.resetCounters();
+    QtConcurrent::run(&m_replayThread, [this]() { replay(); });
+}
+
+void FrameReplaySource::stop()
+{
+    m_running.storeRelease(0);
+    m_replayThread.waitForDone();
+}
+
+void FrameReplaySource::replay()
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    for (int i = 0; i < m_frames.size() && m_running.loadAcquire(); ++i) {
+        if (m_pacing == AS_FAST_AS_POSSIBLE) {
+            // Ждём, пока анализ заберёт предыдущий кадр: кадры не теряются
+            while (!m_frameMailbox.isEmpty() && m_running.loadAcquire()) {
+                QThread::usleep(200);
+            }
+        } else {
+            qint64 dueUs = (m_pacing == ORIGINAL_SPEED)
+                    ? m_frames[i].offsetUs
+                    : qint64(i * 1000000.0 / m_fps);
+            qint64 waitUs = dueUs - clock.nsecsElapsed() / 1000;
+            if (waitUs > 0) {
+                QThread::usleep(static_cast<unsigned long>(waitUs));
+            }
+        }
+
+        // Метка времени - момент выдачи, как у кадра камеры
+        CameraFrame frame = m_frames[i].frame;
+        frame.timestampUs = CameraFrame::clockUs();
+        m_frameMailbox.post(frame);
+        emit frameReady();
+    }
+
+    m_running.storeRelease(0);
+    emit finished();
+}
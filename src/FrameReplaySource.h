@@ -0,0 +1,83 @@
+#ifndef FRAMEREPLAYSOURCE_H
+#define FRAMEREPLAYSOURCE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QVector>
+#include "FrameMailbox.h"
+#include "CameraFrame.h"
+
+/**
+ * @brief Воспроизведение записи FrameRecorder вместо камеры
+ *
+ * Кадры выдаются через тот же ящик и сигнал frameReady(), что и у
+ * CameraHandler, поэтому real-time анализ работает без изменений и
+ * без физической камеры. Режимы темпа:
+ *  - ORIGINAL_SPEED: по записанным меткам времени;
+ *  - FIXED_FPS: с заданной частотой;
+ *  - AS_FAST_AS_POSSIBLE: следующий кадр - как только анализ забрал
+ *    предыдущий (без потерь кадров, максимальная пропускная способность).
+ */
+class FrameReplaySource : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Pacing {
+        ORIGINAL_SPEED,
+        FIXED_FPS,
+        AS_FAST_AS_POSSIBLE
+    };
+
+    explicit FrameReplaySource(QObject *parent = nullptr);
+    ~FrameReplaySource();
+
+    /**
+     * @brief Загружает запись целиком в память (чтение файла не влияет на замеры)
+     */
+    bool load(const QString &filePath);
+    int frameCount() const { return m_frames.size(); }
+
+    void setPacing(Pacing pacing, double fps = 30.0);
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running.load() != 0; }
+
+    FrameMailbox<CameraFrame> &frameMailbox() { return m_frameMailbox; }
+
+    int deliveredFrames() const { return m_frameMailbox.produced(); }
+    int droppedFrames() const { return m_frameMailbox.dropped(); }
+
+signals:
+    /**
+     * @brief Новый кадр в frameMailbox(); испускается в потоке воспроизведения
+     */
+    void frameReady();
+
+    /**
+     * @brief Все кадры выданы (или воспроизведение остановлено)
+     */
+    void finished();
+
+private:
+    struct RecordedFrame {
+        qint64 offsetUs;        // Смещение от начала записи
+        CameraFrame frame;
+
+        RecordedFrame() : offsetUs(0) {}
+    };
+
+    void replay();
+
+    QVector<RecordedFrame> m_frames;
+    Pacing m_pacing;
+    double m_fps;
+
+    FrameMailbox<CameraFrame> m_frameMailbox;
+    QThreadPool m_replayThread;
+    QAtomicInt m_running;
+};
+
+#endif // FRAMEREPLAYSOURCE_H
@@ -1,19 +1,118 @@
 #include "ImageProcessor.h"
 #include "SegmentationData.h"
+#include "ImageView.h"
+#include "YuvFrame.h"
 #include <QDebug>
 #include <QImage>
 #include <QFile>
 #include <QFileInfo>
 #include <cmath>
+#include <algorithm>
 
 // TODO: После настройки Conan добавить:
 // #include <opencv2/opencv.hpp>
 // #include <opencv2/imgproc.hpp>
 // #include <opencv2/highgui.hpp>
 
+namespace {
+// Гистограммы R, G, B (по 64 бина на канал = 192 признака) и средние каналов
+struct ColorAccumulator
+{
+    ColorAccumulator()
+        : histR(64, 0), histG(64, 0), histB(64, 0)
+        , sumR(0), sumG(0), sumB(0), totalPixels(0) {}
+
+    void add(QRgb pixel)
+    {
+        int r = qRed(pixel);
+        int g = qGreen(pixel);
+        int b = qBlue(pixel);
+
+        // Квантуем в 64 бина
+        histR[(r * 64) / 256]++;
+        histG[(g * 64) / 256]++;
+        histB[(b * 64) / 256]++;
+
+        sumR += r;
+        sumG += g;
+        sumB += b;
+        totalPixels++;
+    }
+
+    std::vector<double> features() const
+    {
+        std::vector<double> colorFeatures;
+        int total = std::max(totalPixels, 1);
+
+        // Нормализуем гистограммы
+        for (int i = 0; i < 64; ++i) {
+            colorFeatures.push_back(static_cast<double>(histR[i]) / total);
+            colorFeatures.push_back(static_cast<double>(histG[i]) / total);
+            colorFeatures.push_back(static_cast<double>(histB[i]) / total);
+        }
+
+        // Дополнительные статистики: средние значения
+        colorFeatures.push_back(static_cast<double>(sumR) / total / 255.0);
+        colorFeatures.push_back(static_cast<double>(sumG) / total / 255.0);
+        colorFeatures.push_back(static_cast<double>(sumB) / total / 255.0);
+
+        return colorFeatures;
+    }
+
+    std::vector<int> histR;
+    std::vector<int> histG;
+    std::vector<int> histB;
+    qint64 sumR, sumG, sumB;
+    int totalPixels;
+};
+
+// Упрощенные текстурные признаки без OpenCV: edge density и контраст по яркости
+std::vector<double> textureFeaturesFromGray(const std::vector<uchar> &gray, int width, int height)
+{
+    std::vector<double> textureFeatures;
+
+    // Простой edge detector (Sobel-подобный)
+    int edgeCount = 0;
+    for (int y = 1; y < height - 1; ++y) {
+        const uchar *row = &gray[y * width];
+        for (int x = 1; x < width - 1; ++x) {
+            int gx = row[x + 1] - row[x - 1];
+            int gy = row[x + width] - row[x - width];
+            int gradient = std::sqrt(gx * gx + gy * gy);
+            if (gradient > 50) {
+                edgeCount++;
+            }
+        }
+    }
+
+    double edgeDensity = static_cast<double>(edgeCount) /
+                        ((width - 2) * (height - 2));
+    textureFeatures.push_back(edgeDensity);
+
+    // Контраст
+    int minGray = 255, maxGray = 0;
+    for (uchar value : gray) {
+        minGray = std::min(minGray, static_cast<int>(value));
+        maxGray = std::max(maxGray, static_cast<int>(value));
+    }
+    double contrast = (maxGray - minGray) / 255.0;
+    textureFeatures.push_back(contrast);
+
+    // Дополняем до нужной размерности нулями
+    while (textureFeatures.size() < 128) {
+        textureFeatures.push_back(0.0);
+    }
+
+    return textureFeatures;
+}
+}
+
 ImageProcessor::ImageProcessor()
     : m_yolo11Segm(nullptr)
     , m_yolact(nullptr)
+    , m_detectorInputSize(640)
+    , m_intraOpThreads(0)
+    , m_tiledInference(false)
 {
     qDebug() << "ImageProcessor initialized";
 }
@@ -24,38 +123,84 @@ ImageProcessor::~ImageProcessor()
     delete m_yolact;
 }
 
+ImageProcessor *ImageProcessor::createContext() const
+{
+    ImageProcessor *context = new ImageProcessor();
+
+    // QMap разделяет данные неявно, копирование аннотаций не выполняется
+    context->m_annotations = m_annotations;
+    context->m_annotationsDir = m_annotationsDir;
+    context->m_detectorInputSize.store(m_detectorInputSize.load());
+    context->m_intraOpThreads = m_intraOpThreads;
+    context->m_tiledInference = m_tiledInference;
+    context->m_tilingOptions = m_tilingOptions;
+
+    if (m_yolo11Segm) {
+        context->m_yolo11Segm = m_yolo11Segm->createContext();
+    }
+    if (m_yolact) {
+        context->m_yolact = m_yolact->createContext();
+    }
+
+    return context;
+}
+
 std::vector<double> ImageProcessor::extractFeatures(const QString &imagePath, bool useSegmentation)
 {
     qDebug() << "Extracting features from:" << imagePath << "useSegmentation:" << useSegmentation;
 
+    // Изображение декодируется один раз для всех групп признаков
+    QImage image(imagePath);
+    if (image.isNull()) {
+        qWarning() << "Failed to load image:" << imagePath;
+    }
+
+    return extractFeatures(image, QFileInfo(imagePath).fileName(), useSegmentation);
+}
+
+std::vector<double> ImageProcessor::extractFeatures(const QImage &image, const QString &imageName,
+                                                    bool useSegmentation)
+{
     // Если используем сегментацию и есть аннотации
-    if (useSegmentation && !m_annotations.isEmpty()) {
-        QFileInfo fileInfo(imagePath);
-        QString imageName = fileInfo.fileName();
-        
+    if (useSegmentation && !m_annotations.isEmpty() && !imageName.isEmpty() && !image.isNull()) {
         // Ищем аннотацию для этого изображения
-        if (m_annotations.contains(imageName)) {
-            const SegmentationData::ImageAnnotation &annotation = m_annotations[imageName];
+        // (константный доступ: аннотации разделяются между контекстами)
+        auto it = m_annotations.constFind(imageName);
+        if (it != m_annotations.constEnd()) {
+            const SegmentationData::ImageAnnotation &annotation = it.value();
             
             // Ищем полигон с меткой "apple"
             for (const SegmentationData::Polygon &polygon : annotation.polygons) {
                 if (polygon.label.toLower() == "apple") {
                     // Используем расширенное извлечение признаков с маской
-                    return extractFeaturesWithMask(imagePath, polygon);
+                    return extractFeaturesWithMask(image, polygon);
                 }
             }
         }
     }
 
     // Стандартное извлечение признаков
+    return extractFeatures(image);
+}
+
+std::vector<double> ImageProcessor::extractFeatures(const QImage &image)
+{
     std::vector<double> features;
 
+    // Кроп + ресайз общие для цветовых и текстурных признаков
+    QImage prepared = preprocessImage(image);
+    if (prepared.isNull()) {
+        // Возвращаем нулевые признаки той же размерности, что и при ошибке загрузки
+        features.resize(256 + 128, 0.0);
+        return features;
+    }
+
     // Извлекаем цветовые признаки
-    std::vector<double> colorFeatures = extractColorFeatures(imagePath);
+    std::vector<double> colorFeatures = computeColorFeatures(prepared);
     features.insert(features.end(), colorFeatures.begin(), colorFeatures.end());
 
     // Извлекаем текстурные признаки
-    std::vector<double> textureFeatures = extractTextureFeatures(imagePath);
+    std::vector<double> textureFeatures = computeTextureFeatures(prepared);
     features.insert(features.end(), textureFeatures.begin(), textureFeatures.end());
 
     qDebug() << "Extracted" << features.size() << "features";
@@ -63,135 +208,170 @@ std::vector<double> ImageProcessor::extractFeatures(const QString &imagePath, bo
     return features;
 }
 
-std::vector<double> ImageProcessor::extractColorFeatures(const QString &imagePath)
+std::vector<double> ImageProcessor::extractAppleFeatures(const QImage &image, const AppleInstance &apple,
+                                                         bool useSegmentation)
 {
-    std::vector<double> colorFeatures;
+    // Область яблока ссылается на пиксели исходного изображения
+    QImage crop = imageCropView(image, apple.bbox);
+
+    if (useSegmentation && apple.polygon.points.size() >= 3) {
+        // Переводим контур в координаты области
+        SegmentationData::Polygon local = apple.polygon;
+        for (QPointF &point : local.points) {
+            point -= apple.bbox.topLeft();
+        }
+        local.boundingBox.translate(-apple.bbox.topLeft());
 
+        return extractFeaturesWithMask(crop, local);
+    }
+
+    return extractFeatures(crop);
+}
+
+std::vector<double> ImageProcessor::extractColorFeatures(const QString &imagePath)
+{
     // Загружаем и предобрабатываем изображение (кроп + ресайз)
     QImage image = preprocessImage(imagePath);
     if (image.isNull()) {
         qWarning() << "Failed to load image:" << imagePath;
         // Возвращаем пустой вектор нужного размера
-        colorFeatures.resize(256, 0.0);
-        return colorFeatures;
+        return std::vector<double>(256, 0.0);
     }
 
-    // Вычисляем цветовые гистограммы (упрощенная версия без OpenCV)
-    // HSV гистограммы для каждого канала
-
-    // Гистограммы R, G, B (по 64 бина на канал = 192 признака)
-    std::vector<int> histR(64, 0);
-    std::vector<int> histG(64, 0);
-    std::vector<int> histB(64, 0);
+    return computeColorFeatures(image);
+}
 
-    int totalPixels = 0;
+std::vector<double> ImageProcessor::computeColorFeatures(const QImage &image)
+{
+    ColorAccumulator color;
 
     for (int y = 0; y < image.height(); ++y) {
         for (int x = 0; x < image.width(); ++x) {
-            QRgb pixel = image.pixel(x, y);
-            int r = qRed(pixel);
-            int g = qGreen(pixel);
-            int b = qBlue(pixel);
-
-            // Квантуем в 64 бина
-            int binR = (r * 64) / 256;
-            int binG = (g * 64) / 256;
-            int binB = (b * 64) / 256;
-
-            histR[binR]++;
-            histG[binG]++;
-            histB[binB]++;
-            totalPixels++;
+            color.add(image.pixel(x, y));
         }
     }
 
-    // Нормализуем гистограммы
-    for (int i = 0; i < 64; ++i) {
-        colorFeatures.push_back(static_cast<double>(histR[i]) / totalPixels);
-        colorFeatures.push_back(static_cast<double>(histG[i]) / totalPixels);
-        colorFeatures.push_back(static_cast<double>(histB[i]) / totalPixels);
+    return color.features();
+}
+
+std::vector<double> ImageProcessor::extractTextureFeatures(const QString &imagePath)
+{
+    QImage image = preprocessImage(imagePath);
+    if (image.isNull()) {
+        // Возвращаем пустой вектор
+        return std::vector<double>(128, 0.0);
+    }
+
+    return computeTextureFeatures(image);
+}
+
+std::vector<double> ImageProcessor::extractTextureFeatures(const QImage &image)
+{
+    QImage prepared = preprocessImage(image);
+    if (prepared.isNull()) {
+        return std::vector<double>(128, 0.0);
     }
 
-    // Дополнительные статистики: средние значения, стандартное отклонение
-    double meanR = 0, meanG = 0, meanB = 0;
+    return computeTextureFeatures(prepared);
+}
+
+std::vector<double> ImageProcessor::computeTextureFeatures(const QImage &image)
+{
+    std::vector<uchar> gray(image.width() * image.height());
     for (int y = 0; y < image.height(); ++y) {
         for (int x = 0; x < image.width(); ++x) {
-            QRgb pixel = image.pixel(x, y);
-            meanR += qRed(pixel);
-            meanG += qGreen(pixel);
-            meanB += qBlue(pixel);
+            gray[y * image.width() + x] = static_cast<uchar>(qGray(image.pixel(x, y)));
         }
     }
 
-    meanR /= totalPixels;
-    meanG /= totalPixels;
-    meanB /= totalPixels;
-
-    colorFeatures.push_back(meanR / 255.0);
-    colorFeatures.push_back(meanG / 255.0);
-    colorFeatures.push_back(meanB / 255.0);
-
-    return colorFeatures;
+    return textureFeaturesFromGray(gray, image.width(), image.height());
 }
 
-std::vector<double> ImageProcessor::extractTextureFeatures(const QString &imagePath)
+std::vector<double> ImageProcessor::extractFeatures(const YuvFrame &frame)
 {
-    std::vector<double> textureFeatures;
+    std::vector<double> features;
 
-    QImage image = preprocessImage(imagePath);
-    if (image.isNull()) {
-        // Возвращаем пустой вектор
-        textureFeatures.resize(128, 0.0);
-        return textureFeatures;
+    // Та же область, что в preprocessImage: центральные 60% кадра,
+    // но вместо ресайза усредняем её по сетке IMAGE_SIZE прямо из плоскостей YUV
+    int cropWidth = frame.width * 0.6;
+    int cropHeight = frame.height * 0.6;
+    QSize grid = QSize(cropWidth, cropHeight).scaled(IMAGE_SIZE, IMAGE_SIZE, Qt::KeepAspectRatio);
+
+    if (frame.isNull() || grid.isEmpty()) {
+        features.resize(256 + 128, 0.0);
+        return features;
     }
 
-    // Упрощенные текстурные признаки без OpenCV
-    // Вычисляем edge density, contrast, и т.д.
+    int x0 = (frame.width - cropWidth) / 2;
+    int y0 = (frame.height - cropHeight) / 2;
 
-    // Простой edge detector (Sobel-подобный)
-    int edgeCount = 0;
-    for (int y = 1; y < image.height() - 1; ++y) {
-        for (int x = 1; x < image.width() - 1; ++x) {
-            int gx = qGray(image.pixel(x + 1, y)) - qGray(image.pixel(x - 1, y));
-            int gy = qGray(image.pixel(x, y + 1)) - qGray(image.pixel(x, y - 1));
-            int gradient = std::sqrt(gx * gx + gy * gy);
-            if (gradient > 50) {
-                edgeCount++;
+    ColorAccumulator color;
+    std::vector<uchar> gray(grid.width() * grid.height());
+
+    // Ячейка сетки - среднее всех пикселей своего прямоугольника, как при
+    // QImage::scaled(SmoothTransformation). Усредняются Y, U и V: преобразование
+    // в RGB линейно, поэтому вне насыщения результат совпадает со средним RGB
+    std::vector<int> columnStart(grid.width() + 1);
+    for (int gx = 0; gx <= grid.width(); ++gx) {
+        columnStart[gx] = x0 + gx * cropWidth / grid.width();
+    }
+
+    std::vector<int> sumY(grid.width());
+    std::vector<int> sumU(grid.width());
+    std::vector<int> sumV(grid.width());
+
+    for (int gy = 0; gy < grid.height(); ++gy) {
+        const int rowBegin = y0 + gy * cropHeight / grid.height();
+        const int rowEnd = qMax(rowBegin + 1, y0 + (gy + 1) * cropHeight / grid.height());
+
+        std::fill(sumY.begin(), sumY.end(), 0);
+        std::fill(sumU.begin(), sumU.end(), 0);
+        std::fill(sumV.begin(), sumV.end(), 0);
+
+        for (int sy = rowBegin; sy < rowEnd; ++sy) {
+            const uchar *yRow = frame.yRow(sy);
+            for (int gx = 0; gx < grid.width(); ++gx) {
+                const int columnEnd = qMax(columnStart[gx] + 1, columnStart[gx + 1]);
+                for (int sx = columnStart[gx]; sx < columnEnd; ++sx) {
+                    sumY[gx] += yRow[sx];
+                    sumU[gx] += frame.u(sx, sy);
+                    sumV[gx] += frame.v(sx, sy);
+                }
             }
         }
-    }
 
-    double edgeDensity = static_cast<double>(edgeCount) /
-                        ((image.width() - 2) * (image.height() - 2));
-    textureFeatures.push_back(edgeDensity);
+        for (int gx = 0; gx < grid.width(); ++gx) {
+            const int count = (rowEnd - rowBegin) * qMax(1, columnStart[gx + 1] - columnStart[gx]);
+            QRgb rgb = YuvFrame::toRgb((sumY[gx] + count / 2) / count,
+                                       (sumU[gx] + count / 2) / count,
+                                       (sumV[gx] + count / 2) / count);
 
-    // Контраст
-    double minGray = 255, maxGray = 0;
-    for (int y = 0; y < image.height(); ++y) {
-        for (int x = 0; x < image.width(); ++x) {
-            int gray = qGray(image.pixel(x, y));
-            minGray = std::min(minGray, static_cast<double>(gray));
-            maxGray = std::max(maxGray, static_cast<double>(gray));
+            // Яркость для текстуры считается так же, как в computeTextureFeatures
+            gray[gy * grid.width() + gx] = static_cast<uchar>(qGray(rgb));
+            color.add(rgb);
         }
     }
-    double contrast = (maxGray - minGray) / 255.0;
-    textureFeatures.push_back(contrast);
 
-    // Дополняем до нужной размерности нулями
-    while (textureFeatures.size() < 128) {
-        textureFeatures.push_back(0.0);
-    }
+    std::vector<double> colorFeatures = color.features();
+    features.insert(features.end(), colorFeatures.begin(), colorFeatures.end());
 
-    return textureFeatures;
+    std::vector<double> textureFeatures = textureFeaturesFromGray(gray, grid.width(), grid.height());
+    features.insert(features.end(), textureFeatures.begin(), textureFeatures.end());
+
+    return features;
 }
 
 bool ImageProcessor::detectApple(const QString &imagePath)
 {
     // Упрощенная проверка: предполагаем, что если изображение корректно загружается
-    // и имеет достаточный размер, то это может быть яблоко
-    // В полной версии здесь будет YOLO/YOLACT детекция
+    // и имеет достаточный размер, то это может быть яблоко.
+    // Если модель детекции загружена и инференс работает, решение принимает YOLO/YOLACT
 
-    QImage image(imagePath);
+    return detectApple(QImage(imagePath), QFileInfo(imagePath).fileName());
+}
+
+bool ImageProcessor::detectApple(const QImage &image, const QString &imageName)
+{
     if (image.isNull()) {
         return false;
     }
@@ -201,15 +381,33 @@ bool ImageProcessor::detectApple(const QString &imagePath)
         return false;
     }
 
-    // TODO: Добавить YOLO/YOLACT детекцию когда будет настроен OpenCV
-    // Пока возвращаем true для всех корректных изображений
+    if (detectorDecides()) {
+        return !detectApplesYOLO(image, imageName).isEmpty();
+    }
+
+    return true;
+}
+
+bool ImageProcessor::detectApple(const YuvFrame &frame)
+{
+    if (frame.isNull() || frame.width < 50 || frame.height < 50) {
+        return false;
+    }
+
+    if (detectorDecides()) {
+        return !detectApplesYOLO(frame.toImage(detectorInputSize())).isEmpty();
+    }
 
     return true;
 }
 
 QImage ImageProcessor::preprocessImage(const QString &imagePath)
 {
-    QImage image(imagePath);
+    return preprocessImage(QImage(imagePath));
+}
+
+QImage ImageProcessor::preprocessImage(const QImage &image)
+{
     if (image.isNull()) {
         return QImage();
     }
@@ -1,13 +1,17 @@
 #ifndef IMAGEPROCESSOR_H
 #define IMAGEPROCESSOR_H
 
+#include <QAtomicInt>
 #include <QString>
+#include <QStringList>
 #include <QImage>
 #include <vector>
 #include "SegmentationData.h"
 #include "YOLO11Segmentation.h"
 #include "YOLACTInference.h"
 
+struct YuvFrame;
+
 /**
  * @brief Класс для предобработки изображений яблок
  *
@@ -21,9 +25,26 @@
 class ImageProcessor
 {
 public:
+    /**
+     * @brief Яблоко, найденное на изображении
+     */
+    struct AppleInstance {
+        QRect bbox;                          // Область яблока на изображении
+        SegmentationData::Polygon polygon;   // Контур в координатах изображения (может быть пустым)
+    };
+
     ImageProcessor();
     ~ImageProcessor();
 
+    /**
+     * @brief Создаёт контекст обработки для другого потока
+     *
+     * Контекст разделяет с исходным объектом веса моделей и аннотации
+     * (только чтение), но имеет собственные буферы инференса.
+     * Один контекст должен использоваться одним потоком одновременно.
+     */
+    ImageProcessor *createContext() const;
+
     /**
      * @brief Извлекает признаки из изображения
      * @param imagePath Путь к изображению
@@ -32,12 +53,54 @@ public:
      */
     std::vector<double> extractFeatures(const QString &imagePath, bool useSegmentation = false);
 
+    /**
+     * @brief Извлекает признаки из уже декодированного изображения
+     * @param imageName Имя файла для поиска polygon аннотации (может быть пустым)
+     */
+    std::vector<double> extractFeatures(const QImage &image, const QString &imageName,
+                                        bool useSegmentation);
+
+    /**
+     * @brief Извлекает стандартные признаки (цвет + текстура) из изображения в памяти
+     *
+     * Предобработка выполняется один раз для всех групп признаков
+     */
+    std::vector<double> extractFeatures(const QImage &image);
+
+    /**
+     * @brief Извлекает стандартные признаки из кадра камеры в YUV без конвертации в RGB
+     *
+     * Каждая ячейка сетки IMAGE_SIZE - среднее Y, U и V своего прямоугольника
+     * кадра, как при сглаженном масштабировании в preprocessImage(), поэтому
+     * признаки совпадают с признаками того же кадра в RGB
+     */
+    std::vector<double> extractFeatures(const YuvFrame &frame);
+
     /**
      * @brief Извлекает признаки с использованием polygon маски
      */
     std::vector<double> extractFeaturesWithMask(const QString &imagePath,
                                                 const SegmentationData::Polygon &polygon);
 
+    /**
+     * @brief Извлекает признаки с polygon маской из изображения в памяти
+     * @param polygon Контур в координатах image
+     */
+    std::vector<double> extractFeaturesWithMask(const QImage &image,
+                                                const SegmentationData::Polygon &polygon);
+
+    /**
+     * @brief Извлекает признаки одного яблока на изображении
+     *
+     * Работает с областью bbox без копирования пикселей исходного изображения.
+     * Не использует модели детекции, поэтому вызовы для разных яблок
+     * одного изображения можно выполнять параллельно.
+     *
+     * @param useSegmentation Использовать контур яблока (если он есть)
+     */
+    std::vector<double> extractAppleFeatures(const QImage &image, const AppleInstance &apple,
+                                             bool useSegmentation);
+
     /**
      * @brief Предобрабатывает изображение
      * @param imagePath Путь к изображению
@@ -45,6 +108,11 @@ public:
      */
     QImage preprocessImage(const QString &imagePath);
 
+    /**
+     * @brief Предобрабатывает уже декодированное изображение (кроп + ресайз)
+     */
+    QImage preprocessImage(const QImage &image);
+
     /**
      * @brief Извлекает цветовые признаки (RGB/HSV гистограммы)
      */
@@ -60,6 +128,11 @@ public:
      */
     std::vector<double> extractTextureFeatures(const QString &imagePath);
 
+    /**
+     * @brief Извлекает текстурные признаки из изображения в памяти
+     */
+    std::vector<double> extractTextureFeatures(const QImage &image);
+
     /**
      * @brief Извлекает признаки формы из polygon
      */
@@ -70,12 +143,52 @@ public:
      */
     bool detectApple(const QString &imagePath);
 
+    /**
+     * @brief Проверяет наличие яблока на уже декодированном изображении (кадр камеры)
+     * @param imageName Имя файла для поиска аннотаций (fallback)
+     */
+    bool detectApple(const QImage &image, const QString &imageName = QString());
+
+    /**
+     * @brief Проверяет наличие яблока на YUV кадре камеры
+     *
+     * RGB строится только для детектора и сразу в разрешении его входа
+     */
+    bool detectApple(const YuvFrame &frame);
+
     /**
      * @brief Детекция яблок с использованием YOLO11
      * @return Список bounding boxes найденных яблок
      */
     QVector<QRectF> detectApplesYOLO(const QString &imagePath);
 
+    /**
+     * @brief Детекция яблок на уже декодированном изображении
+     * @param imageName Имя файла для поиска аннотаций (fallback)
+     */
+    QVector<QRectF> detectApplesYOLO(const QImage &image, const QString &imageName = QString());
+
+    /**
+     * @brief Находит яблоки вместе с их контурами (YOLO11 / YOLACT / аннотации)
+     * @param imageName Имя файла для поиска аннотаций (fallback)
+     */
+    QVector<AppleInstance> detectAppleInstances(const QImage &image, const QString &imageName = QString());
+
+    /**
+     * @brief Находит яблоки на нескольких изображениях одним вызовом модели
+     *
+     * Работает, если модель YOLO11 поддерживает динамический батч
+     * (TilingOptions::batched). Изображения, не вошедшие в батч (тайловые,
+     * пустые или батч не поддерживается), остаются с detected[i] == false:
+     * их вызывающий обрабатывает detectAppleInstances, например параллельно
+     * в своих контекстах.
+     * @param detected Для каждого изображения - обработано ли оно
+     * @return Яблоки каждого изображения в том же порядке
+     */
+    QVector<QVector<AppleInstance>> detectAppleInstancesBatch(const QVector<QImage> &images,
+                                                              const QStringList &imageNames,
+                                                              QVector<bool> &detected);
+
     /**
      * @brief Загружает YOLO11-segm модель
      */
@@ -86,6 +199,55 @@ public:
      */
     bool loadYOLACTModel(const QString &modelPath);
 
+    /**
+     * @brief Проверяет, загружена ли хотя бы одна модель детекции
+     */
+    bool hasDetectionModel() const;
+
+    /**
+     * @brief Модель детекции загружена и инференс действительно выполняется
+     *
+     * Только тогда пустой результат детектора означает "яблок нет";
+     * иначе решение принимает эвристика (размер изображения)
+     */
+    bool detectorDecides() const;
+
+    /**
+     * @brief Устанавливает размер входа детектора YOLO11 (640, 480 или 320)
+     */
+    void setDetectorInputSize(int size);
+    int detectorInputSize() const { return m_detectorInputSize.load(); }
+
+    /**
+     * @brief Минимальный размер кадра (большая x меньшая сторона), при котором
+     *        ни вход детектора, ни область признаков не увеличиваются
+     *
+     * В режиме нескольких яблок признаки берутся из рамки яблока, а не из
+     * центра кадра: яблоко на MULTI_APPLE_MIN_FRACTION большей стороны должно
+     * давать область признаков не меньше IMAGE_SIZE. Детекция в этом режиме
+     * идёт по полному кадру, поэтому при тайловом инференсе кадр должен быть
+     * крупнее порога тайлинга.
+     */
+    QSize requiredFrameSize(bool multiApple = false) const;
+
+    /**
+     * @brief Число intra-op потоков ONNX Runtime для моделей (применяется при загрузке)
+     */
+    void setIntraOpThreads(int threads) { m_intraOpThreads = threads; }
+    int intraOpThreads() const { return m_intraOpThreads; }
+
+    /**
+     * @brief Включает тайловый инференс YOLO11 для больших изображений (ящики с яблоками)
+     */
+    void setTiledInference(bool enabled) { m_tiledInference = enabled; }
+    bool tiledInference() const { return m_tiledInference; }
+
+    /**
+     * @brief Параметры тайлов: размер, перекрытие, параллельность
+     */
+    void setTilingOptions(const YOLO11Segmentation::TilingOptions &options) { m_tilingOptions = options; }
+    YOLO11Segmentation::TilingOptions tilingOptions() const { return m_tilingOptions; }
+
     /**
      * @brief Выполняет сегментацию с использованием YOLO11-segm
      * @param imagePath Путь к изображению
@@ -105,9 +267,15 @@ public:
      */
     void setAnnotationsDirectory(const QString &dirPath);
 
+    /**
+     * @brief Есть ли labelme аннотация для файла изображения
+     */
+    bool hasAnnotation(const QString &imageName) const;
+
 private:
     static const int IMAGE_SIZE = 224;  // Стандартный размер для нейросетей
     static const int FEATURE_DIM = 512; // Размерность вектора признаков
+    static constexpr double MULTI_APPLE_MIN_FRACTION = 0.25; // Самое мелкое яблоко - доля стороны кадра
 
     QMap<QString, SegmentationData::ImageAnnotation> m_annotations;
     QString m_annotationsDir;
@@ -115,8 +283,19 @@ private:
     // Модели сегментации
     YOLO11Segmentation* m_yolo11Segm;
     YOLACTInference* m_yolact;
+    QAtomicInt m_detectorInputSize;     // Меняет регулятор из обработчика кадров, читает GUI поток
+    int m_intraOpThreads;
+    bool m_tiledInference;
+    YOLO11Segmentation::TilingOptions m_tilingOptions;
+
+    QVector<ONNXInference::SegmentationResult> runYOLO11(const QImage &image);
+
+    // Детекция без YOLO11: YOLACT, затем аннотации
+    QVector<AppleInstance> detectFallbackInstances(const QImage &image, const QString &imageName);
 
     // Вспомогательные методы
+    std::vector<double> computeColorFeatures(const QImage &image);
+    std::vector<double> computeTextureFeatures(const QImage &image);
     QImage convertToGrayscale(const QImage &image);
     double calculateCircularity(const SegmentationData::Polygon &polygon);
     double calculateAspectRatio(const QRectF &rect);
@@ -8,6 +8,34 @@
 #include <QDir>
 #include <QPainter>
 #include <cmath>
+#include <algorithm>
+
+namespace {
+// Добавляет яблоки из результатов сегментации (класс 47 в COCO датасете)
+void appendAppleInstances(const QVector<ONNXInference::SegmentationResult> &results,
+                          const QRect &imageRect,
+                          QVector<ImageProcessor::AppleInstance> &apples)
+{
+    for (const auto &result : results) {
+        if (!result.detection.className.toLower().contains("apple") &&
+            result.detection.classId != 47) {
+            continue;
+        }
+
+        ImageProcessor::AppleInstance apple;
+        apple.bbox = result.detection.bbox.toAlignedRect().intersected(imageRect);
+        if (apple.bbox.isEmpty()) {
+            continue;
+        }
+
+        apple.polygon.label = "apple";
+        apple.polygon.points = result.polygon;
+        apple.polygon.boundingBox = result.detection.bbox;
+        apple.polygon.area = SegmentationData::calculatePolygonArea(result.polygon);
+        apples.append(apple);
+    }
+}
+}
 
 void ImageProcessor::setAnnotationsDirectory(const QString &dirPath)
 {
@@ -20,18 +48,34 @@ void ImageProcessor::setAnnotationsDirectory(const QString &dirPath)
     qDebug() << "Loaded" << m_annotations.size() << "annotations";
 }
 
+bool ImageProcessor::hasAnnotation(const QString &imageName) const
+{
+    return !imageName.isEmpty() && m_annotations.contains(imageName);
+}
+
 std::vector<double> ImageProcessor::extractFeaturesWithMask(
     const QString &imagePath,
     const SegmentationData::Polygon &polygon)
 {
     qDebug() << "Extracting features with polygon mask from:" << imagePath;
 
-    std::vector<double> features;
-
     // Загружаем изображение
     QImage image(imagePath);
     if (image.isNull()) {
         qWarning() << "Failed to load image:" << imagePath;
+        return std::vector<double>(FEATURE_DIM, 0.0);
+    }
+
+    return extractFeaturesWithMask(image, polygon);
+}
+
+std::vector<double> ImageProcessor::extractFeaturesWithMask(
+    const QImage &image,
+    const SegmentationData::Polygon &polygon)
+{
+    std::vector<double> features;
+
+    if (image.isNull()) {
         features.resize(FEATURE_DIM, 0.0);
         return features;
     }
@@ -54,10 +98,8 @@ std::vector<double> ImageProcessor::extractFeaturesWithMask(
         }
     }
 
-    // Сохраняем временно для анализа текстуры
-    QString tempPath = "/tmp/aurcad_masked.jpg";
-    maskedImage.save(tempPath);
-    std::vector<double> textureFeatures = extractTextureFeatures(tempPath);
+    // Анализируем текстуру в памяти (общий временный файл небезопасен при параллельной работе)
+    std::vector<double> textureFeatures = extractTextureFeatures(maskedImage);
     features.insert(features.end(), textureFeatures.begin(), textureFeatures.end());
 
     // 3. Признаки формы (10 признаков)
@@ -229,62 +271,122 @@ QImage ImageProcessor::convertToGrayscale(const QImage &image)
 }
 
 QVector<QRectF> ImageProcessor::detectApplesYOLO(const QString &imagePath)
+{
+    QImage image(imagePath);
+    if (image.isNull()) {
+        qWarning() << "Failed to load image:" << imagePath;
+        return QVector<QRectF>();
+    }
+
+    return detectApplesYOLO(image, QFileInfo(imagePath).fileName());
+}
+
+QVector<QRectF> ImageProcessor::detectApplesYOLO(const QImage &image, const QString &imageName)
 {
     QVector<QRectF> detections;
 
+    for (const AppleInstance &apple : detectAppleInstances(image, imageName)) {
+        detections.append(apple.polygon.boundingBox);
+    }
+
+    return detections;
+}
+
+QVector<ImageProcessor::AppleInstance> ImageProcessor::detectAppleInstances(const QImage &image,
+                                                                           const QString &imageName)
+{
+    QVector<AppleInstance> apples;
+
     // Пробуем использовать YOLO11-segm если модель загружена
     if (m_yolo11Segm && m_yolo11Segm->isModelLoaded()) {
-        QVector<ONNXInference::SegmentationResult> results = 
-            m_yolo11Segm->segmentImage(imagePath);
-        
-        for (const auto &result : results) {
-            // Фильтруем только яблоки (класс 47 в COCO датасете)
-            if (result.detection.className.toLower().contains("apple") || 
-                result.detection.classId == 47) {
-                detections.append(result.detection.bbox);
+        appendAppleInstances(runYOLO11(image), image.rect(), apples);
+
+        if (!apples.isEmpty()) {
+            qDebug() << "Found" << apples.size() << "apples using YOLO11-segm";
+            return apples;
+        }
+    }
+
+    return detectFallbackInstances(image, imageName);
+}
+
+QVector<QVector<ImageProcessor::AppleInstance>> ImageProcessor::detectAppleInstancesBatch(
+    const QVector<QImage> &images, const QStringList &imageNames, QVector<bool> &detected)
+{
+    QVector<QVector<AppleInstance>> results(images.size());
+    detected = QVector<bool>(images.size(), false);
+    const bool yolo11 = m_yolo11Segm && m_yolo11Segm->isModelLoaded();
+
+    // Батч собирается только для модели с динамической размерностью батча;
+    // изображения для тайлового инференса идут отдельно своими тайлами
+    QVector<int> batchIndices;
+    QVector<QImage> batchImages;
+    if (yolo11 && m_tilingOptions.batched) {
+        const int tileLimit = std::max(m_tilingOptions.tileSize, m_tilingOptions.minImageSide);
+        for (int i = 0; i < images.size(); ++i) {
+            const QImage &image = images[i];
+            if (image.isNull() || (m_tiledInference && std::max(image.width(), image.height()) > tileLimit)) {
+                continue;
             }
+            batchIndices.append(i);
+            batchImages.append(image);
         }
-        
-        if (!detections.isEmpty()) {
-            qDebug() << "Found" << detections.size() << "apples using YOLO11-segm";
-            return detections;
+    }
+
+    // Одиночное изображение вызывающий обработает так же быстро, как и батч
+    if (batchImages.size() < 2) {
+        return results;
+    }
+
+    QVector<QVector<ONNXInference::SegmentationResult>> batchResults =
+        m_yolo11Segm->segmentBatch(batchImages);
+    for (int b = 0; b < batchIndices.size() && b < batchResults.size(); ++b) {
+        const int i = batchIndices[b];
+        appendAppleInstances(batchResults[b], images[i].rect(), results[i]);
+        if (results[i].isEmpty()) {
+            results[i] = detectFallbackInstances(images[i], imageNames.value(i));
         }
+        detected[i] = true;
     }
+    qDebug() << "[ImageProcessor::detectAppleInstancesBatch] ✓" << batchImages.size()
+             << "images in one YOLO11-segm call";
+
+    return results;
+}
+
+QVector<ImageProcessor::AppleInstance> ImageProcessor::detectFallbackInstances(const QImage &image,
+                                                                              const QString &imageName)
+{
+    QVector<AppleInstance> apples;
 
     // Пробуем использовать YOLACT если модель загружена
     if (m_yolact && m_yolact->isModelLoaded()) {
-        QVector<ONNXInference::SegmentationResult> results = 
-            m_yolact->segmentImage(imagePath);
-        
-        for (const auto &result : results) {
-            if (result.detection.className.toLower().contains("apple") || 
-                result.detection.classId == 47) {
-                detections.append(result.detection.bbox);
-            }
-        }
-        
-        if (!detections.isEmpty()) {
-            qDebug() << "Found" << detections.size() << "apples using YOLACT";
-            return detections;
+        appendAppleInstances(m_yolact->segmentImage(image), image.rect(), apples);
+
+        if (!apples.isEmpty()) {
+            qDebug() << "Found" << apples.size() << "apples using YOLACT";
+            return apples;
         }
     }
 
     // Fallback: используем аннотации из labelme если есть
-    QString imageName = QFileInfo(imagePath).fileName();
-
-    if (m_annotations.contains(imageName)) {
-        const auto &annotation = m_annotations[imageName];
+    auto it = imageName.isEmpty() ? m_annotations.constEnd() : m_annotations.constFind(imageName);
+    if (it != m_annotations.constEnd()) {
+        const auto &annotation = it.value();
 
         for (const auto &polygon : annotation.polygons) {
             if (polygon.label.toLower() == "apple") {
-                detections.append(polygon.boundingBox);
+                AppleInstance apple;
+                apple.bbox = polygon.boundingBox.toAlignedRect().intersected(image.rect());
+                apple.polygon = polygon;
+                apples.append(apple);
             }
         }
 
-        qDebug() << "Found" << detections.size() << "apples from annotations";
+        qDebug() << "Found" << apples.size() << "apples from annotations";
     }
 
-    return detections;
+    return apples;
 }
 
 bool ImageProcessor::loadYOLO11Model(const QString &modelPath)
@@ -294,6 +396,8 @@ bool ImageProcessor::loadYOLO11Model(const QString &modelPath)
     if (!m_yolo11Segm) {
         m_yolo11Segm = new YOLO11Segmentation();
     }
+    m_yolo11Segm->setInputSize(detectorInputSize());
+    m_yolo11Segm->setIntraOpThreads(m_intraOpThreads);
     
     return m_yolo11Segm->loadModel(modelPath);
 }
@@ -305,18 +409,85 @@ bool ImageProcessor::loadYOLACTModel(const QString &modelPath)
     if (!m_yolact) {
         m_yolact = new YOLACTInference();
     }
+    m_yolact->setIntraOpThreads(m_intraOpThreads);
     
     return m_yolact->loadModel(modelPath);
 }
 
+bool ImageProcessor::hasDetectionModel() const
+{
+    return (m_yolo11Segm && m_yolo11Segm->isModelLoaded())
+        || (m_yolact && m_yolact->isModelLoaded());
+}
+
+bool ImageProcessor::detectorDecides() const
+{
+    return hasDetectionModel() && ONNXInference::runtimeAvailable();
+}
+
+void ImageProcessor::setDetectorInputSize(int size)
+{
+    if (detectorInputSize() == size) {
+        return;
+    }
+
+    m_detectorInputSize.store(size);
+
+    // YOLACT экспортируется с фиксированным входом 550, меняем только YOLO11
+    if (m_yolo11Segm) {
+        m_yolo11Segm->setInputSize(size);
+    }
+
+    qDebug() << "Detector input size set to:" << size;
+}
+
+QSize ImageProcessor::requiredFrameSize(bool multiApple) const
+{
+    // Признаки берутся из центральных 60% кадра (или рамки яблока) с масштабом до IMAGE_SIZE
+    const int featureSide = static_cast<int>(std::ceil(IMAGE_SIZE / 0.6));
+    int longSide = std::max(detectorInputSize(), featureSide);
+    int shortSide = featureSide;
+
+    if (multiApple) {
+        longSide = std::max(longSide, static_cast<int>(std::ceil(featureSide / MULTI_APPLE_MIN_FRACTION)));
+    }
+
+    // Детекция нескольких яблок идёт по полному кадру: тайлы нарезаются
+    // только из кадра крупнее порога тайлинга
+    if (multiApple && m_tiledInference) {
+        longSide = std::max(longSide, std::max(m_tilingOptions.tileSize, m_tilingOptions.minImageSide) + 1);
+    }
+
+    // Крупный кадр камеры - 16:9, меньшая сторона растёт вместе с большей
+    shortSide = std::max(shortSide, longSide * 9 / 16);
+    return QSize(longSide, shortSide);
+}
+
 QVector<ONNXInference::SegmentationResult> ImageProcessor::segmentWithYOLO11(const QString &imagePath)
 {
     if (!m_yolo11Segm || !m_yolo11Segm->isModelLoaded()) {
         qWarning() << "YOLO11-segm model not loaded";
         return QVector<ONNXInference::SegmentationResult>();
     }
+
+    QImage image(imagePath);
+    if (image.isNull()) {
+        qWarning() << "Failed to load image:" << imagePath;
+        return QVector<ONNXInference::SegmentationResult>();
+    }
     
-    return m_yolo11Segm->segmentImage(imagePath);
+    return runYOLO11(image);
+}
+
+QVector<ONNXInference::SegmentationResult> ImageProcessor::runYOLO11(const QImage &image)
+{
+    // Крупные снимки (например, ящик яблок 4000x3000) режем на тайлы,
+    // иначе после letterbox до 640 каждое яблоко занимает ~10 пикселей
+    if (m_tiledInference) {
+        return m_yolo11Segm->segmentImageTiled(image, m_tilingOptions);
+    }
+
+    return m_yolo11Segm->segmentImage(image);
 }
 
 QVector<ONNXInference::SegmentationResult> ImageProcessor::segmentWithYOLACT(const QString &imagePath)
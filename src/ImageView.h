@@ -0,0 +1,32 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <QImage>
+#include <QRect>
+
+/**
+ * @brief Возвращает область изображения без копирования пикселей
+ *
+ * Результат ссылается на буфер исходного изображения (только чтение),
+ * поэтому исходное изображение должно жить дольше представления.
+ * Для форматов с палитрой или менее 8 бит на пиксель делается копия.
+ */
+inline QImage imageCropView(const QImage &image, const QRect &rect)
+{
+    QRect area = rect.intersected(image.rect());
+    if (area.isEmpty()) {
+        return QImage();
+    }
+
+    if (image.depth() < 8 || image.format() == QImage::Format_Indexed8) {
+        return image.copy(area);
+    }
+
+    const uchar *origin = image.constBits()
+                        + area.y() * image.bytesPerLine()
+                        + area.x() * (image.depth() / 8);
+
+    return QImage(origin, area.width(), area.height(), image.bytesPerLine(), image.format());
+}
+
+#endif // IMAGEVIEW_H
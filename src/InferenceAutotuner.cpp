@@ -0,0 +1,374 @@
+#include "InferenceAutotuner.h"
+#include "YOLO11Segmentation.h"
+#include "YOLACTInference.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+InferenceAutotuner::InferenceAutotuner(const QString &modelDir, const QString &datasetDir)
+    : m_modelDir(modelDir)
+    , m_datasetDir(datasetDir)
+    , m_accuracyFloor(0.5)
+    , m_sampleCount(4)
+{
+}
+
+QString InferenceAutotuner::modelFileName(ModelKind model, ONNXInference::Precision precision)
+{
+    QString base = (model == YOLO11) ? QStringLiteral("yolo11n-seg") : QStringLiteral("yolact");
+
+    switch (precision) {
+    case ONNXInference::FP16:
+        return base + "-fp16.onnx";
+    case ONNXInference::INT8:
+        return base + "-int8.onnx";
+    case ONNXInference::FP32:
+    default:
+        return base + ".onnx";
+    }
+}
+
+QVector<InferenceAutotuner::Profile> InferenceAutotuner::candidates() const
+{
+    QVector<Profile> result;
+
+    // Варианты числа потоков: 1, 2 и все ядра
+    QVector<int> threadOptions;
+    int ideal = std::max(1, QThread::idealThreadCount());
+    for (int threads : { 1, 2, ideal }) {
+        if (threads <= ideal && !threadOptions.contains(threads)) {
+            threadOptions.append(threads);
+        }
+    }
+
+    const ModelKind models[] = { YOLO11, YOLACT };
+    const ONNXInference::Precision precisions[] = {
+        ONNXInference::FP32, ONNXInference::FP16, ONNXInference::INT8
+    };
+
+    for (ModelKind model : models) {
+        // YOLACT экспортируется с фиксированным входом 550
+        QVector<int> sizes;
+        if (model == YOLO11) {
+            sizes << 640 << 480 << 320;
+        } else {
+            sizes << 550;
+        }
+
+        for (ONNXInference::Precision precision : precisions) {
+            QString modelPath = QDir(m_modelDir).absoluteFilePath(modelFileName(model, precision));
+            if (!QFileInfo::exists(modelPath)) {
+                continue;
+            }
+
+            for (int threads : threadOptions) {
+                for (int size : sizes) {
+                    Profile profile;
+                    profile.model = model;
+                    profile.precision = precision;
+                    profile.threads = threads;
+                    profile.inputSize = size;
+                    profile.modelPath = modelPath;
+                    result.append(profile);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+InferenceAutotuner::Profile InferenceAutotuner::run(const std::function<void(int, int)> &progress,
+                                                    const CancellationToken &token)
+{
+    qDebug() << "[InferenceAutotuner::run] ========== AUTOTUNE STARTED ==========";
+
+    Profile best;
+    QVector<Profile> profiles = candidates();
+    if (profiles.isEmpty()) {
+        qWarning() << "[InferenceAutotuner::run] ⚠ No ONNX models found in" << m_modelDir;
+        return best;
+    }
+
+    QVector<Sample> samples = loadSamples();
+    if (samples.isEmpty()) {
+        qWarning() << "[InferenceAutotuner::run] ⚠ No annotated sample images in" << m_datasetDir;
+        return best;
+    }
+
+    qDebug() << "[InferenceAutotuner::run] Candidates:" << profiles.size()
+             << "samples:" << samples.size() << "accuracy floor:" << m_accuracyFloor;
+
+    for (int i = 0; i < profiles.size(); ++i) {
+        Profile &profile = profiles[i];
+        benchmark(profile, samples, token);
+
+        if (token.isCancelled()) {
+            qDebug() << "[InferenceAutotuner::run] Cancelled";
+            return Profile();
+        }
+
+        if (progress) {
+            progress(i + 1, profiles.size());
+        }
+
+        if (profile.valid) {
+            qDebug() << "[InferenceAutotuner::run]" << profile.description();
+        }
+    }
+
+    // Конфигурация ниже порога не выбирается: остаётся текущая или эвристика
+    best = selectProfile(profiles, m_accuracyFloor);
+    if (best.valid) {
+        qDebug() << "[InferenceAutotuner::run] ✅ Selected:" << best.description();
+    } else {
+        qWarning() << "[InferenceAutotuner::run] ⚠ No configuration meets the accuracy floor";
+    }
+
+    return best;
+}
+
+QVector<InferenceAutotuner::Sample> InferenceAutotuner::loadSamples() const
+{
+    QVector<Sample> samples;
+
+    QDir imageDir(QDir(m_datasetDir).absoluteFilePath("Training"));
+    SegmentationData segData;
+    QMap<QString, SegmentationData::ImageAnnotation> annotations =
+        segData.loadFromDirectory(QDir(m_datasetDir).absoluteFilePath("labelme"));
+
+    QStringList imageFiles = imageDir.entryList(QStringList() << "*.jpg" << "*.png",
+                                                QDir::Files, QDir::Name);
+
+    for (const QString &imageFile : imageFiles) {
+        if (samples.size() >= m_sampleCount) {
+            break;
+        }
+
+        if (!annotations.contains(imageFile)) {
+            continue;
+        }
+
+        Sample sample;
+        sample.image = QImage(imageDir.absoluteFilePath(imageFile));
+        if (sample.image.isNull()) {
+            continue;
+        }
+
+        for (const SegmentationData::Polygon &polygon : annotations[imageFile].polygons) {
+            if (polygon.label.toLower() == "apple") {
+                sample.appleBoxes.append(polygon.boundingBox);
+            }
+        }
+
+        samples.append(sample);
+    }
+
+    return samples;
+}
+
+void InferenceAutotuner::benchmark(Profile &profile, const QVector<Sample> &samples,
+                                   const CancellationToken &token) const
+{
+    QScopedPointer<YOLO11Segmentation> yolo11;
+    QScopedPointer<YOLACTInference> yolact;
+    ONNXInference *engine = nullptr;
+
+    if (profile.model == YOLO11) {
+        yolo11.reset(new YOLO11Segmentation());
+        engine = yolo11.data();
+    } else {
+        yolact.reset(new YOLACTInference());
+        engine = yolact.data();
+    }
+
+    engine->setIntraOpThreads(profile.threads);
+    engine->setInputSize(profile.inputSize);
+    if (!engine->loadModel(profile.modelPath)) {
+        profile.valid = false;
+        return;
+    }
+
+    auto segment = [&](const QImage &image) {
+        return !yolo11.isNull() ? yolo11->segmentImage(image) : yolact->segmentImage(image);
+    };
+
+    // Прогрев: первый вызов включает выделение буферов сессии
+    segment(samples.first().image);
+
+    QElapsedTimer timer;
+    qint64 totalNs = 0;
+    double f1Sum = 0.0;
+
+    for (const Sample &sample : samples) {
+        if (token.isCancelled()) {
+            profile.valid = false;
+            return;
+        }
+
+        timer.start();
+        QVector<ONNXInference::SegmentationResult> results = segment(sample.image);
+        totalNs += timer.nsecsElapsed();
+
+        QVector<QRectF> apples;
+        for (const ONNXInference::SegmentationResult &result : results) {
+            if (result.detection.className.toLower().contains("apple")
+                || result.detection.classId == 47) {
+                apples.append(result.detection.bbox);
+            }
+        }
+        f1Sum += detectionF1(apples, sample.appleBoxes);
+    }
+
+    profile.latencyMs = totalNs / 1e6 / samples.size();
+    profile.accuracy = f1Sum / samples.size();
+    profile.valid = true;
+}
+
+InferenceAutotuner::Profile InferenceAutotuner::selectProfile(const QVector<Profile> &measured, double accuracyFloor)
+{
+    Profile best;
+    for (const Profile &profile : measured) {
+        if (profile.valid && profile.accuracy >= accuracyFloor
+            && (!best.valid || profile.latencyMs < best.latencyMs)) {
+            best = profile;
+        }
+    }
+    return best;
+}
+
+double InferenceAutotuner::detectionF1(const QVector<QRectF> &detected, const QVector<QRectF> &expected)
+{
+    if (detected.isEmpty() && expected.isEmpty()) {
+        return 1.0;
+    }
+    if (detected.isEmpty() || expected.isEmpty()) {
+        return 0.0;
+    }
+
+    // Жадное сопоставление по IoU >= 0.5
+    QVector<bool> used(expected.size(), false);
+    int matched = 0;
+
+    for (const QRectF &box : detected) {
+        for (int j = 0; j < expected.size(); ++j) {
+            if (used[j]) {
+                continue;
+            }
+
+            QRectF inter = box.intersected(expected[j]);
+            double interArea = inter.width() * inter.height();
+            double unionArea = box.width() * box.height()
+                             + expected[j].width() * expected[j].height() - interArea;
+            if (unionArea > 0 && interArea / unionArea >= 0.5) {
+                used[j] = true;
+                ++matched;
+                break;
+            }
+        }
+    }
+
+    double precision = static_cast<double>(matched) / detected.size();
+    double recall = static_cast<double>(matched) / expected.size();
+    return (precision + recall > 0) ? 2.0 * precision * recall / (precision + recall) : 0.0;
+}
+
+QJsonObject InferenceAutotuner::Profile::toJson() const
+{
+    QJsonObject json;
+    json["version"] = 1;
+    json["model"] = (model == YOLO11) ? QStringLiteral("yolo11") : QStringLiteral("yolact");
+    json["precision"] = static_cast<int>(precision);
+    json["threads"] = threads;
+    json["inputSize"] = inputSize;
+    json["modelPath"] = modelPath;
+    json["latencyMs"] = latencyMs;
+    json["accuracy"] = accuracy;
+    json["idealThreadCount"] = QThread::idealThreadCount();
+    return json;
+}
+
+InferenceAutotuner::Profile InferenceAutotuner::Profile::fromJson(const QJsonObject &json)
+{
+    Profile profile;
+    if (json["version"].toInt() != 1) {
+        return profile;
+    }
+
+    profile.model = (json["model"].toString() == "yolact") ? YOLACT : YOLO11;
+    profile.precision = static_cast<ONNXInference::Precision>(
+        qBound(0, json["precision"].toInt(), static_cast<int>(ONNXInference::INT8)));
+    profile.threads = json["threads"].toInt();
+    profile.inputSize = json["inputSize"].toInt(640);
+    profile.modelPath = json["modelPath"].toString();
+    profile.latencyMs = json["latencyMs"].toDouble();
+    profile.accuracy = json["accuracy"].toDouble();
+    profile.valid = !profile.modelPath.isEmpty();
+    return profile;
+}
+
+QString InferenceAutotuner::Profile::description() const
+{
+    static const char *precisionNames[] = { "FP32", "FP16", "INT8" };
+    return QString("%1 %2, %3 threads, input %4: %5 ms, F1 %6")
+        .arg(model == YOLO11 ? "YOLO11" : "YOLACT")
+        .arg(precisionNames[precision])
+        .arg(threads)
+        .arg(inputSize)
+        .arg(latencyMs, 0, 'f', 1)
+        .arg(accuracy, 0, 'f', 2);
+}
+
+bool InferenceAutotuner::saveProfile(const Profile &profile, const QString &path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[InferenceAutotuner::saveProfile] ❌ Cannot open file for writing:" << path;
+        return false;
+    }
+
+    file.write(QJsonDocument(profile.toJson()).toJson());
+    file.close();
+
+    qDebug() << "[InferenceAutotuner::saveProfile] ✅ Profile saved to:" << path;
+    return true;
+}
+
+InferenceAutotuner::Profile InferenceAutotuner::loadProfile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return Profile();
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    if (!doc.isObject()) {
+        qWarning() << "[InferenceAutotuner::loadProfile] ⚠ Invalid profile file:" << path;
+        return Profile();
+    }
+
+    Profile profile = Profile::fromJson(doc.object());
+    if (profile.valid && !QFileInfo::exists(profile.modelPath)) {
+        qWarning() << "[InferenceAutotuner::loadProfile] ⚠ Model from profile is missing:" << profile.modelPath;
+        profile.valid = false;
+    }
+
+    return profile;
+}
+
+QString InferenceAutotuner::defaultProfilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+           + "/inference_profile.json";
+}
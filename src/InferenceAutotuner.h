@@ -0,0 +1,122 @@
+#ifndef INFERENCEAUTOTUNER_H
+#define INFERENCEAUTOTUNER_H
+
+#include <QString>
+#include <QVector>
+#include <QImage>
+#include <QJsonObject>
+#include <functional>
+#include "CancellationToken.h"
+#include "ONNXInference.h"
+#include "SegmentationData.h"
+
+/**
+ * @brief Автоподбор конфигурации инференса под конкретное устройство
+ *
+ * Прогоняет короткий бенчмарк на нескольких изображениях датасета для каждой
+ * комбинации модели (YOLO11 / YOLACT), точности весов (FP32 / FP16 / INT8),
+ * числа intra-op потоков и размера входа. Выбирает самую быструю
+ * конфигурацию, точность которой не ниже заданного порога.
+ */
+class InferenceAutotuner
+{
+public:
+    enum ModelKind {
+        YOLO11 = 0,
+        YOLACT = 1
+    };
+
+    /**
+     * @brief Конфигурация инференса и результаты её замера
+     */
+    struct Profile {
+        ModelKind model;
+        ONNXInference::Precision precision;
+        int threads;                // Потоки intra-op (0 = по умолчанию)
+        int inputSize;              // Размер входа модели
+        QString modelPath;          // Путь к .onnx файлу
+        double latencyMs;           // Среднее время инференса на изображение
+        double accuracy;            // Средний F1 детекции яблок (IoU >= 0.5)
+        bool valid;
+
+        Profile()
+            : model(YOLO11), precision(ONNXInference::FP32), threads(0), inputSize(640)
+            , latencyMs(0.0), accuracy(0.0), valid(false) {}
+
+        QJsonObject toJson() const;
+        static Profile fromJson(const QJsonObject &json);
+        QString description() const;
+    };
+
+    /**
+     * @param modelDir Директория с файлами .onnx
+     * @param datasetDir Директория датасета (содержит Training/ и labelme/)
+     */
+    InferenceAutotuner(const QString &modelDir, const QString &datasetDir);
+
+    /**
+     * @brief Минимально допустимая точность (F1) конфигурации
+     */
+    void setAccuracyFloor(double floor) { m_accuracyFloor = floor; }
+
+    /**
+     * @brief Число изображений датасета для бенчмарка
+     */
+    void setSampleCount(int count) { m_sampleCount = count; }
+
+    /**
+     * @brief Возвращает конфигурации, для которых есть файлы моделей
+     */
+    QVector<Profile> candidates() const;
+
+    /**
+     * @brief Запускает бенчмарк всех кандидатов
+     * @param progress Колбэк прогресса (номер кандидата, всего кандидатов)
+     * @param token Отмена проверяется между изображениями бенчмарка
+     * @return Самая быстрая конфигурация не ниже порога точности;
+     *         valid == false, если моделей нет, ни одна не проходит порог
+     *         или подбор отменён
+     */
+    Profile run(const std::function<void(int, int)> &progress = std::function<void(int, int)>(),
+                const CancellationToken &token = CancellationToken());
+
+    /**
+     * @brief Имя файла модели для заданного типа и точности
+     */
+    static QString modelFileName(ModelKind model, ONNXInference::Precision precision);
+
+    static bool saveProfile(const Profile &profile, const QString &path);
+    static Profile loadProfile(const QString &path);
+
+    /**
+     * @brief Путь к сохранённому профилю в директории данных приложения
+     */
+    static QString defaultProfilePath();
+
+    /**
+     * @brief Самая быстрая из измеренных конфигураций не ниже порога точности
+     * @return valid == false, если порог не проходит ни одна
+     */
+    static Profile selectProfile(const QVector<Profile> &measured, double accuracyFloor);
+
+    /**
+     * @brief F1 детекции на изображении: сопоставление рамок по IoU >= 0.5
+     */
+    static double detectionF1(const QVector<QRectF> &detected, const QVector<QRectF> &expected);
+
+private:
+    struct Sample {
+        QImage image;
+        QVector<QRectF> appleBoxes;    // Эталонные bbox яблок из labelme
+    };
+
+    QVector<Sample> loadSamples() const;
+    void benchmark(Profile &profile, const QVector<Sample> &samples, const CancellationToken &token) const;
+
+    QString m_modelDir;
+    QString m_datasetDir;
+    double m_accuracyFloor;
+    int m_sampleCount;
+};
+
+#endif // INFERENCEAUTOTUNER_H
@@ -0,0 +1,208 @@
+#include "JobScheduler.h"
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+namespace {
+// Задача планировщика, выполняемая в текущем потоке пула
+thread_local JobScheduler *t_scheduler = nullptr;
+thread_local int t_priority = 0;
+}
+
+JobScheduler::JobScheduler(int maxThreads)
+    : m_maxThreads(qMax(1, maxThreads))
+    , m_totalRunning(0)
+{
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        m_limits[p] = m_maxThreads;
+        m_threadLimits[p] = m_maxThreads;
+        m_jobs[p] = 0;
+        m_running[p] = 0;
+        m_yielded[p] = 0;
+    }
+
+    m_threads.setMaxThreadCount(m_maxThreads);
+}
+
+JobScheduler::~JobScheduler()
+{
+    waitForDone();
+}
+
+void JobScheduler::setLimit(Priority priority, int maxConcurrent)
+{
+    QMutexLocker locker(&m_mutex);
+    m_limits[priority] = qMax(1, maxConcurrent);
+    dispatchLocked();
+    m_changed.wakeAll();
+}
+
+int JobScheduler::limit(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_limits[priority];
+}
+
+void JobScheduler::setThreadLimit(Priority priority, int maxThreads)
+{
+    QMutexLocker locker(&m_mutex);
+    m_threadLimits[priority] = qMax(1, maxThreads);
+    dispatchLocked();
+    m_changed.wakeAll();
+}
+
+int JobScheduler::threadLimit(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_threadLimits[priority];
+}
+
+void JobScheduler::submit(Priority priority, const std::function<void()> &job)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queues[priority].enqueue(job);
+    dispatchLocked();
+}
+
+bool JobScheduler::tryStartHelper(Priority priority, const std::function<void()> &helper)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_yielded[priority] > 0 || higherWaitingLocked(priority) || !hasThreadLocked(priority)) {
+        return false;
+    }
+
+    startLocked(priority, helper, true);
+    return true;
+}
+
+bool JobScheduler::currentJob(JobScheduler **scheduler, Priority *priority)
+{
+    if (!t_scheduler) {
+        return false;
+    }
+    *scheduler = t_scheduler;
+    *priority = static_cast<Priority>(t_priority);
+    return true;
+}
+
+void JobScheduler::checkpoint(Priority priority)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!higherWaitingLocked(priority)) {
+        return;
+    }
+
+    // Отдаём свой поток: пул может запустить ещё один, пока этот ждёт
+    --m_running[priority];
+    --m_totalRunning;
+    ++m_yielded[priority];
+    m_threads.releaseThread();
+    dispatchLocked();
+
+    while (higherWaitingLocked(priority) || !hasThreadLocked(priority)) {
+        m_changed.wait(&m_mutex);
+    }
+
+    --m_yielded[priority];
+    ++m_running[priority];
+    ++m_totalRunning;
+    m_threads.reserveThread();
+
+    // Мог освободиться поток для задач, которые ждали нашего продолжения
+    dispatchLocked();
+}
+
+int JobScheduler::queued(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queues[priority].size();
+}
+
+void JobScheduler::waitForDone()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        bool idle = m_totalRunning == 0;
+        for (int p = 0; p < PRIORITY_COUNT && idle; ++p) {
+            idle = m_queues[p].isEmpty() && m_yielded[p] == 0;
+        }
+        if (idle) {
+            break;
+        }
+        m_changed.wait(&m_mutex);
+    }
+    locker.unlock();
+
+    m_threads.waitForDone();
+}
+
+void JobScheduler::dispatchLocked()
+{
+    for (int p = 0; p < PRIORITY_COUNT; ++p) {
+        Priority priority = static_cast<Priority>(p);
+
+        // Уступившие задачи этого класса продолжаются раньше новых
+        if (m_yielded[p] > 0) {
+            break;
+        }
+
+        while (!m_queues[p].isEmpty() && hasCapacityLocked(priority)) {
+            startLocked(priority, m_queues[p].dequeue(), false);
+        }
+    }
+}
+
+void JobScheduler::startLocked(Priority priority, const std::function<void()> &job, bool helper)
+{
+    if (!helper) {
+        ++m_jobs[priority];
+    }
+    ++m_running[priority];
+    ++m_totalRunning;
+
+    QtConcurrent::run(&m_threads, [this, priority, job, helper]() {
+        // По этим значениям parallelFor в задаче находит её планировщик и класс
+        JobScheduler *outerScheduler = t_scheduler;
+        int outerPriority = t_priority;
+        t_scheduler = this;
+        t_priority = priority;
+
+        job();
+
+        t_scheduler = outerScheduler;
+        t_priority = outerPriority;
+        finished(priority, helper);
+    });
+}
+
+void JobScheduler::finished(Priority priority, bool helper)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!helper) {
+        --m_jobs[priority];
+    }
+    --m_running[priority];
+    --m_totalRunning;
+    dispatchLocked();
+    m_changed.wakeAll();
+}
+
+bool JobScheduler::hasThreadLocked(Priority priority) const
+{
+    return m_totalRunning < m_maxThreads && m_running[priority] < m_threadLimits[priority];
+}
+
+bool JobScheduler::hasCapacityLocked(Priority priority) const
+{
+    return hasThreadLocked(priority) && m_jobs[priority] < m_limits[priority];
+}
+
+bool JobScheduler::higherWaitingLocked(Priority priority) const
+{
+    // Учитываются только задачи, которым не мешает собственный лимит класса
+    for (int p = 0; p < priority; ++p) {
+        if (!m_queues[p].isEmpty() && m_jobs[p] < m_limits[p] && m_running[p] < m_threadLimits[p]) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,122 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <functional>
+
+/**
+ * @brief Планировщик фоновых задач с классами приоритета
+ *
+ * Задачи ставятся в очередь своего класса и запускаются в порядке
+ * приоритета, пока есть свободные потоки и не превышен лимит класса.
+ * Длинные задачи вызывают checkpoint() между стадиями: если более
+ * приоритетная задача ждёт потока, текущая уступает ей свой поток и
+ * продолжает, когда поток освободится.
+ */
+class JobScheduler
+{
+public:
+    enum Priority {
+        INTERACTIVE = 0,    // Анализ по запросу пользователя
+        REALTIME,           // Кадры камеры
+        BATCH,              // Пакетная обработка папок
+        TRAINING,           // Обучение модели
+        PRIORITY_COUNT
+    };
+
+    explicit JobScheduler(int maxThreads = QThread::idealThreadCount());
+    ~JobScheduler();
+
+    /**
+     * @brief Максимум одновременно выполняемых задач класса
+     */
+    void setLimit(Priority priority, int maxConcurrent);
+    int limit(Priority priority) const;
+
+    /**
+     * @brief Максимум потоков класса: задачи вместе с помощниками parallelFor
+     *
+     * По умолчанию не ограничен ничем, кроме общего числа потоков
+     */
+    void setThreadLimit(Priority priority, int maxThreads);
+    int threadLimit(Priority priority) const;
+    int maxThreads() const { return m_maxThreads; }
+
+    void submit(Priority priority, const std::function<void()> &job);
+
+    /**
+     * @brief Выполняет функцию в планировщике (аналог QtConcurrent::run)
+     */
+    template <typename T>
+    QFuture<T> run(Priority priority, const std::function<T()> &job)
+    {
+        QFutureInterface<T> future;
+        future.reportStarted();
+        submit(priority, [future, job]() mutable {
+            T result = job();
+            future.reportResult(result);
+            future.reportFinished();
+        });
+        return future.future();
+    }
+
+    /**
+     * @brief Запускает помощника задачи класса, если для него есть свободный поток
+     *
+     * Помощник не ставится в очередь и не входит в лимит задач класса, только
+     * в лимит потоков. Если потока нет или его ждёт задача более высокого
+     * класса, возвращается false и работу делает сама задача.
+     */
+    bool tryStartHelper(Priority priority, const std::function<void()> &helper);
+
+    /**
+     * @brief Планировщик и класс задачи, выполняемой в текущем потоке
+     * @return false, если поток не выполняет задачу планировщика
+     */
+    static bool currentJob(JobScheduler **scheduler, Priority *priority);
+
+    /**
+     * @brief Точка вытеснения: уступает поток ожидающей задаче более высокого класса
+     *
+     * Вызывается только из задачи этого планировщика с её классом приоритета
+     */
+    void checkpoint(Priority priority);
+
+    /**
+     * @brief Задачи класса в очереди (ещё не запущенные)
+     */
+    int queued(Priority priority) const;
+
+    void waitForDone();
+
+private:
+    Q_DISABLE_COPY(JobScheduler)
+
+    void dispatchLocked();
+    void startLocked(Priority priority, const std::function<void()> &job, bool helper);
+    void finished(Priority priority, bool helper);
+    bool hasThreadLocked(Priority priority) const;
+    bool hasCapacityLocked(Priority priority) const;
+    bool higherWaitingLocked(Priority priority) const;
+
+    const int m_maxThreads;
+    QThreadPool m_threads;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_changed;
+    QQueue<std::function<void()>> m_queues[PRIORITY_COUNT];
+    int m_limits[PRIORITY_COUNT];
+    int m_threadLimits[PRIORITY_COUNT];
+    int m_jobs[PRIORITY_COUNT];         // Выполняемые задачи (без помощников)
+    int m_running[PRIORITY_COUNT];      // Занятые потоки: задачи и помощники
+    int m_yielded[PRIORITY_COUNT];      // Уступившие поток и ждущие продолжения
+    int m_totalRunning;
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,85 @@
+#include "LumaBuffer.h"
+#include "CameraFrame.h"
+#include <algorithm>
+
+namespace {
+const int MAX_BLOCK_SAMPLES = 4;        // Не более 4x4 отсчётов на блок
+}
+
+LumaBuffer LumaBuffer::fromFrame(const CameraFrame &frame, int maxSide)
+{
+    LumaBuffer buffer;
+
+    const QSize size = frame.size();
+    if (frame.isNull() || size.isEmpty() || maxSide <= 0) {
+        return buffer;
+    }
+
+    const double scale = std::min(1.0, double(maxSide) / std::max(size.width(), size.height()));
+    buffer.width = std::max(1, qRound(size.width() * scale));
+    buffer.height = std::max(1, qRound(size.height() * scale));
+    buffer.pixels.resize(buffer.width * buffer.height);
+
+    const bool yuv = frame.isYuv();
+
+    for (int by = 0; by < buffer.height; ++by) {
+        const int y0 = by * size.height() / buffer.height;
+        const int y1 = std::max(y0 + 1, (by + 1) * size.height() / buffer.height);
+        const int yStep = std::max(1, (y1 - y0) / MAX_BLOCK_SAMPLES);
+
+        for (int bx = 0; bx < buffer.width; ++bx) {
+            const int x0 = bx * size.width() / buffer.width;
+            const int x1 = std::max(x0 + 1, (bx + 1) * size.width() / buffer.width);
+            const int xStep = std::max(1, (x1 - x0) / MAX_BLOCK_SAMPLES);
+
+            // Среднее по разреженной сетке блока сглаживает шум сенсора
+            int sum = 0;
+            int count = 0;
+            for (int y = y0; y < y1; y += yStep) {
+                for (int x = x0; x < x1; x += xStep) {
+                    sum += yuv ? YuvFrame::fullRangeLuma(frame.yuv.luma(x, y))
+                               : qGray(frame.image.pixel(x, y));
+                    ++count;
+                }
+            }
+
+            buffer.pixels[by * buffer.width + bx] = static_cast<uchar>(sum / count);
+        }
+    }
+
+    return buffer;
+}
+
+LumaBuffer LumaBuffer::downscaled(int maxSide) const
+{
+    if (isNull() || maxSide <= 0 || std::max(width, height) <= maxSide) {
+        return *this;
+    }
+
+    LumaBuffer buffer;
+    const double scale = double(maxSide) / std::max(width, height);
+    buffer.width = std::max(1, qRound(width * scale));
+    buffer.height = std::max(1, qRound(height * scale));
+    buffer.pixels.resize(buffer.width * buffer.height);
+
+    for (int by = 0; by < buffer.height; ++by) {
+        const int y0 = by * height / buffer.height;
+        const int y1 = std::max(y0 + 1, (by + 1) * height / buffer.height);
+
+        for (int bx = 0; bx < buffer.width; ++bx) {
+            const int x0 = bx * width / buffer.width;
+            const int x1 = std::max(x0 + 1, (bx + 1) * width / buffer.width);
+
+            int sum = 0;
+            for (int y = y0; y < y1; ++y) {
+                for (int x = x0; x < x1; ++x) {
+                    sum += at(x, y);
+                }
+            }
+
+            buffer.pixels[by * buffer.width + bx] = static_cast<uchar>(sum / ((y1 - y0) * (x1 - x0)));
+        }
+    }
+
+    return buffer;
+}
@@ -0,0 +1,41 @@
+#ifndef LUMABUFFER_H
+#define LUMABUFFER_H
+
+#include <QtGlobal>
+#include <vector>
+
+struct CameraFrame;
+
+/**
+ * @brief Уменьшенная копия яркости кадра (0..255, 8 бит на пиксель)
+ *
+ * Дешёвый вход для быстрых проверок кадра (смена сцены, качество)
+ * без конвертации всего кадра в RGB.
+ */
+struct LumaBuffer
+{
+    int width;
+    int height;
+    std::vector<uchar> pixels;
+
+    LumaBuffer() : width(0), height(0) {}
+
+    bool isNull() const { return pixels.empty(); }
+    uchar at(int x, int y) const { return pixels[y * width + x]; }
+
+    /**
+     * @brief Уменьшает кадр усреднением блоков
+     * @param maxSide Большая сторона результата (меньшая - по пропорциям кадра)
+     */
+    static LumaBuffer fromFrame(const CameraFrame &frame, int maxSide);
+
+    /**
+     * @brief Уменьшенная копия этого буфера (усреднение всех пикселей блока)
+     *
+     * Позволяет построить из одного буфера кадра входы разных размеров
+     * вместо повторного обхода кадра.
+     */
+    LumaBuffer downscaled(int maxSide) const;
+};
+
+#endif // LUMABUFFER_H
@@ -2,6 +2,7 @@
 #include <QDebug>
 #include <QPainter>
 #include <QFileInfo>
+#include <QFile>
 #include <cmath>
 #include <algorithm>
 
@@ -13,6 +14,8 @@
 
 ONNXInference::ONNXInference()
     : m_modelLoaded(false)
+    , m_inputSize(640)
+    , m_intraOpThreads(0)
 {
 }
 
@@ -20,6 +23,11 @@ ONNXInference::~ONNXInference()
 {
 }
 
+bool ONNXInference::runtimeAvailable()
+{
+    return ONNXRUNTIME_AVAILABLE != 0;
+}
+
 bool ONNXInference::loadModel(const QString &modelPath)
 {
     m_modelPath = modelPath;
@@ -31,24 +39,58 @@ bool ONNXInference::loadModel(const QString &modelPath)
         return false;
     }
 
+    QFile file(modelPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open ONNX model file:" << modelPath;
+        m_modelLoaded = false;
+        return false;
+    }
+
+    // Веса читаются один раз; контексты (createContext) разделяют их
+    std::shared_ptr<ModelWeights> weights = std::make_shared<ModelWeights>();
+    weights->modelPath = modelPath;
+    weights->modelData = file.readAll();
+    weights->intraOpThreads = m_intraOpThreads;
+    file.close();
+
     // TODO: Реальная загрузка ONNX модели через ONNX Runtime
     // Ort::Env env;
-    // Ort::Session session(env, modelPath.toStdString().c_str(), ...);
+    // Ort::SessionOptions options;
+    // if (m_intraOpThreads > 0) options.SetIntraOpNumThreads(m_intraOpThreads);
+    // weights->session = Ort::Session(env, weights->modelData.constData(),
+    //                                 weights->modelData.size(), options);
     
-    qDebug() << "ONNX model loading placeholder for:" << modelPath;
+    qDebug() << "ONNX model loading placeholder for:" << modelPath
+             << "(" << weights->modelData.size() << "bytes )";
     qDebug() << "Note: Full ONNX Runtime integration required";
     
+    m_weights = weights;
     m_modelLoaded = true;
     return true;
 }
 
+void ONNXInference::shareWeightsFrom(const ONNXInference &other)
+{
+    m_weights = other.m_weights;
+    m_modelLoaded = other.m_modelLoaded;
+    m_modelPath = other.m_modelPath;
+    m_inputSize = other.m_inputSize;
+    m_intraOpThreads = other.m_intraOpThreads;
+}
+
 std::vector<float> ONNXInference::preprocessImage(const QImage &image, int targetSize)
 {
     std::vector<float> preprocessed;
-    
+    preprocessImageInto(image, targetSize, preprocessed);
+    return preprocessed;
+}
+
+void ONNXInference::preprocessImageInto(const QImage &image, int targetSize, std::vector<float> &output)
+{
     if (image.isNull()) {
         qWarning() << "Cannot preprocess null image";
-        return preprocessed;
+        output.clear();
+        return;
     }
 
     // Letterbox resize (сохраняет соотношение сторон)
@@ -59,28 +101,26 @@ std::vector<float> ONNXInference::preprocessImage(const QImage &image, int targe
     // Конвертируем в RGB если нужно
     QImage rgbImage = resized.convertToFormat(QImage::Format_RGB888);
 
-    // Размер: [1, 3, targetSize, targetSize]
-    preprocessed.resize(1 * 3 * targetSize * targetSize);
+    // Размер: [1, 3, targetSize, targetSize]; ёмкость буфера переиспользуется между кадрами
+    const size_t plane = static_cast<size_t>(targetSize) * targetSize;
+    output.resize(3 * plane);
+
+    float *red = output.data();
+    float *green = red + plane;
+    float *blue = green + plane;
 
     // Нормализация: [0, 255] -> [0, 1]
     // И перестановка: HWC -> CHW
-    int idx = 0;
-    for (int c = 0; c < 3; ++c) {
-        for (int y = 0; y < targetSize; ++y) {
-            for (int x = 0; x < targetSize; ++x) {
-                QRgb pixel = rgbImage.pixel(x, y);
-                float value = 0.0f;
-                
-                if (c == 0) value = qRed(pixel) / 255.0f;      // R
-                else if (c == 1) value = qGreen(pixel) / 255.0f; // G
-                else value = qBlue(pixel) / 255.0f;              // B
-                
-                preprocessed[idx++] = value;
-            }
+    const float norm = 1.0f / 255.0f;
+    for (int y = 0; y < targetSize; ++y) {
+        const uchar *line = rgbImage.constScanLine(y);
+        const size_t row = static_cast<size_t>(y) * targetSize;
+        for (int x = 0; x < targetSize; ++x) {
+            red[row + x] = line[3 * x] * norm;
+            green[row + x] = line[3 * x + 1] * norm;
+            blue[row + x] = line[3 * x + 2] * norm;
         }
     }
-
-    return preprocessed;
 }
 
 QImage ONNXInference::letterboxImage(const QImage &image, int targetSize, 
@@ -5,6 +5,7 @@
 #include <QImage>
 #include <QVector>
 #include <QRectF>
+#include <QByteArray>
 #include <vector>
 #include <memory>
 
@@ -17,6 +18,15 @@
 class ONNXInference
 {
 public:
+    /**
+     * @brief Точность весов модели (определяется файлом .onnx)
+     */
+    enum Precision {
+        FP32 = 0,
+        FP16 = 1,
+        INT8 = 2
+    };
+
     struct Detection {
         QRectF bbox;                    // Bounding box
         float confidence;               // Уверенность детекции
@@ -24,10 +34,23 @@ public:
         QString className;              // Имя класса
     };
 
+    /**
+     * @brief Загруженные веса модели
+     *
+     * Загружаются один раз и разделяются всеми контекстами только для чтения.
+     * Ort::Session::Run потокобезопасен, поэтому сессия тоже будет храниться здесь.
+     */
+    struct ModelWeights {
+        QString modelPath;
+        QByteArray modelData;           // Содержимое .onnx файла
+        int intraOpThreads;             // Потоки intra-op, с которыми создана сессия
+    };
+
     struct SegmentationResult {
         Detection detection;             // Детекция с bbox
         QImage mask;                    // Маска сегментации
         QVector<QPointF> polygon;       // Полигон из маски
+        QPoint maskOffset;              // Положение маски на изображении (если маска покрывает только bbox)
     };
 
     ONNXInference();
@@ -40,11 +63,50 @@ public:
      */
     virtual bool loadModel(const QString &modelPath);
 
+    /**
+     * @brief Создаёт лёгкий контекст инференса с общими весами
+     *
+     * Контекст разделяет с исходным объектом загруженные веса, но имеет
+     * собственные буферы, поэтому каждый поток должен работать со своим
+     * контекстом. Модель при этом не загружается повторно.
+     */
+    virtual ONNXInference *createContext() const = 0;
+
+    /**
+     * @brief Общие веса модели (nullptr, если модель не загружена)
+     */
+    std::shared_ptr<const ModelWeights> weights() const { return m_weights; }
+
     /**
      * @brief Проверяет, загружена ли модель
      */
     bool isModelLoaded() const { return m_modelLoaded; }
 
+    /**
+     * @brief Собран ли проект с ONNX Runtime
+     *
+     * Без него runInference - заглушка и детекций не возвращает,
+     * поэтому решения по загруженной модели принимать нельзя
+     */
+    static bool runtimeAvailable();
+
+    /**
+     * @brief Устанавливает размер входа модели (targetSize для preprocessImage)
+     */
+    void setInputSize(int size) { m_inputSize = size; }
+
+    /**
+     * @brief Возвращает текущий размер входа модели
+     */
+    int inputSize() const { return m_inputSize; }
+
+    /**
+     * @brief Число потоков внутри оператора (intra-op) для сессии ONNX Runtime
+     * @param threads 0 = выбор ONNX Runtime по умолчанию. Применяется при loadModel()
+     */
+    void setIntraOpThreads(int threads) { m_intraOpThreads = threads; }
+    int intraOpThreads() const { return m_intraOpThreads; }
+
     /**
      * @brief Предобрабатывает изображение для модели
      * @param image Входное изображение
@@ -53,6 +115,11 @@ public:
      */
     std::vector<float> preprocessImage(const QImage &image, int targetSize = 640);
 
+    /**
+     * @brief Предобрабатывает изображение в переданный буфер (без новых выделений памяти)
+     */
+    void preprocessImageInto(const QImage &image, int targetSize, std::vector<float> &output);
+
     /**
      * @brief Выполняет инференс модели
      * @param inputData Предобработанные данные
@@ -77,8 +144,24 @@ public:
         float confThreshold = 0.25f) = 0;
 
 protected:
+    /**
+     * @brief Буферы одного контекста; не разделяются между потоками
+     */
+    struct ScratchBuffers {
+        std::vector<float> input;       // Входной тензор [1, 3, H, W]
+    };
+
+    /**
+     * @brief Делает объект контекстом модели other (общие веса и настройки)
+     */
+    void shareWeightsFrom(const ONNXInference &other);
+
+    std::shared_ptr<const ModelWeights> m_weights;
+    ScratchBuffers m_scratch;
     bool m_modelLoaded;
     QString m_modelPath;
+    int m_inputSize;                    // Размер входа модели (стороны квадрата)
+    int m_intraOpThreads;               // Потоки intra-op для сессии (0 = по умолчанию)
     
     // Вспомогательные методы
     QImage letterboxImage(const QImage &image, int targetSize, 
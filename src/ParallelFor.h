@@ -0,0 +1,114 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <functional>
+#include <algorithm>
+#include "JobScheduler.h"
+
+namespace ParallelDetail {
+
+// Общее состояние одного вызова parallelFor: счётчик индексов и семафор завершения
+struct State
+{
+    State(int n, const std::function<void(int)> &f)
+        : count(n), body(f), scheduler(nullptr), priority(JobScheduler::INTERACTIVE), next(0) {}
+
+    void run()
+    {
+        int index;
+        bool first = true;
+        while ((index = next.fetchAndAddRelaxed(1)) < count) {
+            // Между элементами поток уступает задачам более высокого класса
+            if (scheduler && !first) {
+                scheduler->checkpoint(priority);
+            }
+            first = false;
+            body(index);
+        }
+    }
+
+    const int count;
+    const std::function<void(int)> &body;
+    JobScheduler *scheduler;
+    JobScheduler::Priority priority;
+    QAtomicInt next;
+    QSemaphore done;
+};
+
+class Helper : public QRunnable
+{
+public:
+    explicit Helper(State *state) : m_state(state) { setAutoDelete(true); }
+
+    void run() override
+    {
+        m_state->run();
+        m_state->done.release();
+    }
+
+private:
+    State *m_state;
+};
+
+} // namespace ParallelDetail
+
+/**
+ * @brief Выполняет body(i) для всех i из [0, count) на пуле потоков
+ *
+ * Вызывающий поток участвует в работе наравне с помощниками, а помощники
+ * занимают только свободные потоки пула (tryStart). Поэтому вызов можно
+ * делать изнутри задачи того же пула — взаимной блокировки не будет.
+ * Изнутри задачи JobScheduler помощники запускаются в планировщике с классом
+ * этой задачи: они входят в лимит потоков класса, и между элементами
+ * все потоки проходят checkpoint().
+ * Индексы раздаются по одному, что выравнивает нагрузку при разной
+ * стоимости элементов. body не должен выбрасывать исключения.
+ *
+ * @param maxWorkers Максимум потоков, включая вызывающий (0 = по числу ядер)
+ */
+inline void parallelFor(int count, const std::function<void(int)> &body,
+                        int maxWorkers = 0, QThreadPool *pool = QThreadPool::globalInstance())
+{
+    if (count <= 0) {
+        return;
+    }
+
+    int workers = (maxWorkers > 0) ? maxWorkers : QThread::idealThreadCount();
+    workers = std::max(1, std::min(workers, count));
+
+    ParallelDetail::State state(count, body);
+    ParallelDetail::State *shared = &state;
+
+    int started = 0;
+    if (JobScheduler::currentJob(&state.scheduler, &state.priority)) {
+        for (int i = 1; i < workers; ++i) {
+            if (!state.scheduler->tryStartHelper(state.priority, [shared]() {
+                    shared->run();
+                    shared->done.release();
+                })) {
+                break;
+            }
+            ++started;
+        }
+        pool = nullptr;
+    }
+
+    for (int i = 1; i < workers && pool; ++i) {
+        ParallelDetail::Helper *helper = new ParallelDetail::Helper(&state);
+        if (!pool->tryStart(helper)) {
+            delete helper;
+            break;
+        }
+        ++started;
+    }
+
+    state.run();
+    state.done.acquire(started);
+}
+
+#endif // PARALLELFOR_H
@@ -0,0 +1,109 @@
+#include "RealtimeBenchmark.h"
+#include "AppleDetector.h"
+#include "FrameReplaySource.h"
+#include <QDebug>
+#include <algorithm>
+
+RealtimeBenchmark::RealtimeBenchmark(AppleDetector *detector, FrameReplaySource *source, QObject *parent)
+    : QObject(parent)
+    , m_detector(detector)
+    , m_source(source)
+    , m_wasRealtime(false)
+{
+    m_idleTimer.setInterval(10);
+    connect(&m_idleTimer, &QTimer::timeout, this, &RealtimeBenchmark::checkIdle);
+}
+
+bool RealtimeBenchmark::start()
+{
+    if (!m_detector->modelTrained()) {
+        qWarning() << "[RealtimeBenchmark::start] Model not trained, realtime analysis is disabled";
+        return false;
+    }
+
+    m_latenciesUs.clear();
+    m_latenciesUs.reserve(m_source->frameCount());
+
+    connect(m_detector, &AppleDetector::frameProcessed, this, &RealtimeBenchmark::onFrameProcessed);
+    connect(m_source, &FrameReplaySource::finished, this, &RealtimeBenchmark::onReplayFinished);
+
+    // Счётчики детектора сбрасываются при включении real-time режима
+    m_wasRealtime = m_detector->realtimeAnalysis();
+    m_detector->setRealtimeAnalysis(false);
+    m_detector->setReplaySource(m_source);
+    m_detector->setRealtimeAnalysis(true);
+
+    m_clock.start();
+    m_source->start();
+
+    qDebug() << "[RealtimeBenchmark::start] ✓ Replaying" << m_source->frameCount() << "frames";
+    return true;
+}
+
+void RealtimeBenchmark::onFrameProcessed(qint64 latencyUs)
+{
+    m_latenciesUs.append(latencyUs);
+}
+
+void RealtimeBenchmark::onReplayFinished()
+{
+    // Дожидаемся результатов по уже принятым кадрам
+    m_idleTimer.start();
+}
+
+void RealtimeBenchmark::checkIdle()
+{
+    // Замер окончен, когда судьба каждого выданного кадра известна:
+    // он вытеснен в ящике, пропущен регулятором или его результат опубликован
+    const int settled = m_detector->framesDropped() + m_detector->framesSkipped()
+            + m_detector->framesPublished();
+    if (settled < m_source->deliveredFrames()) {
+        return;
+    }
+    m_idleTimer.stop();
+
+    Report report;
+    report.elapsedSec = m_clock.nsecsElapsed() / 1e9;
+    report.delivered = m_source->deliveredFrames();
+    report.dropped = m_detector->framesDropped();
+    report.processed = m_detector->framesPublished();
+    report.skipped = m_detector->framesSkipped();
+    report.unchanged = m_detector->framesUnchanged();
+    report.rejected = m_detector->framesRejected();
+    report.throughputFps = (report.elapsedSec > 0) ? report.processed / report.elapsedSec : 0.0;
+
+    if (!m_latenciesUs.isEmpty()) {
+        QVector<qint64> sorted = m_latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+
+        qint64 sum = 0;
+        for (qint64 latency : sorted) {
+            sum += latency;
+        }
+        report.meanLatencyMs = sum / 1000.0 / sorted.size();
+        report.p95LatencyMs = sorted[qMin(sorted.size() - 1, int(sorted.size() * 0.95))] / 1000.0;
+        report.maxLatencyMs = sorted.last() / 1000.0;
+    }
+
+    disconnect(m_detector, &AppleDetector::frameProcessed, this, &RealtimeBenchmark::onFrameProcessed);
+    disconnect(m_source, &FrameReplaySource::finished, this, &RealtimeBenchmark::onReplayFinished);
+
+    m_detector->setRealtimeAnalysis(false);
+    m_detector->setReplaySource(nullptr);
+    m_detector->setRealtimeAnalysis(m_wasRealtime);
+
+    qDebug() << "[RealtimeBenchmark::checkIdle] ✓" << report.toString();
+    emit finished(report);
+}
+
+QString RealtimeBenchmark::Report::toString() const
+{
+    return QString("frames: %1 delivered, %2 dropped, %3 skipped, %4 processed "
+                   "(%5 unchanged, %6 rejected); %7 fps; latency mean %8 ms, p95 %9 ms, max %10 ms")
+            .arg(delivered).arg(dropped).arg(skipped).arg(processed)
+            .arg(unchanged).arg(rejected)
+            .arg(throughputFps, 0, 'f', 1)
+            .arg(meanLatencyMs, 0, 'f', 1)
+            .arg(p95LatencyMs, 0, 'f', 1)
+            .arg(maxLatencyMs, 0, 'f', 1);
+}
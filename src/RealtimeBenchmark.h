@@ -0,0 +1,71 @@
+#ifndef REALTIMEBENCHMARK_H
+#define REALTIMEBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QString>
+
+class AppleDetector;
+class FrameReplaySource;
+
+/**
+ * @brief Замер real-time режима на записи кадров (без камеры)
+ *
+ * Подключает FrameReplaySource к AppleDetector вместо камеры, включает
+ * real-time анализ и по окончании записи, когда каждый выданный кадр
+ * вытеснен, пропущен регулятором или опубликован (по счётчикам детектора),
+ * сообщает потери, задержку и пропускную способность.
+ */
+class RealtimeBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Report {
+        int delivered;          // Кадров выдано источником
+        int dropped;            // Вытеснено в ящике до анализа
+        int skipped;            // Пропущено регулятором
+        int processed;          // Опубликовано результатов
+        int unchanged;          // Из них без смены сцены
+        int rejected;           // Из них отброшено проверкой качества
+        double elapsedSec;
+        double throughputFps;
+        double meanLatencyMs;
+        double p95LatencyMs;
+        double maxLatencyMs;
+
+        Report()
+            : delivered(0), dropped(0), skipped(0), processed(0), unchanged(0), rejected(0)
+            , elapsedSec(0.0), throughputFps(0.0), meanLatencyMs(0.0), p95LatencyMs(0.0), maxLatencyMs(0.0) {}
+
+        QString toString() const;
+    };
+
+    RealtimeBenchmark(AppleDetector *detector, FrameReplaySource *source, QObject *parent = nullptr);
+
+    /**
+     * @brief Запускает воспроизведение
+     * @return false если модель не обучена (real-time анализ не запустится)
+     */
+    bool start();
+
+signals:
+    void finished(const RealtimeBenchmark::Report &report);
+
+private slots:
+    void onFrameProcessed(qint64 latencyUs);
+    void onReplayFinished();
+    void checkIdle();
+
+private:
+    AppleDetector *m_detector;
+    FrameReplaySource *m_source;
+    QVector<qint64> m_latenciesUs;
+    QElapsedTimer m_clock;
+    QTimer m_idleTimer;
+    bool m_wasRealtime;
+};
+
+#endif // REALTIMEBENCHMARK_H
@@ -0,0 +1,115 @@
+#include "RealtimeGovernor.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Допустимые размеры входа детектора, от полного качества к минимальному
+const int INPUT_SIZES[] = { 640, 480, 320 };
+const int INPUT_SIZE_COUNT = sizeof(INPUT_SIZES) / sizeof(INPUT_SIZES[0]);
+
+const double SMOOTHING = 0.2;        // Коэффициент экспоненциального сглаживания
+const double OVERLOAD_RATIO = 1.05;  // Превышение бюджета, при котором снижаем качество
+const double HEADROOM_RATIO = 0.85;  // Прогнозная загрузка, при которой повышаем качество
+}
+
+RealtimeGovernor::RealtimeGovernor()
+    : m_targetFps(5.0)
+    , m_averageLatencyMs(0.0)
+    , m_sizeIndex(0)
+    , m_minSizeIndex(0)
+    , m_frameSkip(0)
+    , m_frameCounter(0)
+    , m_samplesSinceChange(0)
+{
+}
+
+void RealtimeGovernor::setTargetFps(double fps)
+{
+    m_targetFps = std::max(0.5, std::min(fps, 60.0));
+    m_samplesSinceChange = 0;
+}
+
+void RealtimeGovernor::setMaxInputSize(int size)
+{
+    m_minSizeIndex = INPUT_SIZE_COUNT - 1;
+    for (int i = 0; i < INPUT_SIZE_COUNT; ++i) {
+        if (INPUT_SIZES[i] <= size) {
+            m_minSizeIndex = i;
+            break;
+        }
+    }
+    m_sizeIndex = std::max(m_sizeIndex, m_minSizeIndex);
+}
+
+bool RealtimeGovernor::shouldProcessFrame()
+{
+    bool process = (m_frameCounter == 0);
+    m_frameCounter = (m_frameCounter + 1) % (m_frameSkip + 1);
+    return process;
+}
+
+bool RealtimeGovernor::reportFrameTime(qint64 elapsedMs)
+{
+    double sample = static_cast<double>(elapsedMs);
+    if (m_averageLatencyMs <= 0.0) {
+        m_averageLatencyMs = sample;
+    } else {
+        m_averageLatencyMs = SMOOTHING * sample + (1.0 - SMOOTHING) * m_averageLatencyMs;
+    }
+
+    if (++m_samplesSinceChange < MIN_SAMPLES) {
+        return false;
+    }
+
+    // Пропуская кадры, мы растягиваем бюджет на (frameSkip + 1) кадров
+    double budget = frameBudgetMs();
+    double allowed = budget * (m_frameSkip + 1);
+    bool changed = false;
+
+    if (m_averageLatencyMs > allowed * OVERLOAD_RATIO) {
+        // Перегрузка: сначала уменьшаем вход детектора, затем пропускаем кадры
+        if (m_sizeIndex < INPUT_SIZE_COUNT - 1) {
+            ++m_sizeIndex;
+            changed = true;
+        } else if (m_frameSkip < MAX_FRAME_SKIP) {
+            ++m_frameSkip;
+            changed = true;
+        }
+    } else if (m_frameSkip > 0) {
+        // Есть запас: сначала перестаём пропускать кадры
+        if (m_averageLatencyMs < budget * m_frameSkip * HEADROOM_RATIO) {
+            --m_frameSkip;
+            changed = true;
+        }
+    } else if (m_sizeIndex > m_minSizeIndex) {
+        // Затем возвращаем разрешение; время инференса растёт примерно с площадью входа
+        double ratio = static_cast<double>(INPUT_SIZES[m_sizeIndex - 1]) / INPUT_SIZES[m_sizeIndex];
+        if (m_averageLatencyMs * ratio * ratio < budget * HEADROOM_RATIO) {
+            --m_sizeIndex;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        m_samplesSinceChange = 0;
+        m_frameCounter = 0;
+        qDebug() << "[RealtimeGovernor] latency" << m_averageLatencyMs << "ms, budget" << budget
+                 << "ms -> input size" << inputSize() << "frame skip" << m_frameSkip;
+    }
+
+    return changed;
+}
+
+int RealtimeGovernor::inputSize() const
+{
+    return INPUT_SIZES[m_sizeIndex];
+}
+
+void RealtimeGovernor::reset()
+{
+    m_averageLatencyMs = 0.0;
+    m_sizeIndex = m_minSizeIndex;
+    m_frameSkip = 0;
+    m_frameCounter = 0;
+    m_samplesSinceChange = 0;
+}
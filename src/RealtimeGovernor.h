@@ -0,0 +1,82 @@
+#ifndef REALTIMEGOVERNOR_H
+#define REALTIMEGOVERNOR_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Регулятор качества для real-time режима
+ *
+ * Измеряет время полного анализа кадра и подстраивает размер входа
+ * детектора (640 / 480 / 320) и коэффициент пропуска кадров так,
+ * чтобы уложиться в бюджет кадра, заданный целевым FPS.
+ * При появлении запаса возвращается к полному качеству.
+ */
+class RealtimeGovernor
+{
+public:
+    RealtimeGovernor();
+
+    /**
+     * @brief Устанавливает целевую частоту анализа (кадров в секунду)
+     */
+    void setTargetFps(double fps);
+    double targetFps() const { return m_targetFps; }
+
+    /**
+     * @brief Бюджет на один анализируемый кадр, мс
+     */
+    double frameBudgetMs() const { return 1000.0 / m_targetFps; }
+
+    /**
+     * @brief Ограничивает максимальный размер входа детектора (полное качество)
+     *
+     * Например, профилем автонастройки, выбравшим вход 480
+     */
+    void setMaxInputSize(int size);
+
+    /**
+     * @brief Решает, нужно ли анализировать очередной кадр (учитывает пропуск кадров)
+     */
+    bool shouldProcessFrame();
+
+    /**
+     * @brief Учитывает время анализа кадра
+     * @param elapsedMs Полное время анализа, мс
+     * @return true если решение регулятора изменилось
+     */
+    bool reportFrameTime(qint64 elapsedMs);
+
+    /**
+     * @brief Текущий размер входа детектора
+     */
+    int inputSize() const;
+
+    /**
+     * @brief Сколько кадров пропускается между анализируемыми
+     */
+    int frameSkip() const { return m_frameSkip; }
+
+    /**
+     * @brief Сглаженное время анализа кадра, мс
+     */
+    double averageLatencyMs() const { return m_averageLatencyMs; }
+
+    /**
+     * @brief Сбрасывает статистику и возвращает полное качество
+     */
+    void reset();
+
+private:
+    static const int MAX_FRAME_SKIP = 4;     // Не более 4 пропущенных кадров подряд
+    static const int MIN_SAMPLES = 5;        // Кадров между изменениями решения
+
+    double m_targetFps;
+    double m_averageLatencyMs;
+    int m_sizeIndex;
+    int m_minSizeIndex;                      // Индекс самого крупного разрешённого входа
+    int m_frameSkip;
+    int m_frameCounter;
+    int m_samplesSinceChange;
+};
+
+#endif // REALTIMEGOVERNOR_H
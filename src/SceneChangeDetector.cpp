@@ -0,0 +1,31 @@
+#include "SceneChangeDetector.h"
+#include <cstdlib>
+
+SceneChangeDetector::SceneChangeDetector()
+    : m_threshold(6.0)
+    , m_lastDifference(0.0)
+{
+}
+
+bool SceneChangeDetector::hasChanged(const LumaBuffer &thumbnail)
+{
+    if (m_reference.isNull() || thumbnail.width != m_reference.width
+            || thumbnail.height != m_reference.height) {
+        m_lastDifference = 255.0;
+        return true;
+    }
+
+    long long sum = 0;
+    for (size_t i = 0; i < thumbnail.pixels.size(); ++i) {
+        sum += std::abs(int(thumbnail.pixels[i]) - int(m_reference.pixels[i]));
+    }
+
+    m_lastDifference = double(sum) / thumbnail.pixels.size();
+    return m_lastDifference > m_threshold;
+}
+
+void SceneChangeDetector::reset()
+{
+    m_reference = LumaBuffer();
+    m_lastDifference = 0.0;
+}
@@ -0,0 +1,53 @@
+#ifndef SCENECHANGEDETECTOR_H
+#define SCENECHANGEDETECTOR_H
+
+#include "LumaBuffer.h"
+
+/**
+ * @brief Детектор смены сцены для real-time режима
+ *
+ * Сравнивает миниатюру яркости 32x32 с миниатюрой последнего
+ * проанализированного кадра по средней абсолютной разнице. Пока сцена
+ * не изменилась сильнее порога, полный анализ можно не запускать.
+ * Опорный кадр обновляется только после анализа, поэтому медленный
+ * дрейф сцены тоже накапливается и в итоге вызывает анализ.
+ */
+class SceneChangeDetector
+{
+public:
+    static const int THUMBNAIL_SIZE = 32;
+
+    SceneChangeDetector();
+
+    /**
+     * @brief Порог средней разницы яркости (уровней из 255)
+     */
+    void setThreshold(double threshold) { m_threshold = threshold; }
+    double threshold() const { return m_threshold; }
+
+    /**
+     * @brief Изменилась ли сцена относительно опорного кадра
+     *
+     * Без опорного кадра сцена всегда считается изменившейся
+     */
+    bool hasChanged(const LumaBuffer &thumbnail);
+
+    /**
+     * @brief Запоминает миниатюру проанализированного кадра
+     */
+    void setReference(const LumaBuffer &thumbnail) { m_reference = thumbnail; }
+
+    /**
+     * @brief Разница последнего сравнения
+     */
+    double lastDifference() const { return m_lastDifference; }
+
+    void reset();
+
+private:
+    LumaBuffer m_reference;
+    double m_threshold;
+    double m_lastDifference;
+};
+
+#endif // SCENECHANGEDETECTOR_H
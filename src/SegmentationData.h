@@ -65,11 +65,15 @@ public:
      */
     static double calculateIoU(const Polygon &p1, const Polygon &p2);
 
+    /**
+     * @brief Вычисляет площадь полигона (формула шнурования)
+     */
+    static double calculatePolygonArea(const QVector<QPointF> &points);
+
 private:
     ImageAnnotation m_annotation;
 
     static QRectF calculateBoundingBox(const QVector<QPointF> &points);
-    static double calculatePolygonArea(const QVector<QPointF> &points);
 };
 
 #endif // SEGMENTATIONDATA_H
@@ -0,0 +1,29 @@
+#ifndef STILLIMAGE_H
+#define STILLIMAGE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+/**
+ * @brief Снимок камеры в памяти
+ *
+ * Камера обычно отдаёт снимок уже сжатым в JPEG: байты передаются
+ * в анализ и на диск как есть, декодируются один раз при анализе.
+ * Если буфер в JPEG не поддерживается, хранится готовое изображение.
+ */
+struct StillImage
+{
+    QByteArray encoded;     // JPEG от камеры
+    QImage image;           // Изображение, если камера не отдаёт JPEG
+    QString filePath;       // Куда снимок сохраняется в фоне
+
+    bool isNull() const { return encoded.isEmpty() && image.isNull(); }
+
+    QImage toImage() const
+    {
+        return image.isNull() ? QImage::fromData(encoded) : image;
+    }
+};
+
+#endif // STILLIMAGE_H
@@ -0,0 +1,182 @@
+#include "ThumbnailProvider.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QUrl>
+#include <QtConcurrent>
+#include <algorithm>
+
+ThumbnailProvider::ThumbnailProvider(const QString &cacheDir)
+    : QQuickImageProvider(QQuickImageProvider::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+    , m_cacheDir(cacheDir)
+    , m_memoryCache(MEMORY_CACHE_KB)
+    , m_diskCacheBytes(0)
+{
+    QDir().mkpath(m_cacheDir);
+
+    // Обход кэша на диске не задерживает запуск приложения
+    m_pruning = QtConcurrent::run([this]() { pruneDiskCache(); });
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+    QMutexLocker locker(&m_mutex);
+    QFuture<void> pruning = m_pruning;
+    locker.unlock();
+
+    pruning.waitForFinished();
+}
+
+QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    QString filePath = QUrl::fromPercentEncoding(id.toUtf8());
+    if (!filePath.startsWith('/')) {
+        filePath.prepend('/');
+    }
+
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        qWarning() << "[ThumbnailProvider::requestImage] File not found:" << filePath;
+        return QImage();
+    }
+
+    const int side = bucketSide(requestedSize);
+    const QString cachePath = diskCachePath(fileInfo, side);
+
+    QImage thumbnail;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (QImage *cached = m_memoryCache.object(cachePath)) {
+            thumbnail = *cached;
+        }
+    }
+
+    if (thumbnail.isNull()) {
+        thumbnail.load(cachePath);
+
+        if (thumbnail.isNull()) {
+            thumbnail = decodeScaled(filePath, side);
+            if (thumbnail.isNull()) {
+                return QImage();
+            }
+
+            QSaveFile file(cachePath);
+            if (file.open(QIODevice::WriteOnly)) {
+                // Фотографии без прозрачности - в JPEG, он в разы меньше PNG
+                thumbnail.save(&file, thumbnail.hasAlphaChannel() ? "PNG" : "JPG", 85);
+                if (file.commit()) {
+                    addToDiskCache(QFileInfo(cachePath).size());
+                }
+            }
+        }
+
+        QMutexLocker locker(&m_mutex);
+        m_memoryCache.insert(cachePath, new QImage(thumbnail), qMax(1, thumbnail.byteCount() / 1024));
+    }
+
+    if (size) {
+        *size = thumbnail.size();
+    }
+    return thumbnail;
+}
+
+int ThumbnailProvider::bucketSide(const QSize &requestedSize)
+{
+    const int requested = qMax(requestedSize.width(), requestedSize.height());
+    if (requested <= 0) {
+        return DEFAULT_SIDE;
+    }
+
+    int side = 128;
+    while (side < requested && side < MAX_SIDE) {
+        side *= 2;
+    }
+    return side;
+}
+
+QString ThumbnailProvider::diskCachePath(const QFileInfo &fileInfo, int side) const
+{
+    QByteArray key = fileInfo.absoluteFilePath().toUtf8() + '|'
+            + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()) + '|'
+            + QByteArray::number(fileInfo.size()) + '|'
+            + QByteArray::number(side);
+    return m_cacheDir + '/' + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+}
+
+QImage ThumbnailProvider::decodeScaled(const QString &filePath, int side)
+{
+    QImageReader reader(filePath);
+    reader.setAutoTransform(true);
+
+    // Декодер сам уменьшает изображение: 12 Мп JPEG не декодируется целиком
+    QSize fullSize = reader.size();
+    if (fullSize.isValid() && qMax(fullSize.width(), fullSize.height()) > side) {
+        reader.setScaledSize(fullSize.scaled(side, side, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "[ThumbnailProvider::decodeScaled] Cannot decode" << filePath << reader.errorString();
+        return QImage();
+    }
+
+    // Размер до поворота по EXIF неизвестен заранее - досжимаем, если нужно
+    if (qMax(image.width(), image.height()) > side) {
+        image = image.scaled(side, side, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+void ThumbnailProvider::addToDiskCache(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_diskCacheBytes += bytes;
+
+    // Кэш вырос сверх предела за время работы: одна чистка в фоне за раз
+    if (m_diskCacheBytes > DISK_CACHE_BYTES && !m_pruning.isRunning()) {
+        m_pruning = QtConcurrent::run([this]() { pruneDiskCache(); });
+    }
+}
+
+void ThumbnailProvider::pruneDiskCache()
+{
+    QFileInfoList files = QDir(m_cacheDir).entryInfoList(QDir::Files);
+
+    qint64 total = 0;
+    for (const QFileInfo &file : files) {
+        total += file.size();
+    }
+    if (total <= DISK_CACHE_BYTES) {
+        QMutexLocker locker(&m_mutex);
+        m_diskCacheBytes = total;
+        return;
+    }
+
+    // Сначала удаляем самые старые миниатюры
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+
+    int removed = 0;
+    for (const QFileInfo &file : files) {
+        if (total <= DISK_CACHE_BYTES * 3 / 4) {
+            break;
+        }
+        if (QFile::remove(file.absoluteFilePath())) {
+            total -= file.size();
+            ++removed;
+        }
+    }
+
+    {
+        // Записи во время обхода учтутся следующей чисткой
+        QMutexLocker locker(&m_mutex);
+        m_diskCacheBytes = total;
+    }
+
+    qDebug() << "[ThumbnailProvider::pruneDiskCache] ✓ Removed" << removed << "thumbnails";
+}
@@ -0,0 +1,53 @@
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <QQuickImageProvider>
+#include <QCache>
+#include <QFileInfo>
+#include <QFuture>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief Миниатюры фотографий для QML: image://thumbnails/<путь к файлу>
+ *
+ * Миниатюра декодируется сразу в уменьшенном размере (для JPEG - в DCT)
+ * в фоновом потоке загрузчика изображений QML. Готовые миниатюры хранятся
+ * в памяти (LRU) и на диске; ключ - путь, время изменения и размер файла,
+ * поэтому изменённый файл получает новую миниатюру.
+ *
+ * Размер задаётся sourceSize элемента Image и округляется вверх до
+ * ступени (128, 256, 512, 1024), чтобы разные экраны делили кэш.
+ * Путь в id закодирован (encodeURIComponent в QML). Кэш на диске
+ * ограничен по размеру: он чистится при запуске и в фоне, когда
+ * записанные миниатюры превысили предел.
+ */
+class ThumbnailProvider : public QQuickImageProvider
+{
+public:
+    explicit ThumbnailProvider(const QString &cacheDir);
+    ~ThumbnailProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    static const int DEFAULT_SIDE = 256;
+    static const int MAX_SIDE = 1024;
+    static const int MEMORY_CACHE_KB = 32 * 1024;
+    static const qint64 DISK_CACHE_BYTES = 64 * 1024 * 1024;
+
+    static int bucketSide(const QSize &requestedSize);
+    QString diskCachePath(const QFileInfo &fileInfo, int side) const;
+    static QImage decodeScaled(const QString &filePath, int side);
+    void addToDiskCache(qint64 bytes);
+    void pruneDiskCache();
+
+    QString m_cacheDir;
+
+    QMutex m_mutex;
+    QCache<QString, QImage> m_memoryCache;    // Стоимость - размер в КБ
+    QFuture<void> m_pruning;                  // Под m_mutex
+    qint64 m_diskCacheBytes;                  // Размер кэша на диске (под m_mutex)
+};
+
+#endif // THUMBNAILPROVIDER_H
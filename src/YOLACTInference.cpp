@@ -8,6 +8,7 @@
 YOLACTInference::YOLACTInference()
 {
     m_modelLoaded = false;
+    m_inputSize = MODEL_SIZE;
 }
 
 YOLACTInference::~YOLACTInference()
@@ -29,6 +30,13 @@ bool YOLACTInference::loadModel(const QString &modelPath)
     return true;
 }
 
+YOLACTInference *YOLACTInference::createContext() const
+{
+    YOLACTInference *context = new YOLACTInference();
+    context->shareWeightsFrom(*this);
+    return context;
+}
+
 QVector<ONNXInference::SegmentationResult> YOLACTInference::segmentImage(
     const QString &imagePath, float confThreshold)
 {
@@ -58,12 +66,12 @@ QVector<ONNXInference::SegmentationResult> YOLACTInference::segmentImage(
 
     QSize originalSize = image.size();
     
-    // Предобработка
-    std::vector<float> inputData = preprocessImage(image, MODEL_SIZE);
+    // Предобработка в буфер контекста (переиспользуется между вызовами)
+    preprocessImageInto(image, MODEL_SIZE, m_scratch.input);
     std::vector<int64_t> inputShape = {1, 3, MODEL_SIZE, MODEL_SIZE};
     
     // Инференс
-    std::vector<float> outputData = runInference(inputData, inputShape);
+    std::vector<float> outputData = runInference(m_scratch.input, inputShape);
     
     if (outputData.empty()) {
         qWarning() << "Inference returned empty output";
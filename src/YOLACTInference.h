@@ -21,6 +21,11 @@ public:
      */
     bool loadModel(const QString &modelPath) override;
 
+    /**
+     * @brief Создаёт контекст для другого потока с общими весами
+     */
+    YOLACTInference *createContext() const override;
+
     /**
      * @brief Выполняет сегментацию на изображении
      * @param imagePath Путь к изображению
@@ -1,13 +1,43 @@
 #include "YOLO11Segmentation.h"
+#include "ImageView.h"
+#include "ContextPool.h"
+#include "ParallelFor.h"
 #include <QDebug>
 #include <QFileInfo>
 #include <QPainter>
 #include <cmath>
 #include <algorithm>
 
+namespace {
+// Доля меньшего bbox, перекрытая большим, при которой части одного объекта
+// на стыке тайлов считаются дубликатами
+const float SEAM_CONTAINMENT = 0.6f;
+
+QVector<int> tileStarts(int length, int tileSize, int overlap)
+{
+    QVector<int> starts;
+    if (length <= tileSize) {
+        starts.append(0);
+        return starts;
+    }
+
+    int stride = std::max(1, tileSize - overlap);
+    for (int pos = 0; ; pos += stride) {
+        if (pos + tileSize >= length) {
+            // Последний тайл прижимаем к краю изображения
+            starts.append(length - tileSize);
+            break;
+        }
+        starts.append(pos);
+    }
+    return starts;
+}
+}
+
 YOLO11Segmentation::YOLO11Segmentation()
 {
     m_modelLoaded = false;
+    m_inputSize = MODEL_SIZE;
 }
 
 YOLO11Segmentation::~YOLO11Segmentation()
@@ -29,6 +59,13 @@ bool YOLO11Segmentation::loadModel(const QString &modelPath)
     return true;
 }
 
+YOLO11Segmentation *YOLO11Segmentation::createContext() const
+{
+    YOLO11Segmentation *context = new YOLO11Segmentation();
+    context->shareWeightsFrom(*this);
+    return context;
+}
+
 QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::segmentImage(
     const QString &imagePath, float confThreshold, float iouThreshold)
 {
@@ -57,28 +94,41 @@ QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::segmentImage(
     }
 
     QSize originalSize = image.size();
+    const int modelSize = m_inputSize;
     
-    // Предобработка
-    std::vector<float> inputData = preprocessImage(image, MODEL_SIZE);
-    std::vector<int64_t> inputShape = {1, 3, MODEL_SIZE, MODEL_SIZE};
+    // Предобработка в буфер контекста (переиспользуется между вызовами)
+    preprocessImageInto(image, modelSize, m_scratch.input);
+    std::vector<int64_t> inputShape = {1, 3, modelSize, modelSize};
     
     // Инференс
-    std::vector<float> outputData = runInference(inputData, inputShape);
+    std::vector<float> outputData = runInference(m_scratch.input, inputShape);
     
     if (outputData.empty()) {
         qWarning() << "Inference returned empty output";
         return results;
     }
 
+    results = buildResults(outputData, originalSize, modelSize, confThreshold, iouThreshold);
+    
+    qDebug() << "YOLO11-segm found" << results.size() << "objects";
+    return results;
+}
+
+QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::buildResults(
+    const std::vector<float> &outputData, const QSize &originalSize, int modelSize,
+    float confThreshold, float iouThreshold)
+{
+    QVector<SegmentationResult> results;
+
     // Постобработка детекций
     QVector<Detection> detections = postprocessDetections(outputData, originalSize, 
-                                                          MODEL_SIZE, confThreshold);
+                                                          modelSize, confThreshold);
     
     // Применяем NMS
     detections = applyNMS(detections, iouThreshold);
     
     // Извлекаем маски
-    QVector<QImage> masks = extractMasks(outputData, detections, originalSize, MODEL_SIZE);
+    QVector<QImage> masks = extractMasks(outputData, detections, originalSize, modelSize);
     
     // Объединяем детекции и маски
     for (int i = 0; i < detections.size() && i < masks.size(); ++i) {
@@ -89,10 +139,213 @@ QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::segmentImage(
         results.append(result);
     }
     
-    qDebug() << "YOLO11-segm found" << results.size() << "objects";
     return results;
 }
 
+QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::segmentImageTiled(
+    const QImage &image, const TilingOptions &options, float confThreshold, float iouThreshold)
+{
+    if (!m_modelLoaded) {
+        qWarning() << "YOLO11-segm model not loaded";
+        return QVector<SegmentationResult>();
+    }
+
+    if (image.isNull()) {
+        qWarning() << "Input image is null";
+        return QVector<SegmentationResult>();
+    }
+
+    int tileSize = (options.tileSize > 0) ? options.tileSize : m_inputSize;
+    if (std::max(image.width(), image.height()) <= std::max(tileSize, options.minImageSide)) {
+        // Изображение и так достаточно мелкое — тайлинг не нужен
+        return segmentImage(image, confThreshold, iouThreshold);
+    }
+
+    int overlap = qBound(0, options.overlap, tileSize / 2);
+    QVector<QRect> tiles = computeTiles(image.size(), tileSize, overlap);
+
+    // Тайлы ссылаются на пиксели исходного изображения без копирования
+    QVector<QImage> tileImages;
+    tileImages.reserve(tiles.size());
+    for (const QRect &tile : tiles) {
+        tileImages.append(imageCropView(image, tile));
+    }
+
+    std::vector<QVector<SegmentationResult>> tileResults(tiles.size());
+    if (options.batched) {
+        QVector<QVector<SegmentationResult>> batchResults =
+            segmentBatch(tileImages, confThreshold, iouThreshold);
+        for (int i = 0; i < batchResults.size() && i < tiles.size(); ++i) {
+            tileResults[i] = batchResults[i];
+        }
+    } else {
+        // Каждый поток работает со своим контекстом: веса общие, буферы свои
+        ContextPool<YOLO11Segmentation> contexts([this]() { return createContext(); });
+        parallelFor(tiles.size(), [&](int i) {
+            ContextPool<YOLO11Segmentation>::Lease context(contexts);
+            tileResults[i] = context->segmentImage(tileImages[i], confThreshold, iouThreshold);
+        }, options.maxThreads);
+    }
+
+    // Переводим результаты тайлов в координаты исходного изображения
+    QVector<SegmentationResult> globalResults;
+    QVector<int> sourceTiles;
+    for (int i = 0; i < tiles.size(); ++i) {
+        const QPoint origin = tiles[i].topLeft();
+
+        for (SegmentationResult result : tileResults[i]) {
+            QRect box = result.detection.bbox.toAlignedRect()
+                            .intersected(QRect(QPoint(0, 0), tiles[i].size()));
+
+            // Храним только часть маски внутри bbox, чтобы не держать полноразмерные маски
+            if (!result.mask.isNull() && !box.isEmpty()) {
+                result.mask = result.mask.copy(box.translated(-result.maskOffset));
+                result.maskOffset = origin + box.topLeft();
+            } else {
+                result.maskOffset += origin;
+            }
+
+            result.detection.bbox.translate(origin);
+            for (QPointF &point : result.polygon) {
+                point += origin;
+            }
+
+            globalResults.append(result);
+            sourceTiles.append(i);
+        }
+    }
+
+    QVector<SegmentationResult> merged = mergeTileResults(globalResults, sourceTiles, tiles, iouThreshold);
+
+    qDebug() << "YOLO11-segm tiled:" << tiles.size() << "tiles," << globalResults.size()
+             << "raw objects," << merged.size() << "after merge";
+    return merged;
+}
+
+QVector<QVector<ONNXInference::SegmentationResult>> YOLO11Segmentation::segmentBatch(
+    const QVector<QImage> &images, float confThreshold, float iouThreshold)
+{
+    QVector<QVector<SegmentationResult>> results(images.size());
+
+    if (!m_modelLoaded) {
+        qWarning() << "YOLO11-segm model not loaded";
+        return results;
+    }
+
+    if (images.isEmpty()) {
+        return results;
+    }
+
+    const int modelSize = m_inputSize;
+    const size_t imageVolume = static_cast<size_t>(3) * modelSize * modelSize;
+    std::vector<float> batchData(imageVolume * images.size(), 0.0f);
+
+    // Предобработка изображений батча независима — выполняем параллельно
+    parallelFor(images.size(), [&](int i) {
+        std::vector<float> data = preprocessImage(images[i], modelSize);
+        if (data.size() == imageVolume) {
+            std::copy(data.begin(), data.end(), batchData.begin() + i * imageVolume);
+        }
+    });
+
+    // Модель должна быть экспортирована с динамической размерностью батча
+    std::vector<int64_t> inputShape = {images.size(), 3, modelSize, modelSize};
+    std::vector<float> outputData = runInference(batchData, inputShape);
+
+    if (outputData.empty() || outputData.size() % images.size() != 0) {
+        qWarning() << "Batched inference returned unexpected output size:" << outputData.size();
+        return results;
+    }
+
+    // Выход упорядочен по первой размерности батча
+    const size_t perImage = outputData.size() / images.size();
+    for (int i = 0; i < images.size(); ++i) {
+        std::vector<float> slice(outputData.begin() + i * perImage,
+                                 outputData.begin() + (i + 1) * perImage);
+        results[i] = buildResults(slice, images[i].size(), modelSize, confThreshold, iouThreshold);
+    }
+
+    return results;
+}
+
+QVector<QRect> YOLO11Segmentation::computeTiles(const QSize &imageSize, int tileSize, int overlap)
+{
+    QVector<QRect> tiles;
+    QVector<int> xs = tileStarts(imageSize.width(), tileSize, overlap);
+    QVector<int> ys = tileStarts(imageSize.height(), tileSize, overlap);
+
+    for (int y : ys) {
+        for (int x : xs) {
+            tiles.append(QRect(x, y,
+                               std::min(tileSize, imageSize.width()),
+                               std::min(tileSize, imageSize.height())));
+        }
+    }
+    return tiles;
+}
+
+QVector<ONNXInference::SegmentationResult> YOLO11Segmentation::mergeTileResults(
+    const QVector<SegmentationResult> &results, const QVector<int> &sourceTiles,
+    const QVector<QRect> &tiles, float iouThreshold)
+{
+    // Индексы по убыванию уверенности: тайл-источник остаётся привязан к результату
+    QVector<int> order;
+    order.reserve(results.size());
+    for (int i = 0; i < results.size(); ++i) {
+        order.append(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&results](int a, int b) {
+        return results[a].detection.confidence > results[b].detection.confidence;
+    });
+
+    QVector<SegmentationResult> merged;
+    QVector<int> mergedTiles;
+
+    for (int index : order) {
+        const SegmentationResult &candidate = results[index];
+        const QRectF &box = candidate.detection.bbox;
+        const int tile = sourceTiles[index];
+        bool duplicate = false;
+
+        for (int k = 0; k < merged.size() && !duplicate; ++k) {
+            const SegmentationResult &kept = merged[k];
+
+            // Внутри тайла дубликаты уже подавлены NMS: соседние и частично
+            // закрытые яблоки одного тайла - разные объекты
+            if (mergedTiles[k] == tile || kept.detection.classId != candidate.detection.classId) {
+                continue;
+            }
+
+            // Один объект виден двум тайлам только на полосе их перекрытия
+            QRectF strip(tiles[tile].intersected(tiles[mergedTiles[k]]));
+            if (strip.isEmpty() || !strip.intersects(kept.detection.bbox) || !strip.intersects(box)) {
+                continue;
+            }
+
+            QRectF inter = kept.detection.bbox.intersected(box);
+            if (inter.isEmpty()) {
+                continue;
+            }
+
+            float interArea = inter.width() * inter.height();
+            float minArea = std::min(kept.detection.bbox.width() * kept.detection.bbox.height(),
+                                     box.width() * box.height());
+            bool seamPart = minArea > 0 && interArea / minArea > SEAM_CONTAINMENT;
+
+            // Остаётся более уверенная детекция: рамка не растёт и не
+            // поглощает соседние яблоки
+            duplicate = calculateIoU(kept.detection.bbox, box) > iouThreshold || seamPart;
+        }
+
+        if (!duplicate) {
+            merged.append(candidate);
+            mergedTiles.append(tile);
+        }
+    }
+
+    return merged;
+}
+
 std::vector<float> YOLO11Segmentation::runInference(
     const std::vector<float> &inputData, const std::vector<int64_t> &inputShape)
 {
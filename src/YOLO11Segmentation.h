@@ -14,6 +14,20 @@
 class YOLO11Segmentation : public ONNXInference
 {
 public:
+    /**
+     * @brief Параметры тайлового инференса для больших изображений
+     */
+    struct TilingOptions {
+        int tileSize;       // Размер тайла в пикселях исходного изображения
+        int overlap;        // Перекрытие соседних тайлов, пикселей
+        int maxThreads;     // Максимум потоков (0 = по числу ядер)
+        bool batched;       // Один батч [N, 3, S, S] вместо параллельных вызовов
+        int minImageSide;   // Тайлинг включается, если сторона изображения больше
+
+        TilingOptions()
+            : tileSize(640), overlap(128), maxThreads(0), batched(false), minImageSide(1280) {}
+    };
+
     YOLO11Segmentation();
     ~YOLO11Segmentation() override;
 
@@ -22,6 +36,11 @@ public:
      */
     bool loadModel(const QString &modelPath) override;
 
+    /**
+     * @brief Создаёт контекст для другого потока с общими весами
+     */
+    YOLO11Segmentation *createContext() const override;
+
     /**
      * @brief Выполняет сегментацию на изображении
      * @param imagePath Путь к изображению
@@ -40,6 +59,28 @@ public:
                                              float confThreshold = 0.25f,
                                              float iouThreshold = 0.45f);
 
+    /**
+     * @brief Сегментация большого изображения по перекрывающимся тайлам
+     *
+     * Тайлы обрабатываются одним батчем или параллельно, результаты
+     * переводятся в координаты исходного изображения, а из дубликатов
+     * соседних тайлов на полосе их перекрытия остаётся самый уверенный.
+     * Маски результатов покрывают
+     * только bbox объекта (см. SegmentationResult::maskOffset).
+     */
+    QVector<SegmentationResult> segmentImageTiled(const QImage &image,
+                                                  const TilingOptions &options,
+                                                  float confThreshold = 0.25f,
+                                                  float iouThreshold = 0.45f);
+
+    /**
+     * @brief Сегментация нескольких изображений одним вызовом модели
+     * @return Результаты для каждого изображения в том же порядке
+     */
+    QVector<QVector<SegmentationResult>> segmentBatch(const QVector<QImage> &images,
+                                                      float confThreshold = 0.25f,
+                                                      float iouThreshold = 0.45f);
+
     /**
      * @brief Выполняет инференс модели
      */
@@ -80,6 +121,16 @@ private:
     
     // Вспомогательные методы
     float calculateIoU(const QRectF &box1, const QRectF &box2);
+    QVector<SegmentationResult> buildResults(const std::vector<float> &outputData,
+                                             const QSize &originalSize,
+                                             int modelSize,
+                                             float confThreshold,
+                                             float iouThreshold);
+    static QVector<QRect> computeTiles(const QSize &imageSize, int tileSize, int overlap);
+    QVector<SegmentationResult> mergeTileResults(const QVector<SegmentationResult> &results,
+                                                 const QVector<int> &sourceTiles,
+                                                 const QVector<QRect> &tiles,
+                                                 float iouThreshold);
     QImage processMaskProto(const std::vector<float> &maskProto,
                            const Detection &detection,
                            const QSize &originalSize,
@@ -0,0 +1,48 @@
+#include "YuvFrame.h"
+#include <algorithm>
+
+namespace {
+inline uchar clampToByte(int value)
+{
+    return static_cast<uchar>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+}
+
+uchar YuvFrame::fullRangeLuma(int y)
+{
+    return clampToByte((298 * (y - 16) + 128) >> 8);
+}
+
+QRgb YuvFrame::toRgb(int y, int u, int v)
+{
+    // Целочисленное преобразование BT.601
+    int c = 298 * (y - 16);
+    int d = u - 128;
+    int e = v - 128;
+    return qRgb(clampToByte((c + 409 * e + 128) >> 8),
+                clampToByte((c - 100 * d - 208 * e + 128) >> 8),
+                clampToByte((c + 516 * d + 128) >> 8));
+}
+
+QImage YuvFrame::toImage(int maxSide) const
+{
+    if (isNull()) {
+        return QImage();
+    }
+
+    QSize outSize(width, height);
+    if (maxSide > 0 && std::max(width, height) > maxSide) {
+        outSize.scale(maxSide, maxSide, Qt::KeepAspectRatio);
+    }
+
+    QImage image(outSize, QImage::Format_RGB32);
+    for (int oy = 0; oy < outSize.height(); ++oy) {
+        int sy = oy * height / outSize.height();
+        QRgb *out = reinterpret_cast<QRgb *>(image.scanLine(oy));
+        for (int ox = 0; ox < outSize.width(); ++ox) {
+            out[ox] = rgb(ox * width / outSize.width(), sy);
+        }
+    }
+
+    return image;
+}
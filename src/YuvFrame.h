@@ -0,0 +1,66 @@
+#ifndef YUVFRAME_H
+#define YUVFRAME_H
+
+#include <QByteArray>
+#include <QImage>
+
+/**
+ * @brief Кадр YUV 4:2:0 в памяти (NV12 / NV21 / YUV420P / YV12)
+ *
+ * Хранит копию плоскостей без конвертации в RGB. Chroma-плоскости
+ * описываются смещением, шагом строки и шагом пикселя, поэтому
+ * чередующиеся (NV12/NV21) и раздельные (YUV420P/YV12) раскладки
+ * читаются одними и теми же функциями.
+ */
+struct YuvFrame
+{
+    QByteArray data;        // Плоскость Y, затем chroma
+    int width;
+    int height;
+    int yStride;            // Байт на строку Y
+    int uOffset;            // Смещение первого отсчёта U в data
+    int vOffset;            // Смещение первого отсчёта V в data
+    int chromaStride;       // Байт на строку chroma
+    int chromaStep;         // Шаг между отсчётами U (2 при чередовании UV, иначе 1)
+
+    YuvFrame()
+        : width(0), height(0), yStride(0), uOffset(0), vOffset(0)
+        , chromaStride(0), chromaStep(1) {}
+
+    bool isNull() const { return data.isEmpty(); }
+
+    const uchar *bytes() const { return reinterpret_cast<const uchar *>(data.constData()); }
+    const uchar *yRow(int row) const { return bytes() + row * yStride; }
+
+    uchar luma(int x, int row) const { return yRow(row)[x]; }
+
+    uchar u(int x, int row) const
+    {
+        return bytes()[uOffset + (row / 2) * chromaStride + (x / 2) * chromaStep];
+    }
+
+    uchar v(int x, int row) const
+    {
+        return bytes()[vOffset + (row / 2) * chromaStride + (x / 2) * chromaStep];
+    }
+
+    /**
+     * @brief Яркость в полном диапазоне 0..255 (эквивалент qGray для RGB)
+     */
+    static uchar fullRangeLuma(int y);
+
+    /**
+     * @brief RGB пикселя (BT.601, ограниченный диапазон)
+     */
+    static QRgb toRgb(int y, int u, int v);
+    QRgb rgb(int x, int row) const { return toRgb(luma(x, row), u(x, row), v(x, row)); }
+
+    /**
+     * @brief Конвертирует кадр в RGB
+     * @param maxSide Если > 0, кадр уменьшается выборкой так, чтобы большая сторона
+     *                не превышала maxSide (например, под вход детектора)
+     */
+    QImage toImage(int maxSide = 0) const;
+};
+
+#endif // YUVFRAME_H
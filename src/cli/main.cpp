@@ -0,0 +1,331 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <cstdio>
+#include <memory>
+
+#include "AppleDetector.h"
+#include "FrameReplaySource.h"
+#include "RealtimeBenchmark.h"
+#include "InferenceServer.h"
+#include "InferenceClient.h"
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// Команды завершаются асинхронно: код выхода передаётся через QCoreApplication::exit()
+bool runTrain(AppleDetector &detector, const QStringList &args, const QCommandLineParser &parser)
+{
+    if (args.size() != 1) {
+        err() << "Usage: aurcad-cli train [--polygons] [--save <model>] <dataset dir>" << endl;
+        return false;
+    }
+
+    QString savePath = parser.value("save");
+    QObject::connect(&detector, &AppleDetector::trainingProgress, [](int progress, const QString &message) {
+        err() << progress << "% " << message << endl;
+    });
+    QObject::connect(&detector, &AppleDetector::trainingComplete, [&detector, savePath](bool success, float accuracy) {
+        if (!success) {
+            QCoreApplication::exit(1);
+            return;
+        }
+        out() << "accuracy " << accuracy << endl;
+        if (!savePath.isEmpty() && !detector.saveModel(savePath)) {
+            QCoreApplication::exit(1);
+            return;
+        }
+        QCoreApplication::exit(0);
+    });
+
+    return detector.trainModel(args.first(), parser.isSet("polygons")) >= 0;
+}
+
+bool runAutotune(AppleDetector &detector)
+{
+    QObject::connect(&detector, &AppleDetector::autotuneComplete, [](bool success, const QString &summary) {
+        (success ? out() : err()) << summary << endl;
+        QCoreApplication::exit(success ? 0 : 1);
+    });
+
+    detector.autotuneInference();
+    if (!detector.autotuneRunning()) {
+        err() << "Autotune did not start" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool runAnalyze(AppleDetector &detector, const QStringList &args)
+{
+    if (args.isEmpty()) {
+        err() << "Usage: aurcad-cli analyze [--model <model>] [--segmentation] [--multi] <image>..." << endl;
+        return false;
+    }
+
+    // Запросы выполняются параллельно, результаты печатаются по мере готовности (JSON Lines)
+    std::shared_ptr<QHash<int, QString>> pending = std::make_shared<QHash<int, QString>>();
+    std::shared_ptr<int> failures = std::make_shared<int>(0);
+
+    QObject::connect(&detector, &AppleDetector::requestFinished,
+                     [pending, failures](int requestId, const QVariantMap &result) {
+        if (!pending->contains(requestId)) {
+            return;
+        }
+
+        QJsonObject line = QJsonObject::fromVariantMap(result);
+        line["file"] = pending->take(requestId);
+        out() << QJsonDocument(line).toJson(QJsonDocument::Compact) << endl;
+        if (!result.value("ok").toBool()) {
+            ++*failures;
+        }
+
+        if (pending->isEmpty()) {
+            QCoreApplication::exit(*failures > 0 ? 1 : 0);
+        }
+    });
+
+    for (const QString &path : args) {
+        int requestId = detector.analyzeImage(path);
+        if (requestId < 0) {
+            ++*failures;
+            continue;
+        }
+        pending->insert(requestId, path);
+    }
+
+    return !pending->isEmpty();
+}
+
+bool runBatch(AppleDetector &detector, const QStringList &args)
+{
+    if (args.size() != 2) {
+        err() << "Usage: aurcad-cli batch [--model <model>] [--segmentation] [--multi] <dir> <results.jsonl|.csv>" << endl;
+        return false;
+    }
+
+    QObject::connect(&detector, &AppleDetector::directoryProgress, [](int processed, double imagesPerSecond) {
+        err() << processed << " images, " << QString::number(imagesPerSecond, 'f', 1) << " images/s" << endl;
+    });
+    QObject::connect(&detector, &AppleDetector::directoryAnalysisComplete, [](const QVariantMap &report) {
+        out() << QJsonDocument(QJsonObject::fromVariantMap(report)).toJson(QJsonDocument::Compact) << endl;
+        QCoreApplication::exit(report.value("failed").toInt() > 0 ? 1 : 0);
+    });
+
+    return detector.analyzeDirectory(args.at(0), args.at(1)) >= 0;
+}
+
+bool runBench(AppleDetector &detector, const QStringList &args, const QCommandLineParser &parser)
+{
+    if (args.size() != 1) {
+        err() << "Usage: aurcad-cli bench [--model <model>] [--multi] [--pacing original|fast|<fps>] <recording>" << endl;
+        return false;
+    }
+
+    FrameReplaySource *source = new FrameReplaySource(&detector);
+    if (!source->load(args.first())) {
+        err() << "Cannot load recording: " << args.first() << endl;
+        return false;
+    }
+
+    QString pacing = parser.value("pacing");
+    if (pacing == "original") {
+        source->setPacing(FrameReplaySource::ORIGINAL_SPEED);
+    } else if (pacing == "fast") {
+        source->setPacing(FrameReplaySource::AS_FAST_AS_POSSIBLE);
+    } else {
+        bool ok = false;
+        double fps = pacing.toDouble(&ok);
+        if (!ok || fps <= 0.0) {
+            err() << "Invalid pacing: " << pacing << endl;
+            return false;
+        }
+        source->setPacing(FrameReplaySource::FIXED_FPS, fps);
+    }
+
+    RealtimeBenchmark *benchmark = new RealtimeBenchmark(&detector, source, &detector);
+    QObject::connect(benchmark, &RealtimeBenchmark::finished, [](const RealtimeBenchmark::Report &report) {
+        out() << report.toString() << endl;
+        QCoreApplication::exit(0);
+    });
+
+    return benchmark->start();
+}
+
+bool runServe(AppleDetector &detector, const QCommandLineParser &parser)
+{
+    InferenceServer *server = new InferenceServer(&detector, &detector);
+    server->setBatchWindow(parser.value("batch-window").toInt());
+    server->setMaxBatchSize(parser.value("max-batch").toInt());
+
+    if (!server->listen(parser.value("socket"))) {
+        err() << "Cannot listen: " << server->errorString() << endl;
+        return false;
+    }
+
+    err() << "Serving on " << server->socketPath() << endl;
+    return true;
+}
+
+bool runQuery(const QStringList &args, const QCommandLineParser &parser)
+{
+    if (args.isEmpty()) {
+        err() << "Usage: aurcad-cli query [--socket <name>] [--segmentation] [--multi] <image>..." << endl;
+        return false;
+    }
+
+    InferenceClient client;
+    if (!client.connectToServer(parser.value("socket"))) {
+        err() << "Cannot connect: " << client.errorString() << endl;
+        return false;
+    }
+
+    QVariantMap options;
+    if (parser.isSet("segmentation")) {
+        options["segmentation"] = true;
+    }
+    if (parser.isSet("multi")) {
+        options["multi"] = true;
+    }
+
+    // Все запросы отправляются сразу, чтобы демон собрал их в батчи
+    QVector<QPair<qint64, QString>> requests;
+    for (const QString &path : args) {
+        QImage image(path);
+        qint64 requestId = image.isNull() ? -1 : client.submit(image, options);
+        if (requestId < 0) {
+            err() << "Cannot submit " << path << ": " << (image.isNull() ? QString("cannot decode") : client.errorString()) << endl;
+            continue;
+        }
+        requests.append(qMakePair(requestId, path));
+    }
+
+    int failures = args.size() - requests.size();
+    for (const auto &request : requests) {
+        QJsonObject line = QJsonObject::fromVariantMap(client.waitForResult(request.first));
+        line["file"] = request.second;
+        out() << QJsonDocument(line).toJson(QJsonDocument::Compact) << endl;
+        if (!line.value("ok").toBool()) {
+            ++failures;
+        }
+    }
+
+    return failures == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Без дисплея: QImage и мультимедиа работают с offscreen платформой
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication application(argc, argv);
+    // Те же пути данных, что у приложения: общая обученная модель и профиль инференса
+    application.setOrganizationName(QStringLiteral("ru.auroraos"));
+    application.setApplicationName(QStringLiteral("aurcad"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Apple grading without the Aurora OS UI.\n\n"
+                                     "Commands:\n"
+                                     "  train <dataset dir>            Train and auto-save the classifier\n"
+                                     "  autotune                       Pick the fastest inference configuration and save it\n"
+                                     "  analyze <image>...             Grade images, one JSON line per image\n"
+                                     "  batch <dir> <results>          Grade a folder into JSON Lines or CSV\n"
+                                     "  bench <recording>              Replay recorded frames through realtime analysis\n"
+                                     "  serve                          Keep models loaded and serve other apps over a local socket\n"
+                                     "  query <image>...               Grade images through a running serve daemon");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "train, autotune, analyze, batch, bench, serve or query");
+    parser.addOption(QCommandLineOption("model", "Classifier model to load.", "model"));
+    parser.addOption(QCommandLineOption("save", "Save the trained model to this path.", "model"));
+    parser.addOption(QCommandLineOption("polygons", "Use polygon annotations for training."));
+    parser.addOption(QCommandLineOption("segmentation", "Use segmentation for feature extraction."));
+    parser.addOption(QCommandLineOption("multi", "Grade every apple in the image separately."));
+    parser.addOption(QCommandLineOption("pipelined", "Use the pipelined realtime mode (bench)."));
+    parser.addOption(QCommandLineOption("pacing", "Replay pacing: original, fast or frames per second.",
+                                        "pacing", "fast"));
+    parser.addOption(QCommandLineOption("socket", "Daemon socket name (serve, query).",
+                                        "name", InferenceProtocol::defaultSocketName()));
+    parser.addOption(QCommandLineOption("batch-window", "Milliseconds to collect requests into one batch (serve).",
+                                        "ms", "5"));
+    parser.addOption(QCommandLineOption("max-batch", "Maximum images per detector call (serve).",
+                                        "count", "8"));
+    parser.addOption(QCommandLineOption("batched", "The YOLO11 model accepts a dynamic batch dimension."));
+    parser.addOption(QCommandLineOption("models-dir", "Directory with the ONNX detection models.",
+                                        "dir", AppleDetector::Options().modelsDir));
+    parser.addOption(QCommandLineOption("dataset-dir", "Annotated dataset used to measure detection accuracy.",
+                                        "dir", AppleDetector::Options().datasetDir));
+    parser.process(application);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(1);
+    }
+    QString command = args.takeFirst();
+
+    // Клиенту модели не нужны
+    if (command == "query") {
+        return runQuery(args, parser) ? 0 : 1;
+    }
+
+    // Автонастройка в фоне только по команде autotune: иначе выход
+    // из утилиты ждал бы окончания бенчмарка моделей
+    AppleDetector::Options options;
+    options.modelsDir = parser.value("models-dir");
+    options.datasetDir = parser.value("dataset-dir");
+    options.autotune = false;
+
+    AppleDetector detector(options);
+    QObject::connect(&detector, &AppleDetector::errorOccurred, [](const QString &error) {
+        err() << "error: " << error << endl;
+    });
+
+    // Иначе анализ молча шёл бы с моделью из данных приложения
+    if (parser.isSet("model") && !detector.loadModel(parser.value("model"))) {
+        return 1;
+    }
+    detector.setUseSegmentation(parser.isSet("segmentation"));
+    detector.setMultiAppleMode(parser.isSet("multi"));
+    detector.setPipelinedRealtime(parser.isSet("pipelined"));
+    detector.setBatchedInference(parser.isSet("batched"));
+
+    bool started = false;
+    if (command == "train") {
+        started = runTrain(detector, args, parser);
+    } else if (command == "autotune") {
+        started = runAutotune(detector);
+    } else if (command == "analyze") {
+        started = runAnalyze(detector, args);
+    } else if (command == "batch") {
+        started = runBatch(detector, args);
+    } else if (command == "bench") {
+        started = runBench(detector, args, parser);
+    } else if (command == "serve") {
+        started = runServe(detector, parser);
+    } else {
+        err() << "Unknown command: " << command << endl;
+        parser.showHelp(1);
+    }
+
+    if (!started) {
+        return 1;
+    }
+
+    return application.exec();
+}
@@ -0,0 +1,58 @@
+# Ядро анализа: общее для приложения Aurora OS и консольной утилиты aurcad-cli
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/AppleDetector.cpp \
+    $$PWD/ImageProcessor.cpp \
+    $$PWD/ImageProcessorExtended.cpp \
+    $$PWD/AppleClassifier.cpp \
+    $$PWD/CameraHandler.cpp \
+    $$PWD/SegmentationData.cpp \
+    $$PWD/ONNXInference.cpp \
+    $$PWD/YOLO11Segmentation.cpp \
+    $$PWD/YOLACTInference.cpp \
+    $$PWD/RealtimeGovernor.cpp \
+    $$PWD/InferenceAutotuner.cpp \
+    $$PWD/YuvFrame.cpp \
+    $$PWD/CameraFrame.cpp \
+    $$PWD/AppleTracker.cpp \
+    $$PWD/LumaBuffer.cpp \
+    $$PWD/SceneChangeDetector.cpp \
+    $$PWD/FrameQualityGate.cpp \
+    $$PWD/FrameRecorder.cpp \
+    $$PWD/FrameReplaySource.cpp \
+    $$PWD/RealtimeBenchmark.cpp \
+    $$PWD/JobScheduler.cpp \
+    $$PWD/DirectoryAnalyzer.cpp \
+
+HEADERS += \
+    $$PWD/AppleDetector.h \
+    $$PWD/ImageProcessor.h \
+    $$PWD/AppleClassifier.h \
+    $$PWD/CameraHandler.h \
+    $$PWD/SegmentationData.h \
+    $$PWD/ONNXInference.h \
+    $$PWD/YOLO11Segmentation.h \
+    $$PWD/YOLACTInference.h \
+    $$PWD/RealtimeGovernor.h \
+    $$PWD/ParallelFor.h \
+    $$PWD/ImageView.h \
+    $$PWD/InferenceAutotuner.h \
+    $$PWD/ContextPool.h \
+    $$PWD/FrameMailbox.h \
+    $$PWD/YuvFrame.h \
+    $$PWD/CameraFrame.h \
+    $$PWD/StillImage.h \
+    $$PWD/BoundedQueue.h \
+    $$PWD/CancellationToken.h \
+    $$PWD/AppleTracker.h \
+    $$PWD/LumaBuffer.h \
+    $$PWD/SceneChangeDetector.h \
+    $$PWD/FrameQualityGate.h \
+    $$PWD/FrameRecorder.h \
+    $$PWD/FrameReplaySource.h \
+    $$PWD/RealtimeBenchmark.h \
+    $$PWD/JobScheduler.h \
+    $$PWD/DirectoryAnalyzer.h \
+
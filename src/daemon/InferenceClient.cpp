@@ -0,0 +1,179 @@
+#include "InferenceClient.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedMemory>
+#include <cstring>
+
+InferenceClient::InferenceClient()
+    : m_nextId(1)
+{
+}
+
+InferenceClient::~InferenceClient()
+{
+    disconnectFromServer();
+}
+
+bool InferenceClient::connectToServer(const QString &socketName, int timeoutMs)
+{
+    m_socket.connectToServer(socketName);
+    if (!m_socket.waitForConnected(timeoutMs)) {
+        m_error = m_socket.errorString();
+        return false;
+    }
+    return true;
+}
+
+void InferenceClient::disconnectFromServer()
+{
+    m_socket.disconnectFromServer();
+    m_segments.clear();
+    m_results.clear();
+}
+
+qint64 InferenceClient::submit(const QImage &image, const QVariantMap &options)
+{
+    if (image.isNull()) {
+        m_error = "Null image";
+        return -1;
+    }
+
+    // Демон читает пиксели без таблицы цветов
+    QImage frame = image.format() <= QImage::Format_Indexed8 ? image.convertToFormat(QImage::Format_RGB32) : image;
+
+    const qint64 requestId = m_nextId;
+    std::shared_ptr<QSharedMemory> memory = createSegment(requestId, frame.byteCount());
+    if (!memory) {
+        return -1;
+    }
+    memory->lock();
+    std::memcpy(memory->data(), frame.constBits(), frame.byteCount());
+    memory->unlock();
+
+    QVariantMap request;
+    request["shm"] = memory->key();
+    request["width"] = frame.width();
+    request["height"] = frame.height();
+    request["bytesPerLine"] = frame.bytesPerLine();
+    request["format"] = static_cast<int>(frame.format());
+    return send(request, options, memory);
+}
+
+qint64 InferenceClient::submitEncoded(const QByteArray &data, const QVariantMap &options)
+{
+    if (data.isEmpty()) {
+        m_error = "Empty image data";
+        return -1;
+    }
+
+    const qint64 requestId = m_nextId;
+    std::shared_ptr<QSharedMemory> memory = createSegment(requestId, data.size());
+    if (!memory) {
+        return -1;
+    }
+    memory->lock();
+    std::memcpy(memory->data(), data.constData(), data.size());
+    memory->unlock();
+
+    QVariantMap request;
+    request["shm"] = memory->key();
+    request["encoded"] = data.size();
+    return send(request, options, memory);
+}
+
+qint64 InferenceClient::submitFile(const QString &filePath, const QVariantMap &options)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = "Cannot open " + filePath;
+        return -1;
+    }
+    return submitEncoded(file.readAll(), options);
+}
+
+QVariantMap InferenceClient::waitForResult(qint64 requestId, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!m_results.contains(requestId)) {
+        if (!m_segments.contains(requestId)) {
+            return failure("Unknown request");
+        }
+        int remaining = timeoutMs - static_cast<int>(timer.elapsed());
+        if (remaining <= 0 || !readResponses(remaining)) {
+            return failure(m_error.isEmpty() ? QString("Timeout") : m_error);
+        }
+    }
+
+    m_segments.remove(requestId);
+    return m_results.take(requestId);
+}
+
+QVariantMap InferenceClient::analyze(const QImage &image, const QVariantMap &options, int timeoutMs)
+{
+    qint64 requestId = submit(image, options);
+    if (requestId < 0) {
+        return failure(m_error);
+    }
+    return waitForResult(requestId, timeoutMs);
+}
+
+qint64 InferenceClient::send(QVariantMap request, const QVariantMap &options,
+                             const std::shared_ptr<QSharedMemory> &memory)
+{
+    if (!isConnected()) {
+        m_error = "Not connected";
+        return -1;
+    }
+
+    const qint64 requestId = m_nextId++;
+    for (auto it = options.constBegin(); it != options.constEnd(); ++it) {
+        request.insert(it.key(), it.value());
+    }
+    request["id"] = requestId;
+
+    m_socket.write(QJsonDocument(QJsonObject::fromVariantMap(request)).toJson(QJsonDocument::Compact) + '\n');
+    m_socket.flush();
+    m_segments.insert(requestId, memory);
+    return requestId;
+}
+
+std::shared_ptr<QSharedMemory> InferenceClient::createSegment(qint64 requestId, int size)
+{
+    QString key = QString("aurcad-frame-%1-%2").arg(QCoreApplication::applicationPid()).arg(requestId);
+    std::shared_ptr<QSharedMemory> memory = std::make_shared<QSharedMemory>(key);
+    if (!memory->create(size)) {
+        m_error = "Cannot create shared memory: " + memory->errorString();
+        return std::shared_ptr<QSharedMemory>();
+    }
+    return memory;
+}
+
+bool InferenceClient::readResponses(int timeoutMs)
+{
+    if (!m_socket.canReadLine() && !m_socket.waitForReadyRead(timeoutMs)) {
+        m_error = m_socket.errorString();
+        return false;
+    }
+
+    while (m_socket.canReadLine()) {
+        QVariantMap response = QJsonDocument::fromJson(m_socket.readLine()).object().toVariantMap();
+        qint64 requestId = response.value("id").toLongLong();
+        if (m_segments.contains(requestId)) {
+            m_results.insert(requestId, response);
+        }
+    }
+    return true;
+}
+
+QVariantMap InferenceClient::failure(const QString &error)
+{
+    QVariantMap result;
+    result["ok"] = false;
+    result["error"] = error;
+    return result;
+}
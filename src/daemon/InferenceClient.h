@@ -0,0 +1,76 @@
+#ifndef INFERENCECLIENT_H
+#define INFERENCECLIENT_H
+
+#include <QHash>
+#include <QImage>
+#include <QLocalSocket>
+#include <QString>
+#include <QVariantMap>
+#include <memory>
+#include "InferenceProtocol.h"
+
+class QSharedMemory;
+
+/**
+ * @brief Клиент демона инференса (блокирующий, без цикла событий)
+ *
+ * Кадр копируется в сегмент разделяемой памяти клиента, в сокет уходит
+ * только его описание. Несколько запросов можно отправить подряд и
+ * затем ждать ответы - так демон объединит их в один батч.
+ */
+class InferenceClient
+{
+public:
+    InferenceClient();
+    ~InferenceClient();
+
+    bool connectToServer(const QString &socketName = InferenceProtocol::defaultSocketName(),
+                         int timeoutMs = 3000);
+    void disconnectFromServer();
+    bool isConnected() const { return m_socket.state() == QLocalSocket::ConnectedState; }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Отправляет кадр на анализ
+     * @param options "segmentation", "multi" (необязательно)
+     * @return Идентификатор запроса или -1
+     */
+    qint64 submit(const QImage &image, const QVariantMap &options = QVariantMap());
+
+    /**
+     * @brief Отправляет файл (JPEG/PNG) как есть: декодирует демон
+     */
+    qint64 submitEncoded(const QByteArray &data, const QVariantMap &options = QVariantMap());
+    qint64 submitFile(const QString &filePath, const QVariantMap &options = QVariantMap());
+
+    /**
+     * @brief Ждёт ответ на запрос
+     * @return Ответ демона (ok, result, confidence, apples, error, batch, ms)
+     */
+    QVariantMap waitForResult(qint64 requestId, int timeoutMs = 30000);
+
+    /**
+     * @brief Анализ одного кадра: submit() и waitForResult()
+     */
+    QVariantMap analyze(const QImage &image, const QVariantMap &options = QVariantMap(),
+                        int timeoutMs = 30000);
+
+private:
+    Q_DISABLE_COPY(InferenceClient)
+
+    qint64 send(QVariantMap request, const QVariantMap &options,
+                const std::shared_ptr<QSharedMemory> &memory = std::shared_ptr<QSharedMemory>());
+    std::shared_ptr<QSharedMemory> createSegment(qint64 requestId, int size);
+    bool readResponses(int timeoutMs);
+    static QVariantMap failure(const QString &error);
+
+    QLocalSocket m_socket;
+    QString m_error;
+    qint64 m_nextId;
+
+    // Сегменты живут до ответа на свой запрос
+    QHash<qint64, std::shared_ptr<QSharedMemory>> m_segments;
+    QHash<qint64, QVariantMap> m_results;
+};
+
+#endif // INFERENCECLIENT_H
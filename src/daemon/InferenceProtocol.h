@@ -0,0 +1,31 @@
+#ifndef INFERENCEPROTOCOL_H
+#define INFERENCEPROTOCOL_H
+
+#include <QString>
+
+/**
+ * @brief Протокол демона инференса (aurcad-cli serve)
+ *
+ * Локальный сокет (Unix domain socket), по одному JSON объекту на строку
+ * в обе стороны. Запрос:
+ *   {"id": 1, "shm": "<ключ QSharedMemory>", "width": W, "height": H,
+ *    "bytesPerLine": S, "format": <QImage::Format>}        - пиксели кадра
+ *   {"id": 1, "shm": "<ключ>", "encoded": <байт>}          - JPEG/PNG в памяти
+ *   {"id": 1, "path": "/путь/к/файлу.jpg"}                 - файл
+ * Необязательно: "segmentation", "multi" (по умолчанию - настройки демона).
+ *
+ * Ответ: {"id", "ok", "result", "confidence", "apples", "error",
+ *         "batch" (размер батча детектора), "ms" (время в демоне)}.
+ * Ответы приходят по мере готовности, не обязательно в порядке запросов.
+ * Сегмент памяти клиент держит до получения ответа на запрос.
+ */
+namespace InferenceProtocol {
+
+inline QString defaultSocketName()
+{
+    return QStringLiteral("aurcad-inference");
+}
+
+}
+
+#endif // INFERENCEPROTOCOL_H
@@ -0,0 +1,268 @@
+#include "InferenceServer.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSharedMemory>
+
+InferenceServer::InferenceServer(AppleDetector *detector, QObject *parent)
+    : QObject(parent)
+    , m_detector(detector)
+    , m_server(new QLocalServer(this))
+    , m_maxBatchSize(DEFAULT_MAX_BATCH_SIZE)
+{
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(DEFAULT_BATCH_WINDOW_MS);
+    connect(&m_batchTimer, &QTimer::timeout, this, &InferenceServer::flushBatch);
+    connect(m_server, &QLocalServer::newConnection, this, &InferenceServer::onNewConnection);
+}
+
+InferenceServer::~InferenceServer()
+{
+    m_server->close();
+    m_batchTimer.stop();
+    m_pending.clear();
+
+    // Запущенные батчи читают разделяемую память запросов
+    for (auto it = m_running.begin(); it != m_running.end(); ++it) {
+        it.key()->waitForFinished();
+        delete it.key();
+    }
+    m_running.clear();
+}
+
+bool InferenceServer::listen(const QString &socketName)
+{
+    // Сокет от прошлого запуска, завершившегося аварийно
+    QLocalServer::removeServer(socketName);
+
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server->listen(socketName)) {
+        m_error = m_server->errorString();
+        return false;
+    }
+
+    qDebug() << "[InferenceServer::listen] ✓ Listening on" << m_server->fullServerName()
+             << "batch window" << batchWindow() << "ms, max batch" << m_maxBatchSize;
+    return true;
+}
+
+QString InferenceServer::socketPath() const
+{
+    return m_server->fullServerName();
+}
+
+void InferenceServer::setBatchWindow(int ms)
+{
+    m_batchTimer.setInterval(qMax(0, ms));
+}
+
+void InferenceServer::onNewConnection()
+{
+    while (QLocalSocket *client = m_server->nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, &InferenceServer::onReadyRead);
+        connect(client, &QLocalSocket::disconnected, this, &InferenceServer::onClientDisconnected);
+    }
+}
+
+void InferenceServer::onReadyRead()
+{
+    QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+    if (!client) {
+        return;
+    }
+
+    while (client->canReadLine()) {
+        QByteArray line = client->readLine().trimmed();
+        if (!line.isEmpty()) {
+            handleLine(client, line);
+        }
+    }
+}
+
+void InferenceServer::onClientDisconnected()
+{
+    // Ответы отключившемуся клиенту отбрасываются (QPointer в запросах)
+    QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+    if (client) {
+        client->deleteLater();
+    }
+}
+
+void InferenceServer::handleLine(QLocalSocket *client, const QByteArray &line)
+{
+    QJsonParseError parseError;
+    QJsonObject message = QJsonDocument::fromJson(line, &parseError).object();
+
+    Request request;
+    request.client = client;
+    request.id = static_cast<qint64>(message.value("id").toDouble(-1));
+    request.useSegmentation = message.value("segmentation").toBool(m_detector->useSegmentation());
+    request.multiApple = message.value("multi").toBool(m_detector->multiAppleMode());
+    request.received.start();
+
+    QVariantMap error;
+    error["ok"] = false;
+
+    if (parseError.error != QJsonParseError::NoError || message.isEmpty()) {
+        error["error"] = "Invalid request";
+        sendResponse(request, error, 0);
+        return;
+    }
+
+    if (message.contains("path")) {
+        request.path = message.value("path").toString();
+    } else {
+        // Сегмент только читаем: клиент создал его и держит до ответа
+        request.memory = std::make_shared<QSharedMemory>(message.value("shm").toString());
+        if (!request.memory->attach(QSharedMemory::ReadOnly)) {
+            error["error"] = "Cannot attach shared memory: " + request.memory->errorString();
+            sendResponse(request, error, 0);
+            return;
+        }
+
+        const uchar *data = static_cast<const uchar *>(request.memory->constData());
+        const int size = request.memory->size();
+
+        if (message.contains("encoded")) {
+            int length = message.value("encoded").toInt();
+            if (length <= 0 || length > size) {
+                error["error"] = "Invalid encoded image size";
+                sendResponse(request, error, 0);
+                return;
+            }
+            request.encoded = QByteArray::fromRawData(reinterpret_cast<const char *>(data), length);
+        } else {
+            int width = message.value("width").toInt();
+            int height = message.value("height").toInt();
+            int bytesPerLine = message.value("bytesPerLine").toInt();
+            int format = message.value("format").toInt();
+
+            // Индексированные форматы требуют таблицы цветов, её в памяти нет
+            bool validFormat = format > QImage::Format_Indexed8 && format < QImage::NImageFormats;
+            if (!validFormat || width <= 0 || height <= 0 || bytesPerLine <= 0
+                    || static_cast<qint64>(bytesPerLine) * height > size) {
+                error["error"] = "Invalid image description";
+                sendResponse(request, error, 0);
+                return;
+            }
+
+            request.image = QImage(data, width, height, bytesPerLine, static_cast<QImage::Format>(format));
+        }
+    }
+
+    m_pending.append(request);
+    if (m_pending.size() >= m_maxBatchSize) {
+        flushBatch();
+    } else if (!m_batchTimer.isActive()) {
+        m_batchTimer.start();
+    }
+}
+
+void InferenceServer::flushBatch()
+{
+    m_batchTimer.stop();
+
+    // В одном вызове детектора - запросы с одинаковыми параметрами анализа
+    while (!m_pending.isEmpty()) {
+        const bool useSegmentation = m_pending.first().useSegmentation;
+        const bool multiApple = m_pending.first().multiApple;
+
+        QVector<Request> batch;
+        QVector<Request> rest;
+        for (const Request &request : m_pending) {
+            if (batch.size() < m_maxBatchSize && request.useSegmentation == useSegmentation
+                    && request.multiApple == multiApple) {
+                batch.append(request);
+            } else {
+                rest.append(request);
+            }
+        }
+
+        m_pending = rest;
+        startBatch(batch);
+    }
+}
+
+void InferenceServer::startBatch(const QVector<Request> &batch)
+{
+    QVector<QImage> images;
+    QVector<QByteArray> encoded;
+    QStringList paths;
+    for (const Request &request : batch) {
+        images.append(request.image);
+        encoded.append(request.encoded);
+        paths.append(request.path);
+    }
+
+    AppleDetector *detector = m_detector;
+    const bool useSegmentation = batch.first().useSegmentation;
+    const bool multiApple = batch.first().multiApple;
+
+    std::function<QVector<AppleDetector::AnalysisResult>()> job =
+            [detector, images, encoded, paths, useSegmentation, multiApple]() {
+        // Сжатые изображения и файлы декодируются в потоке планировщика
+        QVector<QImage> decoded = images;
+        for (int i = 0; i < decoded.size(); ++i) {
+            if (!encoded[i].isEmpty()) {
+                decoded[i] = QImage::fromData(encoded[i]);
+            } else if (!paths[i].isEmpty()) {
+                QImageReader reader(paths[i]);
+                reader.setAutoTransform(true);
+                decoded[i] = reader.read();
+            }
+        }
+
+        // Имена файлов - для аннотаций, как при анализе в приложении
+        QStringList imageNames;
+        for (const QString &path : paths) {
+            imageNames.append(path.isEmpty() ? QString() : QFileInfo(path).fileName());
+        }
+
+        QVector<AppleDetector::AnalysisResult> results =
+                detector->analyzeBatch(decoded, imageNames, useSegmentation, multiApple);
+        for (int i = 0; i < decoded.size(); ++i) {
+            if (decoded[i].isNull()) {
+                results[i] = AppleDetector::AnalysisResult();
+                results[i].error = "Cannot decode image";
+            }
+        }
+        return results;
+    };
+
+    BatchWatcher *watcher = new BatchWatcher(this);
+    m_running.insert(watcher, batch);
+    connect(watcher, &BatchWatcher::finished, this, &InferenceServer::onBatchFinished);
+    watcher->setFuture(m_detector->scheduler().run(JobScheduler::INTERACTIVE, job));
+}
+
+void InferenceServer::onBatchFinished()
+{
+    BatchWatcher *watcher = static_cast<BatchWatcher *>(sender());
+    QVector<Request> batch = m_running.take(watcher);
+    QVector<AppleDetector::AnalysisResult> results = watcher->result();
+    watcher->deleteLater();
+
+    for (int i = 0; i < batch.size() && i < results.size(); ++i) {
+        sendResponse(batch[i], AppleDetector::toVariantMap(results[i]), batch.size());
+        emit requestServed(batch[i].received.elapsed(), batch.size());
+    }
+}
+
+void InferenceServer::sendResponse(const Request &request, const QVariantMap &response, int batchSize)
+{
+    if (!request.client) {
+        return;
+    }
+
+    QJsonObject message = QJsonObject::fromVariantMap(response);
+    message["id"] = static_cast<double>(request.id);
+    if (batchSize > 0) {
+        message["batch"] = batchSize;
+    }
+    message["ms"] = static_cast<double>(request.received.elapsed());
+    request.client->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
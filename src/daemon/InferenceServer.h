@@ -0,0 +1,103 @@
+#ifndef INFERENCESERVER_H
+#define INFERENCESERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include "AppleDetector.h"
+#include <memory>
+
+class QLocalServer;
+class QLocalSocket;
+class QSharedMemory;
+
+/**
+ * @brief Демон инференса: модели загружены один раз и обслуживают
+ *        запросы других приложений через локальный сокет
+ *
+ * Кадры передаются через разделяемую память без копирования в сокет
+ * (см. InferenceProtocol.h). Запросы, пришедшие в пределах окна батча,
+ * объединяются в один вызов детектора (AppleDetector::analyzeBatch),
+ * который выполняется в планировщике детектора с классом INTERACTIVE.
+ */
+class InferenceServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InferenceServer(AppleDetector *detector, QObject *parent = nullptr);
+    ~InferenceServer();
+
+    /**
+     * @brief Начинает приём подключений (сокет доступен только текущему пользователю)
+     */
+    bool listen(const QString &socketName);
+    QString errorString() const { return m_error; }
+    QString socketPath() const;
+
+    /**
+     * @brief Сколько ждать следующих запросов перед запуском батча, мс
+     */
+    void setBatchWindow(int ms);
+    int batchWindow() const { return m_batchTimer.interval(); }
+
+    /**
+     * @brief Максимум изображений в одном вызове детектора
+     */
+    void setMaxBatchSize(int size) { m_maxBatchSize = qMax(1, size); }
+    int maxBatchSize() const { return m_maxBatchSize; }
+
+signals:
+    void requestServed(qint64 latencyMs, int batchSize);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onClientDisconnected();
+    void flushBatch();
+    void onBatchFinished();
+
+private:
+    Q_DISABLE_COPY(InferenceServer)
+
+    static const int DEFAULT_BATCH_WINDOW_MS = 5;
+    static const int DEFAULT_MAX_BATCH_SIZE = 8;
+
+    struct Request {
+        QPointer<QLocalSocket> client;
+        qint64 id;
+        QImage image;                           // Пиксели в разделяемой памяти (без копии)
+        QByteArray encoded;                     // JPEG/PNG в разделяемой памяти (без копии)
+        QString path;
+        std::shared_ptr<QSharedMemory> memory;  // Подключена, пока запрос не обработан
+        bool useSegmentation;
+        bool multiApple;
+        QElapsedTimer received;
+
+        Request() : id(0), useSegmentation(false), multiApple(false) {}
+    };
+
+    typedef QFutureWatcher<QVector<AppleDetector::AnalysisResult>> BatchWatcher;
+
+    void handleLine(QLocalSocket *client, const QByteArray &line);
+    void startBatch(const QVector<Request> &batch);
+    void sendResponse(const Request &request, const QVariantMap &response, int batchSize);
+
+    AppleDetector *m_detector;
+    QLocalServer *m_server;
+    QString m_error;
+
+    QVector<Request> m_pending;
+    QTimer m_batchTimer;
+    int m_maxBatchSize;
+
+    // Батчи в работе: запросы держат сегменты памяти до ответа
+    QHash<BatchWatcher *, QVector<Request>> m_running;
+};
+
+#endif // INFERENCESERVER_H
@@ -7,6 +7,7 @@
 
 #include "AppleDetector.h"
 #include "CameraHandler.h"
+#include "ThumbnailProvider.h"
 
 int main(int argc, char *argv[])
 {
@@ -36,6 +37,10 @@ int main(int argc, char *argv[])
     // Регистрируем AppleDetector в QML context
     view->rootContext()->setContextProperty("appleDetector", &appleDetector);
 
+    // Миниатюры фотографий: image://thumbnails/<путь>, движок владеет провайдером
+    QString thumbnailsDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    view->engine()->addImageProvider(QStringLiteral("thumbnails"), new ThumbnailProvider(thumbnailsDir));
+
     // Устанавливаем главный QML файл
     view->setSource(Aurora::Application::pathTo(QStringLiteral("qml/aurcad.qml")));
     view->show();
@@ -0,0 +1,12 @@
+# Общие настройки тестов: каждый тест собирается вместе с ядром анализа
+
+QT += core gui multimedia concurrent testlib
+QT -= qml quick
+
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+# Включаем файлы, сгенерированные Conan
+exists($$PWD/../conanbuildinfo.pri): include($$PWD/../conanbuildinfo.pri)
+
+include($$PWD/../src/core.pri)
@@ -0,0 +1,12 @@
+# Модульные тесты ядра анализа. Сборка: qmake tests/tests.pro && make && make check
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_appletracker \
+    tst_boundedqueue \
+    tst_featureparity \
+    tst_framemailbox \
+    tst_framequalitygate \
+    tst_inferenceautotuner \
+    tst_jobscheduler \
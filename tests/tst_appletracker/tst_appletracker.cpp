@@ -0,0 +1,111 @@
+#include <QtTest>
+#include "AppleTracker.h"
+
+class AppleTrackerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyTrackerNeedsDetection();
+    void detectionAtInterval_data();
+    void detectionAtInterval();
+    void poorMatchRedetectsEarly();
+    void matchedDetectionKeepsTrackId();
+    void unmatchedTrackRemoved();
+
+private:
+    static QVector<QRectF> boxes(const QRectF &box) { return QVector<QRectF>() << box; }
+};
+
+void AppleTrackerTest::emptyTrackerNeedsDetection()
+{
+    AppleTracker tracker;
+    QVERIFY(tracker.needsDetection());
+}
+
+void AppleTrackerTest::detectionAtInterval_data()
+{
+    QTest::addColumn<int>("interval");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("5") << 5;
+    QTest::newRow("10") << 10;
+    QTest::newRow("30") << 30;
+}
+
+void AppleTrackerTest::detectionAtInterval()
+{
+    QFETCH(int, interval);
+
+    // Неподвижное яблоко: затухание не должно запрашивать детекцию раньше интервала
+    AppleTracker tracker;
+    tracker.setDetectionInterval(interval);
+    tracker.update(boxes(QRectF(100, 100, 80, 80)));
+
+    for (int frame = 1; frame < interval; ++frame) {
+        tracker.advanceFrame();
+        QVERIFY2(!tracker.needsDetection(), qPrintable(QString("frame %1").arg(frame)));
+    }
+
+    tracker.advanceFrame();
+    QVERIFY(tracker.needsDetection());
+}
+
+void AppleTrackerTest::poorMatchRedetectsEarly()
+{
+    const int interval = 10;
+
+    AppleTracker tracker;
+    tracker.setDetectionInterval(interval);
+    tracker.update(boxes(QRectF(0, 0, 100, 100)));
+    for (int frame = 0; frame < interval; ++frame) {
+        tracker.advanceFrame();
+    }
+
+    // Яблоко сместилось сильнее предсказания: IoU 2/3
+    tracker.update(boxes(QRectF(20, 0, 100, 100)));
+    QVERIFY(!tracker.needsDetection());
+    QVERIFY(tracker.tracks().first().confidence < 0.7f);
+
+    int framesUntilDetection = 0;
+    while (!tracker.needsDetection()) {
+        tracker.advanceFrame();
+        ++framesUntilDetection;
+    }
+    QVERIFY2(framesUntilDetection < interval, qPrintable(QString("%1 frames").arg(framesUntilDetection)));
+}
+
+void AppleTrackerTest::matchedDetectionKeepsTrackId()
+{
+    AppleTracker tracker;
+    QVector<int> first = tracker.update(boxes(QRectF(10, 10, 50, 50)));
+    tracker.setClassification(first[0], "хорошее", 0.9f);
+
+    tracker.advanceFrame();
+    QVector<int> second = tracker.update(boxes(QRectF(12, 10, 50, 50)));
+
+    QCOMPARE(second, first);
+    const AppleTracker::Track *track = tracker.track(first[0]);
+    QVERIFY(track);
+    QVERIFY(track->classified);
+    QCOMPARE(track->result, QString("хорошее"));
+}
+
+void AppleTrackerTest::unmatchedTrackRemoved()
+{
+    AppleTracker tracker;
+    QVector<int> ids = tracker.update(boxes(QRectF(10, 10, 50, 50)));
+
+    // Трек переживает MAX_MISSED детекций без сопоставления
+    tracker.update(QVector<QRectF>());
+    tracker.update(QVector<QRectF>());
+    QVERIFY(tracker.track(ids[0]));
+
+    tracker.update(QVector<QRectF>());
+    QVERIFY(!tracker.track(ids[0]));
+    QVERIFY(tracker.needsDetection());
+}
+
+QTEST_APPLESS_MAIN(AppleTrackerTest)
+
+#include "tst_appletracker.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_appletracker
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_appletracker.cpp \
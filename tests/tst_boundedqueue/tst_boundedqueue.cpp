@@ -0,0 +1,152 @@
+#include <QtTest>
+#include <QtConcurrent>
+#include "BoundedQueue.h"
+
+class BoundedQueueTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fifoOrder();
+    void tryPushWhenFull();
+    void timedPushWhenFull();
+    void tryPopWhenEmpty();
+    void closeDrainsRemaining();
+    void closeReleasesBlockedPush();
+    void closeReleasesBlockedPop();
+    void reopenStartsNewSession();
+};
+
+void BoundedQueueTest::fifoOrder()
+{
+    BoundedQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.push(i));
+    }
+
+    int item = -1;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.pop(item));
+        QCOMPARE(item, i);
+    }
+}
+
+void BoundedQueueTest::tryPushWhenFull()
+{
+    BoundedQueue<int> queue(2);
+    QVERIFY(queue.tryPush(1));
+    QVERIFY(queue.tryPush(2));
+    QVERIFY(!queue.tryPush(3));
+
+    int item = 0;
+    QVERIFY(queue.pop(item));
+    QVERIFY(queue.tryPush(3));
+}
+
+void BoundedQueueTest::timedPushWhenFull()
+{
+    BoundedQueue<int> queue(1);
+    QVERIFY(queue.push(1, 10));
+
+    // Ожидание истекло: очередь не закрыта, просто нет места
+    QVERIFY(!queue.push(2, 20));
+    QVERIFY(!queue.isClosed());
+
+    // Место освободилось во время ожидания
+    QFuture<void> consumer = QtConcurrent::run([&queue]() {
+        QThread::msleep(20);
+        int item = 0;
+        queue.pop(item);
+    });
+    bool pushed = false;
+    while (!pushed) {
+        pushed = queue.push(2, 50);
+    }
+    consumer.waitForFinished();
+
+    int item = 0;
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item, 2);
+}
+
+void BoundedQueueTest::tryPopWhenEmpty()
+{
+    BoundedQueue<int> queue(2);
+    int item = -1;
+    QVERIFY(!queue.tryPop(item));
+
+    queue.push(7);
+    QVERIFY(queue.tryPop(item));
+    QCOMPARE(item, 7);
+    QVERIFY(!queue.tryPop(item));
+}
+
+void BoundedQueueTest::closeDrainsRemaining()
+{
+    BoundedQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    QVERIFY(queue.isClosed());
+    QVERIFY(!queue.push(3));
+    QVERIFY(!queue.tryPush(3));
+    QVERIFY(!queue.push(3, 10));
+
+    // Принятые до закрытия элементы не теряются
+    int item = 0;
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item, 1);
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item, 2);
+    QVERIFY(!queue.pop(item));
+}
+
+void BoundedQueueTest::closeReleasesBlockedPush()
+{
+    BoundedQueue<int> queue(1);
+    queue.push(1);
+
+    QFuture<bool> producer = QtConcurrent::run([&queue]() { return queue.push(2); });
+    QThread::msleep(20);
+    QVERIFY(!producer.isFinished());
+
+    queue.close();
+    QVERIFY(!producer.result());
+}
+
+void BoundedQueueTest::closeReleasesBlockedPop()
+{
+    BoundedQueue<int> queue(1);
+
+    QFuture<bool> consumer = QtConcurrent::run([&queue]() {
+        int item = 0;
+        return queue.pop(item);
+    });
+    QThread::msleep(20);
+    QVERIFY(!consumer.isFinished());
+
+    queue.close();
+    QVERIFY(!consumer.result());
+}
+
+void BoundedQueueTest::reopenStartsNewSession()
+{
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.close();
+
+    // Оставшиеся элементы прошлого сеанса отбрасываются
+    queue.reopen();
+    QVERIFY(!queue.isClosed());
+
+    int item = 0;
+    QVERIFY(!queue.tryPop(item));
+    QVERIFY(queue.push(2));
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item, 2);
+}
+
+QTEST_APPLESS_MAIN(BoundedQueueTest)
+
+#include "tst_boundedqueue.moc"
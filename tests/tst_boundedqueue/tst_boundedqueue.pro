@@ -0,0 +1,6 @@
+TARGET = tst_boundedqueue
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_boundedqueue.cpp \
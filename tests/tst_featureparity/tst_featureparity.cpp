@@ -0,0 +1,104 @@
+#include <QtTest>
+#include "ImageProcessor.h"
+#include "YuvFrame.h"
+#include <cmath>
+
+/**
+ * @brief Признаки кадра YUV совпадают с признаками того же кадра в RGB
+ *
+ * Кадр камеры анализируется без конвертации в RGB, а модель обучена на
+ * признаках QImage. Расхождение путей незаметно сдвигает вердикты real-time
+ * анализа, поэтому оба пути сравниваются на одних и тех же пикселях.
+ */
+class FeatureParityTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void smoothFrame();
+    void fineStripes();
+
+private:
+    static YuvFrame makeNv12(int width, int height, int stripeAmplitude);
+    static void compare(const std::vector<double> &yuv, const std::vector<double> &rgb);
+};
+
+YuvFrame FeatureParityTest::makeNv12(int width, int height, int stripeAmplitude)
+{
+    YuvFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.yStride = width;
+    frame.chromaStride = width;
+    frame.chromaStep = 2;
+    frame.uOffset = width * height;
+    frame.vOffset = width * height + 1;
+    frame.data.resize(width * height + width * ((height + 1) / 2));
+
+    uchar *data = reinterpret_cast<uchar *>(frame.data.data());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            // Плавный градиент и полосы шириной в пиксель поверх него
+            int luma = 40 + 160 * (x + y) / (width + height);
+            luma += (x % 2 == 0) ? stripeAmplitude : -stripeAmplitude;
+            data[y * width + x] = static_cast<uchar>(qBound(16, luma, 235));
+        }
+    }
+
+    // Красноватое яблоко: U ниже, V выше нейтрального 128
+    for (int y = 0; y < (height + 1) / 2; ++y) {
+        uchar *row = data + frame.uOffset + y * frame.chromaStride;
+        for (int x = 0; x < (width + 1) / 2; ++x) {
+            row[2 * x] = static_cast<uchar>(110 - 10 * x / width);
+            row[2 * x + 1] = static_cast<uchar>(170 + 20 * y / height);
+        }
+    }
+    return frame;
+}
+
+void FeatureParityTest::compare(const std::vector<double> &yuv, const std::vector<double> &rgb)
+{
+    QCOMPARE(yuv.size(), rgb.size());
+
+    // Нормированные гистограммы R, G, B: сдвиг на соседний бин при округлении допустим
+    double histogramDistance = 0.0;
+    for (int i = 0; i < 192; ++i) {
+        histogramDistance += std::abs(yuv[i] - rgb[i]);
+    }
+    QVERIFY2(histogramDistance < 0.3, qPrintable(QString("histogram L1 %1").arg(histogramDistance)));
+
+    // Средние каналов
+    for (int i = 192; i < 195; ++i) {
+        QVERIFY2(std::abs(yuv[i] - rgb[i]) < 0.01,
+                 qPrintable(QString("mean %1: %2 vs %3").arg(i).arg(yuv[i]).arg(rgb[i])));
+    }
+
+    // Плотность границ и контраст
+    const int texture = yuv.size() - 128;
+    QVERIFY2(std::abs(yuv[texture] - rgb[texture]) < 0.05,
+             qPrintable(QString("edge density %1 vs %2").arg(yuv[texture]).arg(rgb[texture])));
+    QVERIFY2(std::abs(yuv[texture + 1] - rgb[texture + 1]) < 0.05,
+             qPrintable(QString("contrast %1 vs %2").arg(yuv[texture + 1]).arg(rgb[texture + 1])));
+}
+
+void FeatureParityTest::smoothFrame()
+{
+    ImageProcessor processor;
+    YuvFrame frame = makeNv12(640, 480, 0);
+
+    compare(processor.extractFeatures(frame), processor.extractFeatures(frame.toImage()));
+}
+
+void FeatureParityTest::fineStripes()
+{
+    // Полосы мельче ячейки сетки: выборка по точкам видит только одну фазу
+    // полос, а сглаженное масштабирование QImage - их среднее
+    ImageProcessor processor;
+    YuvFrame frame = makeNv12(1280, 720, 30);
+
+    compare(processor.extractFeatures(frame), processor.extractFeatures(frame.toImage()));
+}
+
+QTEST_GUILESS_MAIN(FeatureParityTest)
+
+#include "tst_featureparity.moc"
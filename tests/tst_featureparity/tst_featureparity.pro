@@ -0,0 +1,6 @@
+TARGET = tst_featureparity
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_featureparity.cpp \
@@ -0,0 +1,120 @@
+#include <QtTest>
+#include <QtConcurrent>
+#include "FrameMailbox.h"
+
+class FrameMailboxTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyMailbox();
+    void takeReturnsFrameOnce();
+    void newerFrameReplacesUnread();
+    void clearDropsUnread();
+    void concurrentProducerConsumer();
+};
+
+void FrameMailboxTest::emptyMailbox()
+{
+    FrameMailbox<int> mailbox;
+    int frame = -1;
+
+    QVERIFY(mailbox.isEmpty());
+    QVERIFY(!mailbox.take(frame));
+    QCOMPARE(frame, -1);
+}
+
+void FrameMailboxTest::takeReturnsFrameOnce()
+{
+    FrameMailbox<int> mailbox;
+    int frame = 0;
+
+    QVERIFY(!mailbox.post(1));
+    QVERIFY(!mailbox.isEmpty());
+    QVERIFY(mailbox.take(frame));
+    QCOMPARE(frame, 1);
+    QVERIFY(!mailbox.take(frame));
+
+    // Ячейки переиспользуются по кругу
+    for (int i = 2; i < 10; ++i) {
+        mailbox.post(i);
+        QVERIFY(mailbox.take(frame));
+        QCOMPARE(frame, i);
+    }
+    QCOMPARE(mailbox.dropped(), 0);
+}
+
+void FrameMailboxTest::newerFrameReplacesUnread()
+{
+    FrameMailbox<int> mailbox;
+    int frame = 0;
+
+    QVERIFY(!mailbox.post(1));
+    QVERIFY(mailbox.post(2));
+    QVERIFY(mailbox.post(3));
+
+    QVERIFY(mailbox.take(frame));
+    QCOMPARE(frame, 3);
+    QVERIFY(!mailbox.take(frame));
+
+    QCOMPARE(mailbox.produced(), 3);
+    QCOMPARE(mailbox.consumed(), 1);
+    QCOMPARE(mailbox.dropped(), 2);
+
+    mailbox.resetCounters();
+    QCOMPARE(mailbox.produced(), 0);
+}
+
+void FrameMailboxTest::clearDropsUnread()
+{
+    FrameMailbox<int> mailbox;
+    int frame = 0;
+
+    mailbox.post(1);
+    mailbox.clear();
+    QVERIFY(mailbox.isEmpty());
+    QVERIFY(!mailbox.take(frame));
+    QCOMPARE(mailbox.dropped(), 1);
+
+    // После очистки ящик снова принимает кадры
+    mailbox.post(2);
+    QVERIFY(mailbox.take(frame));
+    QCOMPARE(frame, 2);
+}
+
+void FrameMailboxTest::concurrentProducerConsumer()
+{
+    const int frames = 100000;
+    FrameMailbox<int> mailbox;
+
+    QFuture<void> producer = QtConcurrent::run([&mailbox, frames]() {
+        for (int i = 1; i <= frames; ++i) {
+            mailbox.post(i);
+        }
+    });
+
+    // Потребитель видит только возрастающие номера и в итоге - последний кадр
+    int last = 0;
+    int frame = 0;
+    bool ordered = true;
+    while (!producer.isFinished() || !mailbox.isEmpty()) {
+        if (mailbox.take(frame)) {
+            ordered = ordered && frame > last;
+            last = frame;
+        }
+    }
+    producer.waitForFinished();
+    if (mailbox.take(frame)) {
+        ordered = ordered && frame > last;
+        last = frame;
+    }
+
+    QVERIFY(ordered);
+    QCOMPARE(last, frames);
+    QCOMPARE(mailbox.produced(), frames);
+    QCOMPARE(mailbox.consumed() + mailbox.dropped(), frames);
+}
+
+QTEST_APPLESS_MAIN(FrameMailboxTest)
+
+#include "tst_framemailbox.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_framemailbox
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_framemailbox.cpp \
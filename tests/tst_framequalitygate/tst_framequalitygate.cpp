@@ -0,0 +1,129 @@
+#include <QtTest>
+#include "FrameQualityGate.h"
+
+class FrameQualityGateTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sharpPatchInBlurredFrame();
+    void transientBlurRejected();
+    void persistentBlurRecalibrates();
+    void exposure_data();
+    void exposure();
+    void downscaledAveragesBlocks();
+
+private:
+    static LumaBuffer makeLuma(int background, int amplitude, const QRect &texture);
+};
+
+LumaBuffer FrameQualityGateTest::makeLuma(int background, int amplitude, const QRect &texture)
+{
+    LumaBuffer luma;
+    luma.width = 160;
+    luma.height = 90;
+    luma.pixels.assign(luma.width * luma.height, static_cast<uchar>(background));
+
+    // Шахматная текстура в пиксель - самая резкая деталь, какую видит буфер
+    for (int y = texture.top(); y <= texture.bottom(); ++y) {
+        for (int x = texture.left(); x <= texture.right(); ++x) {
+            const int value = background + ((x + y) % 2 == 0 ? amplitude : -amplitude);
+            luma.pixels[y * luma.width + x] = static_cast<uchar>(qBound(0, value, 255));
+        }
+    }
+    return luma;
+}
+
+void FrameQualityGateTest::sharpPatchInBlurredFrame()
+{
+    // Резкое яблоко занимает меньше процента кадра, остальное - размытый фон:
+    // дисперсия по всему кадру ниже минимума, по плитке - намного выше
+    FrameQualityGate gate;
+    FrameQualityGate::Result result = gate.evaluate(makeLuma(120, 5, QRect(20, 20, 12, 12)));
+
+    QVERIFY(result.accepted());
+    QVERIFY2(result.sharpness > 100.0, qPrintable(QString("sharpness %1").arg(result.sharpness)));
+}
+
+void FrameQualityGateTest::transientBlurRejected()
+{
+    const QRect texture(0, 0, 160, 90);
+
+    FrameQualityGate gate;
+    for (int frame = 0; frame < 5; ++frame) {
+        QVERIFY(gate.evaluate(makeLuma(120, 20, texture)).accepted());
+    }
+
+    // Смаз: резкость выше абсолютного минимума, но в разы ниже обычной для сцены
+    FrameQualityGate::Result blurred = gate.evaluate(makeLuma(120, 2, texture));
+    QCOMPARE(blurred.verdict, FrameQualityGate::BLURRED);
+    QVERIFY(blurred.sharpness > 25.0);
+
+    QVERIFY(gate.evaluate(makeLuma(120, 20, texture)).accepted());
+}
+
+void FrameQualityGateTest::persistentBlurRecalibrates()
+{
+    const QRect texture(0, 0, 160, 90);
+
+    FrameQualityGate gate;
+    for (int frame = 0; frame < 5; ++frame) {
+        gate.evaluate(makeLuma(120, 20, texture));
+    }
+
+    // Сцена сменилась на менее детальную: порог опускается, кадры снова принимаются
+    int rejected = 0;
+    while (!gate.evaluate(makeLuma(120, 2, texture)).accepted()) {
+        ++rejected;
+        QVERIFY2(rejected < 100, "threshold never adapted");
+    }
+    QVERIFY(rejected > 0);
+
+    gate.reset();
+    QCOMPARE(gate.sceneSharpness(), 0.0);
+}
+
+void FrameQualityGateTest::exposure_data()
+{
+    QTest::addColumn<int>("background");
+    QTest::addColumn<QRect>("subject");
+    QTest::addColumn<int>("verdict");
+
+    // Яблоко на половине кадра, фон обрезан в тенях - экспозиция допустима
+    QTest::newRow("dark background") << 5 << QRect(0, 0, 80, 90) << int(FrameQualityGate::ACCEPTED);
+    QTest::newRow("dark") << 5 << QRect(0, 0, 20, 90) << int(FrameQualityGate::UNDEREXPOSED);
+    QTest::newRow("bright") << 250 << QRect(0, 0, 20, 90) << int(FrameQualityGate::OVEREXPOSED);
+}
+
+void FrameQualityGateTest::exposure()
+{
+    QFETCH(int, background);
+    QFETCH(QRect, subject);
+    QFETCH(int, verdict);
+
+    LumaBuffer luma = makeLuma(background, 0, QRect());
+    for (int y = subject.top(); y <= subject.bottom(); ++y) {
+        for (int x = subject.left(); x <= subject.right(); ++x) {
+            luma.pixels[y * luma.width + x] = static_cast<uchar>((x + y) % 2 == 0 ? 150 : 100);
+        }
+    }
+
+    FrameQualityGate gate;
+    QCOMPARE(int(gate.evaluate(luma).verdict), verdict);
+}
+
+void FrameQualityGateTest::downscaledAveragesBlocks()
+{
+    // Миниатюра сцены из буфера качества: шахматка усредняется в однотонный серый
+    LumaBuffer thumbnail = makeLuma(120, 20, QRect(0, 0, 160, 90)).downscaled(32);
+
+    QCOMPARE(thumbnail.width, 32);
+    QCOMPARE(thumbnail.height, 18);
+    for (uchar value : thumbnail.pixels) {
+        QVERIFY(qAbs(int(value) - 120) <= 1);
+    }
+}
+
+QTEST_APPLESS_MAIN(FrameQualityGateTest)
+
+#include "tst_framequalitygate.moc"
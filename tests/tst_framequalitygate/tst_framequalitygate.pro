@@ -0,0 +1,6 @@
+TARGET = tst_framequalitygate
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_framequalitygate.cpp \
@@ -0,0 +1,88 @@
+#include <QtTest>
+#include "InferenceAutotuner.h"
+
+class InferenceAutotunerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void detectionF1_data();
+    void detectionF1();
+    void fastestAboveFloor();
+    void nothingBelowFloor();
+
+private:
+    static InferenceAutotuner::Profile measured(double latencyMs, double accuracy, int threads);
+};
+
+typedef QVector<QRectF> Boxes;
+
+InferenceAutotuner::Profile InferenceAutotunerTest::measured(double latencyMs, double accuracy, int threads)
+{
+    InferenceAutotuner::Profile profile;
+    profile.latencyMs = latencyMs;
+    profile.accuracy = accuracy;
+    profile.threads = threads;
+    profile.valid = true;
+    return profile;
+}
+
+void InferenceAutotunerTest::detectionF1_data()
+{
+    QTest::addColumn<Boxes>("detected");
+    QTest::addColumn<Boxes>("expected");
+    QTest::addColumn<double>("f1");
+
+    const QRectF apple(0, 0, 100, 100);
+    const QRectF other(300, 300, 100, 100);
+
+    QTest::newRow("both empty") << Boxes() << Boxes() << 1.0;
+    QTest::newRow("missed") << Boxes() << (Boxes() << apple) << 0.0;
+    QTest::newRow("false positive") << (Boxes() << apple) << Boxes() << 0.0;
+    QTest::newRow("exact") << (Boxes() << apple) << (Boxes() << apple) << 1.0;
+    // IoU 2/3 - совпадение, IoU 1/3 - нет
+    QTest::newRow("shifted match") << (Boxes() << QRectF(20, 0, 100, 100)) << (Boxes() << apple) << 1.0;
+    QTest::newRow("shifted miss") << (Boxes() << QRectF(50, 0, 100, 100)) << (Boxes() << apple) << 0.0;
+    // Точность 1/2, полнота 1: F1 = 2/3
+    QTest::newRow("extra box") << (Boxes() << apple << other) << (Boxes() << apple) << 2.0 / 3.0;
+    // Одна эталонная рамка не засчитывается дважды
+    QTest::newRow("duplicate") << (Boxes() << apple << apple) << (Boxes() << apple) << 2.0 / 3.0;
+}
+
+void InferenceAutotunerTest::detectionF1()
+{
+    QFETCH(Boxes, detected);
+    QFETCH(Boxes, expected);
+    QFETCH(double, f1);
+
+    QCOMPARE(InferenceAutotuner::detectionF1(detected, expected), f1);
+}
+
+void InferenceAutotunerTest::fastestAboveFloor()
+{
+    QVector<InferenceAutotuner::Profile> profiles;
+    profiles << measured(40.0, 0.95, 1)
+             << measured(10.0, 0.80, 2)     // Самая быстрая, но ниже порога
+             << measured(25.0, 0.92, 3)
+             << measured(30.0, 0.99, 4);
+
+    InferenceAutotuner::Profile best = InferenceAutotuner::selectProfile(profiles, 0.9);
+    QVERIFY(best.valid);
+    QCOMPARE(best.threads, 3);
+}
+
+void InferenceAutotunerTest::nothingBelowFloor()
+{
+    QVector<InferenceAutotuner::Profile> profiles;
+    profiles << measured(10.0, 0.5, 1) << measured(20.0, 0.7, 2);
+
+    InferenceAutotuner::Profile invalid = measured(5.0, 1.0, 3);
+    invalid.valid = false;
+    profiles << invalid;
+
+    QVERIFY(!InferenceAutotuner::selectProfile(profiles, 0.9).valid);
+}
+
+QTEST_APPLESS_MAIN(InferenceAutotunerTest)
+
+#include "tst_inferenceautotuner.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_inferenceautotuner
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_inferenceautotuner.cpp \
@@ -0,0 +1,202 @@
+#include <QtTest>
+#include <QSemaphore>
+#include "JobScheduler.h"
+
+class JobSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void runReturnsResult();
+    void classLimit();
+    void higherClassStartsFirst();
+    void helperThreadLimit();
+    void checkpointYieldsToHigherClass();
+    void checkpointWithoutWaitingJobs();
+};
+
+namespace {
+// Наибольшее число одновременно выполнявшихся задач
+class ConcurrencyProbe
+{
+public:
+    ConcurrencyProbe() : m_current(0), m_peak(0) {}
+
+    void enter()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_peak = qMax(m_peak, ++m_current);
+    }
+
+    void leave()
+    {
+        QMutexLocker locker(&m_mutex);
+        --m_current;
+    }
+
+    int peak() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_peak;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    int m_current;
+    int m_peak;
+};
+
+// Порядок событий из разных потоков
+class EventLog
+{
+public:
+    void append(const QString &event)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_events.append(event);
+    }
+
+    QStringList events() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_events;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QStringList m_events;
+};
+}
+
+void JobSchedulerTest::runReturnsResult()
+{
+    JobScheduler scheduler(2);
+    QFuture<int> future = scheduler.run<int>(JobScheduler::INTERACTIVE, std::function<int()>([]() {
+        return 42;
+    }));
+    QCOMPARE(future.result(), 42);
+}
+
+void JobSchedulerTest::classLimit()
+{
+    JobScheduler scheduler(4);
+    scheduler.setLimit(JobScheduler::BATCH, 2);
+
+    ConcurrencyProbe probe;
+    QAtomicInt completed(0);
+    for (int i = 0; i < 8; ++i) {
+        scheduler.submit(JobScheduler::BATCH, [&probe, &completed]() {
+            probe.enter();
+            QThread::msleep(20);
+            probe.leave();
+            completed.fetchAndAddOrdered(1);
+        });
+    }
+    scheduler.waitForDone();
+
+    QCOMPARE(completed.load(), 8);
+    QCOMPARE(probe.peak(), 2);
+}
+
+void JobSchedulerTest::higherClassStartsFirst()
+{
+    JobScheduler scheduler(1);
+    QSemaphore started;
+    QSemaphore release;
+    EventLog log;
+
+    // Единственный поток занят, пока в очередь встают задачи разных классов
+    scheduler.submit(JobScheduler::BATCH, [&]() {
+        started.release();
+        release.acquire();
+    });
+    started.acquire();
+
+    scheduler.submit(JobScheduler::TRAINING, [&log]() { log.append("training"); });
+    scheduler.submit(JobScheduler::BATCH, [&log]() { log.append("batch"); });
+    scheduler.submit(JobScheduler::INTERACTIVE, [&log]() { log.append("interactive"); });
+    QCOMPARE(scheduler.queued(JobScheduler::BATCH), 1);
+
+    release.release();
+    scheduler.waitForDone();
+
+    QCOMPARE(log.events(), QStringList() << "interactive" << "batch" << "training");
+}
+
+void JobSchedulerTest::helperThreadLimit()
+{
+    JobScheduler scheduler(4);
+    scheduler.setLimit(JobScheduler::TRAINING, 1);
+    scheduler.setThreadLimit(JobScheduler::TRAINING, 2);
+
+    JobScheduler *current = nullptr;
+    JobScheduler::Priority priority = JobScheduler::INTERACTIVE;
+    QVERIFY(!JobScheduler::currentJob(&current, &priority));
+
+    QSemaphore helperRelease;
+    bool insideJob = false;
+    bool firstHelper = false;
+    bool secondHelper = true;
+
+    scheduler.submit(JobScheduler::TRAINING, [&]() {
+        JobScheduler *owner = nullptr;
+        JobScheduler::Priority jobPriority = JobScheduler::INTERACTIVE;
+        insideJob = JobScheduler::currentJob(&owner, &jobPriority) && owner == &scheduler
+                    && jobPriority == JobScheduler::TRAINING;
+
+        // Задача и один помощник - весь лимит потоков класса
+        firstHelper = scheduler.tryStartHelper(JobScheduler::TRAINING, [&]() { helperRelease.acquire(); });
+        secondHelper = scheduler.tryStartHelper(JobScheduler::TRAINING, [&]() { helperRelease.acquire(); });
+        helperRelease.release(2);
+    });
+    scheduler.waitForDone();
+
+    QVERIFY(insideJob);
+    QVERIFY(firstHelper);
+    QVERIFY(!secondHelper);
+}
+
+void JobSchedulerTest::checkpointYieldsToHigherClass()
+{
+    JobScheduler scheduler(1);
+    QSemaphore started;
+    QSemaphore submitted;
+    EventLog log;
+
+    scheduler.submit(JobScheduler::BATCH, [&]() {
+        started.release();
+        submitted.acquire();
+
+        // Интерактивная задача ждёт единственного потока
+        scheduler.checkpoint(JobScheduler::BATCH);
+        log.append("batch resumed");
+    });
+    started.acquire();
+
+    scheduler.submit(JobScheduler::INTERACTIVE, [&log]() { log.append("interactive"); });
+    submitted.release();
+    scheduler.waitForDone();
+
+    QCOMPARE(log.events(), QStringList() << "interactive" << "batch resumed");
+}
+
+void JobSchedulerTest::checkpointWithoutWaitingJobs()
+{
+    JobScheduler scheduler(1);
+    EventLog log;
+
+    // Более приоритетных задач нет: задача продолжается без ожидания,
+    // а менее приоритетные не вытесняют её
+    scheduler.submit(JobScheduler::INTERACTIVE, [&]() {
+        scheduler.submit(JobScheduler::BATCH, [&log]() { log.append("batch"); });
+        scheduler.checkpoint(JobScheduler::INTERACTIVE);
+        log.append("interactive");
+    });
+    scheduler.waitForDone();
+
+    QCOMPARE(log.events(), QStringList() << "interactive" << "batch");
+}
+
+QTEST_APPLESS_MAIN(JobSchedulerTest)
+
+#include "tst_jobscheduler.moc"
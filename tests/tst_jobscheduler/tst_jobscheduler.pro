@@ -0,0 +1,6 @@
+TARGET = tst_jobscheduler
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_jobscheduler.cpp \